@@ -22,6 +22,13 @@
 
 #include <xtt/asio/server_context.hpp>
 #include <xtt/asio/error_category.hpp>
+#include <xtt/asio/identity_allocator.hpp>
+#include <xtt/asio/memory_stream.hpp>
+#include <xtt/asio/udp_server.hpp>
+#include <xtt/asio/stream.hpp>
+#include <xtt/asio/connection_manager.hpp>
+#include <xtt/asio/listener_handoff.hpp>
+#include <xtt/asio/server_configuration.hpp>
 
 #endif
 
@@ -0,0 +1,191 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#ifndef XTT_ASIO_CONNECTIONMANAGER_HPP
+#define XTT_ASIO_CONNECTIONMANAGER_HPP
+#pragma once
+
+#include <xtt/asio/server_context.hpp>
+
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/system/error_code.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace xtt {
+namespace asio {
+
+    /*
+     * Owns the server contexts of a server's handshakes,
+     *  and frees each one once its handshake has finished.
+     *
+     * Contexts live in pooled slots that are never moved,
+     *  so references to them stay valid until they're removed,
+     *  and active contexts are kept on an intrusive list,
+     *  so adding and removing one is O(1) and doesn't allocate
+     *  once the pool has grown to the peak number of handshakes.
+     *
+     * Except for `close_all` and `async_drain`, member functions must be called
+     *  from the manager's executor (e.g. the thread running a single-threaded io_context).
+     *  Each context's I/O runs on that context's own strand,
+     *  so contexts' streams are only closed from there (see `basic_server_context::async_close`).
+     */
+    template <typename Stream>
+    class basic_connection_manager {
+    public:
+        using context_type = basic_server_context<Stream>;
+        using executor_type = boost::asio::strand<boost::asio::executor>;
+
+        explicit basic_connection_manager(const boost::asio::executor& executor,
+                                          std::size_t slots_per_block = 64);
+
+        basic_connection_manager(const basic_connection_manager&) = delete;
+        basic_connection_manager& operator=(const basic_connection_manager&) = delete;
+
+        /*
+         * Destroys any remaining contexts,
+         *  so must not run while their handlers can still be invoked
+         *  (e.g. destroy the manager after the io_context has stopped).
+         */
+        ~basic_connection_manager();
+
+        executor_type get_executor();
+
+        /*
+         * Create a context for a handshake over `stream`.
+         *
+         * The reference is valid until the context is removed.
+         */
+        context_type& create(Stream stream,
+                             server_cookie_context& cookie_ctx);
+
+        /*
+         * Run `ctx.async_handle_connect`,
+         *  and remove `ctx` once `handler` has returned.
+         *
+         * `handler` is called as by `basic_server_context::async_handle_connect`,
+         *  so should take what it needs from `ctx` (e.g. `ctx.finish()`) before returning.
+         */
+        template <typename GPKLookupCallback,
+                  typename AssignIdCallback,
+                  typename Handler>
+        void async_handle_connect(context_type& ctx,
+                                  GPKLookupCallback async_lookup_gpk,
+                                  AssignIdCallback async_assign_id,
+                                  Handler handler);
+
+        /*
+         * Destroy `ctx` and return its slot to the pool.
+         *
+         * `ctx` must not have a handshake in progress.
+         * If `close_all` is still closing its stream, it's destroyed once that's done.
+         */
+        void remove(context_type& ctx);
+
+        /*
+         * Close the streams of all contexts,
+         *  so that in-progress handshakes fail (and are removed).
+         *
+         * May be called from any thread.
+         */
+        void close_all();
+
+        /*
+         * Wait for the handshakes in progress to finish,
+         *  e.g. after closing the acceptor, for a graceful shutdown.
+         *
+         * `handler(ec)` is called once no contexts remain.
+         * Handshakes still in progress after `timeout` are aborted (as by `close_all`),
+         *  and `ec` is then `boost::asio::error::timed_out`.
+         *
+         * Contexts never started with `async_handle_connect` must be removed by the caller.
+         * Only one drain may be pending at a time.
+         * May be called from any thread.
+         */
+        template <typename Handler>
+        void async_drain(std::chrono::steady_clock::duration timeout,
+                         Handler handler);
+
+        /*
+         * Number of contexts currently in use.
+         */
+        std::size_t size() const;
+
+        /*
+         * Number of slots in the pool (used or free).
+         */
+        std::size_t capacity() const;
+
+    private:
+        struct node : context_type {
+            node(Stream stream, server_cookie_context& cookie_ctx);
+
+            node *prev;
+            node *next;
+
+            // Closes posted to the context's strand that haven't completed yet
+            std::size_t pending_closes;
+            // Removed, but kept (and skipped) until pending_closes is 0
+            bool removed;
+        };
+
+        union slot {
+            slot *next_free;
+            typename std::aligned_storage<sizeof(node), alignof(node)>::type storage;
+        };
+
+        void grow();
+
+        void close_streams();
+
+        void close_completed(node& n);
+
+        void destroy(node *n);
+
+        void complete_drain();
+
+    private:
+        executor_type strand_;
+
+        std::size_t slots_per_block_;
+        std::vector<std::unique_ptr<slot[]>> blocks_;
+        slot *free_;
+
+        node *active_;
+        std::size_t size_;
+
+        boost::asio::steady_timer drain_timer_;
+        std::function<void(const boost::system::error_code&)> drain_handler_;
+        boost::system::error_code drain_ec_;
+    };
+
+    using connection_manager = basic_connection_manager<boost::asio::ip::tcp::socket>;
+
+}   // namespace asio
+}   // namespace xtt
+
+#include "connection_manager.inl"
+
+#endif
@@ -0,0 +1,261 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include <boost/asio/bind_executor.hpp>
+#include <boost/asio/error.hpp>
+#include <boost/asio/post.hpp>
+
+#include <new>
+#include <utility>
+
+namespace xtt {
+namespace asio {
+
+    template <typename Stream>
+    basic_connection_manager<Stream>::node::node(Stream stream,
+                                                 server_cookie_context& cookie_ctx)
+        : context_type(std::move(stream), cookie_ctx),
+          prev(nullptr),
+          next(nullptr),
+          pending_closes(0),
+          removed(false)
+    {
+    }
+
+    template <typename Stream>
+    basic_connection_manager<Stream>::basic_connection_manager(const boost::asio::executor& executor,
+                                                               std::size_t slots_per_block)
+        : strand_(boost::asio::make_strand(executor)),
+          slots_per_block_(slots_per_block > 0 ? slots_per_block : 1),
+          blocks_(),
+          free_(nullptr),
+          active_(nullptr),
+          size_(0),
+          drain_timer_(strand_),
+          drain_handler_(),
+          drain_ec_()
+    {
+    }
+
+    template <typename Stream>
+    basic_connection_manager<Stream>::~basic_connection_manager()
+    {
+        drain_handler_ = nullptr;
+
+        while (active_)
+            destroy(active_);
+    }
+
+    template <typename Stream>
+    typename basic_connection_manager<Stream>::executor_type
+    basic_connection_manager<Stream>::get_executor()
+    {
+        return strand_;
+    }
+
+    template <typename Stream>
+    typename basic_connection_manager<Stream>::context_type&
+    basic_connection_manager<Stream>::create(Stream stream,
+                                             server_cookie_context& cookie_ctx)
+    {
+        if (!free_)
+            grow();
+
+        slot *s = free_;
+        free_ = s->next_free;
+
+        node *n;
+        try {
+            n = new (&s->storage) node(std::move(stream), cookie_ctx);
+        } catch (...) {
+            s->next_free = free_;
+            free_ = s;
+            throw;
+        }
+
+        n->next = active_;
+        if (active_)
+            active_->prev = n;
+        active_ = n;
+        ++size_;
+
+        return *n;
+    }
+
+    template <typename Stream>
+    template <typename GPKLookupCallback,
+              typename AssignIdCallback,
+              typename Handler>
+    void basic_connection_manager<Stream>::async_handle_connect(context_type& ctx,
+                                                                GPKLookupCallback async_lookup_gpk,
+                                                                AssignIdCallback async_assign_id,
+                                                                Handler handler)
+    {
+        ctx.async_handle_connect(std::move(async_lookup_gpk),
+                                 std::move(async_assign_id),
+                                 [this, &ctx, handler(std::move(handler))](const boost::system::error_code& ec)
+                                 {
+                                     handler(ec);
+
+                                     // `ec` refers into `ctx`, and `ctx` is still on the call stack
+                                     boost::asio::post(strand_,
+                                                       [this, &ctx]()
+                                                       {
+                                                           this->remove(ctx);
+                                                       });
+                                 });
+    }
+
+    template <typename Stream>
+    void basic_connection_manager<Stream>::remove(context_type& ctx)
+    {
+        node *n = static_cast<node*>(&ctx);
+
+        --size_;
+        if (0 == size_ && drain_handler_)
+            complete_drain();
+
+        if (0 != n->pending_closes) {
+            n->removed = true;
+            return;
+        }
+
+        destroy(n);
+    }
+
+    template <typename Stream>
+    void basic_connection_manager<Stream>::destroy(node *n)
+    {
+        if (n->prev)
+            n->prev->next = n->next;
+        else
+            active_ = n->next;
+        if (n->next)
+            n->next->prev = n->prev;
+
+        n->~node();
+
+        // The node was constructed at the start of its slot
+        slot *s = reinterpret_cast<slot*>(n);
+        s->next_free = free_;
+        free_ = s;
+    }
+
+    template <typename Stream>
+    void basic_connection_manager<Stream>::close_all()
+    {
+        boost::asio::post(strand_,
+                          [this]()
+                          {
+                              this->close_streams();
+                          });
+    }
+
+    template <typename Stream>
+    template <typename Handler>
+    void basic_connection_manager<Stream>::async_drain(std::chrono::steady_clock::duration timeout,
+                                                       Handler handler)
+    {
+        boost::asio::post(strand_,
+                          [this, timeout, handler(std::move(handler))]()
+                          {
+                              drain_handler_ = std::move(handler);
+                              drain_ec_ = boost::system::error_code();
+
+                              if (0 == size_) {
+                                  this->complete_drain();
+                                  return;
+                              }
+
+                              drain_timer_.expires_after(timeout);
+                              drain_timer_.async_wait(boost::asio::bind_executor(strand_,
+                                                                                 [this](const boost::system::error_code& ec)
+                                                                                 {
+                                                                                     if (ec || !drain_handler_)
+                                                                                         return;
+
+                                                                                     // Completes as the aborted handshakes are removed
+                                                                                     drain_ec_ = boost::asio::error::timed_out;
+                                                                                     this->close_streams();
+                                                                                 }));
+                          });
+    }
+
+    template <typename Stream>
+    std::size_t basic_connection_manager<Stream>::size() const
+    {
+        return size_;
+    }
+
+    template <typename Stream>
+    std::size_t basic_connection_manager<Stream>::capacity() const
+    {
+        return blocks_.size() * slots_per_block_;
+    }
+
+    template <typename Stream>
+    void basic_connection_manager<Stream>::close_streams()
+    {
+        for (node *n = active_; n; n = n->next) {
+            if (n->removed)
+                continue;
+
+            ++n->pending_closes;
+            n->async_close(boost::asio::bind_executor(strand_,
+                                                      [this, n]()
+                                                      {
+                                                          this->close_completed(*n);
+                                                      }));
+        }
+    }
+
+    template <typename Stream>
+    void basic_connection_manager<Stream>::close_completed(node& n)
+    {
+        --n.pending_closes;
+        if (0 == n.pending_closes && n.removed)
+            destroy(&n);
+    }
+
+    template <typename Stream>
+    void basic_connection_manager<Stream>::complete_drain()
+    {
+        drain_timer_.cancel();
+
+        boost::asio::post(strand_,
+                          [handler(std::move(drain_handler_)), ec(drain_ec_)]()
+                          {
+                              handler(ec);
+                          });
+        drain_handler_ = nullptr;
+    }
+
+    template <typename Stream>
+    void basic_connection_manager<Stream>::grow()
+    {
+        std::unique_ptr<slot[]> block(new slot[slots_per_block_]);
+        for (std::size_t i = 0; i < slots_per_block_; ++i) {
+            block[i].next_free = free_;
+            free_ = &block[i];
+        }
+
+        blocks_.push_back(std::move(block));
+    }
+
+}   // namespace asio
+}   // namespace xtt
@@ -6,6 +6,8 @@
 
 #include <boost/system/error_code.hpp>
 
+#include <string>
+
 namespace xtt {
 namespace asio {
 
@@ -38,6 +40,53 @@ namespace asio {
                                          get_xtt_category());
     }
 
+    inline
+    boost::system::error_code get_record_failed_crypto_ec()
+    {
+        return boost::system::error_code(static_cast<int>(return_code::RECORD_FAILED_CRYPTO),
+                                         get_xtt_category());
+    }
+
+    inline
+    boost::system::error_code get_incorrect_length_ec()
+    {
+        return boost::system::error_code(static_cast<int>(return_code::INCORRECT_LENGTH),
+                                         get_xtt_category());
+    }
+
+    /*
+     * Handshake failures decided by the server, rather than reported by libxtt.
+     */
+    enum class server_error {
+        revoked_pseudonym = 1,
+    };
+
+    class server_error_category : public boost::system::error_category {
+    public:
+        const char* name() const noexcept { return "xtt_server"; }
+        std::string message(int ev) const {
+            switch (static_cast<server_error>(ev)) {
+                case server_error::revoked_pseudonym:
+                    return "Client's pseudonym has been revoked";
+            }
+            return "Unknown xtt_server error";
+        }
+    };
+
+    inline
+    const boost::system::error_category& get_server_error_category()
+    {
+        static server_error_category instance;
+        return instance;
+    }
+
+    inline
+    boost::system::error_code get_revoked_pseudonym_ec()
+    {
+        return boost::system::error_code(static_cast<int>(server_error::revoked_pseudonym),
+                                         get_server_error_category());
+    }
+
 }   // namespace asio
 }   // namespace xtt
 
@@ -0,0 +1,114 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#ifndef XTT_ASIO_IDENTITYALLOCATOR_HPP
+#define XTT_ASIO_IDENTITYALLOCATOR_HPP
+#pragma once
+
+#include <xtt/asio/server_context.hpp>
+#include <xtt/asio/error_category.hpp>
+
+#include <xtt.hpp>
+
+#include <boost/asio/post.hpp>
+#include <boost/system/error_code.hpp>
+
+#include <utility>
+
+namespace xtt {
+namespace asio {
+
+    /*
+     * Build an `AssignIdCallback` (see `server_context::async_handle_connect`)
+     *  that assigns identities using `allocator`.
+     *
+     * The client's pseudonym is read from `xtt_context`,
+     *  as the pseudonym type of the negotiated suite (see `suite_traits`).
+     * The continuation is posted to the executor of `xtt_context`'s stream.
+     *
+     * An identity is allocated before the handshake's last message is sent,
+     *  so wrap the handshake's handler with `release_identity_on_failure`
+     *  to hand it back if the handshake fails after that.
+     *
+     * Both `allocator` and `xtt_context` must outlive the handshake.
+     */
+    template <typename Stream>
+    auto make_assign_id_callback(identity_allocator& allocator,
+                                 basic_server_context<Stream>& xtt_context)
+    {
+        return [&allocator, &xtt_context](const group_identity& claimed_gid,
+                                          const identity& requested_client_id,
+                                          auto&& continuation)
+               {
+                   OPTIONAL_NS::optional<identity> assigned_id;
+
+                   auto suite = xtt_context.get_suite_spec();
+                   if (suite) {
+                       assigned_id = visit_suite(*suite,
+                                                 [&](auto traits) -> OPTIONAL_NS::optional<identity>
+                                                 {
+                                                     pseudonym_value<typename decltype(traits)::daa> clients_pseudonym;
+                                                     if (!xtt_context.get_clients_pseudonym(clients_pseudonym)) {
+                                                         return {};
+                                                     }
+
+                                                     return allocator.allocate(claimed_gid,
+                                                                               clients_pseudonym,
+                                                                               requested_client_id);
+                                                 });
+                   }
+
+                   boost::asio::post(xtt_context.get_executor(),
+                                     [continuation(std::forward<decltype(continuation)>(continuation)),
+                                      assigned_id]()
+                                     {
+                                         if (assigned_id) {
+                                             continuation(boost::system::error_code(), *assigned_id);
+                                         } else {
+                                             continuation(get_bad_id_ec(), identity());
+                                         }
+                                     });
+               };
+    }
+
+    /*
+     * Wrap a handshake `handler` (see `server_context::async_handle_connect`)
+     *  so that, if the handshake fails after `xtt_context` was assigned an identity,
+     *  the identity is released back to `allocator` before `handler` is called.
+     *
+     * Both `allocator` and `xtt_context` must outlive the handshake.
+     */
+    template <typename Stream, typename Handler>
+    auto release_identity_on_failure(identity_allocator& allocator,
+                                     basic_server_context<Stream>& xtt_context,
+                                     Handler handler)
+    {
+        return [&allocator, &xtt_context, handler(std::move(handler))](const boost::system::error_code& ec)
+               {
+                   if (ec && xtt_context.get_assigned_identity()) {
+                       allocator.release(*xtt_context.get_assigned_identity());
+                   }
+
+                   handler(ec);
+               };
+    }
+
+}   // namespace asio
+}   // namespace xtt
+
+#endif
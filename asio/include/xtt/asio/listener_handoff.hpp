@@ -0,0 +1,66 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#ifndef XTT_ASIO_LISTENERHANDOFF_HPP
+#define XTT_ASIO_LISTENERHANDOFF_HPP
+#pragma once
+
+#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/system/error_code.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace xtt {
+namespace asio {
+
+    /*
+     * Passing listening sockets to a successor process, for restarts that refuse no connections.
+     *
+     * The successor connects to a Unix socket the running server listens on,
+     *  and receives duplicates of the server's listening sockets (via SCM_RIGHTS).
+     *  Both processes then share the same listen queues,
+     *  so the old server can stop accepting and drain its handshakes
+     *  (see `basic_connection_manager::async_drain`)
+     *  while the successor accepts new connections.
+     */
+
+    constexpr std::size_t max_handed_off_listeners = 16;
+
+    /*
+     * Send duplicates of `listeners` (native socket handles) over `socket`.
+     *
+     * Sets `ec` on failure, including if there are more than `max_handed_off_listeners`.
+     */
+    void send_listeners(boost::asio::local::stream_protocol::socket& socket,
+                        const std::vector<int>& listeners,
+                        boost::system::error_code& ec);
+
+    /*
+     * Receive the listening sockets sent by `send_listeners` over `socket`.
+     *
+     * Blocks until they arrive.
+     * The caller owns the returned handles (e.g. by `assign`ing them to acceptors).
+     */
+    std::vector<int> receive_listeners(boost::asio::local::stream_protocol::socket& socket,
+                                       boost::system::error_code& ec);
+
+}   // namespace asio
+}   // namespace xtt
+
+#endif
@@ -0,0 +1,246 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#ifndef XTT_ASIO_MEMORYSTREAM_HPP
+#define XTT_ASIO_MEMORYSTREAM_HPP
+#pragma once
+
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/associated_executor.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/error.hpp>
+#include <boost/asio/executor.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/system/error_code.hpp>
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace xtt {
+namespace asio {
+
+    /*
+     * One end of an in-process, full-duplex byte stream.
+     *
+     * Meets the AsyncReadStream and AsyncWriteStream requirements,
+     *  so it can stand in for a socket (e.g. in `basic_server_context`)
+     *  when both peers live in the same process.
+     *
+     * Writes never block: they are buffered until the peer reads them.
+     * Closing either end aborts its own pending read,
+     *  makes the peer's reads fail with `eof` once buffered data has been drained,
+     *  and makes writes from either end fail with `broken_pipe`.
+     *
+     * The two ends may be used from different threads.
+     */
+    class memory_stream {
+    public:
+        using executor_type = boost::asio::executor;
+
+        /*
+         * Create two connected ends, both completing handlers on `executor`
+         *  (unless a handler has its own associated executor).
+         */
+        static
+        std::pair<memory_stream, memory_stream>
+        make_pair(const executor_type& executor);
+
+    public:
+        memory_stream(memory_stream&&) = default;
+        memory_stream& operator=(memory_stream&& other);
+
+        ~memory_stream();
+
+        executor_type get_executor() const;
+
+        bool is_open() const;
+
+        void close();
+
+        void close(boost::system::error_code& ec);
+
+        template <typename MutableBufferSequence, typename ReadHandler>
+        auto async_read_some(const MutableBufferSequence& buffers, ReadHandler&& handler);
+
+        template <typename ConstBufferSequence, typename WriteHandler>
+        auto async_write_some(const ConstBufferSequence& buffers, WriteHandler&& handler);
+
+    private:
+        struct pending_read {
+            virtual ~pending_read() = default;
+
+            // Called with the channel lock held.
+            virtual void complete(std::deque<unsigned char>& data,
+                                  const boost::system::error_code& ec) = 0;
+        };
+
+        template <typename MutableBufferSequence, typename ReadHandler>
+        struct pending_read_op;
+
+        // One direction of the stream.
+        struct channel {
+            std::mutex mutex;
+            std::deque<unsigned char> data;
+            std::unique_ptr<pending_read> reader;
+            bool closed = false;
+        };
+
+        memory_stream(const executor_type& executor,
+                      std::shared_ptr<channel> in,
+                      std::shared_ptr<channel> out);
+
+        template <typename Handler>
+        static void post_completion(const executor_type& executor,
+                                    Handler handler,
+                                    const boost::system::error_code& ec,
+                                    std::size_t bytes_transferred);
+
+        static void close_channel(channel& chan, const boost::system::error_code& ec);
+
+        static std::size_t consume(std::deque<unsigned char>& data,
+                                   unsigned char* dest,
+                                   std::size_t dest_length);
+
+        executor_type executor_;
+        std::shared_ptr<channel> in_;
+        std::shared_ptr<channel> out_;
+    };
+
+    template <typename Handler>
+    void memory_stream::post_completion(const executor_type& executor,
+                                        Handler handler,
+                                        const boost::system::error_code& ec,
+                                        std::size_t bytes_transferred)
+    {
+        auto handler_executor = boost::asio::get_associated_executor(handler, executor);
+        boost::asio::post(handler_executor,
+                          [handler(std::move(handler)), ec, bytes_transferred]() mutable
+                          {
+                              handler(ec, bytes_transferred);
+                          });
+    }
+
+    template <typename MutableBufferSequence, typename ReadHandler>
+    struct memory_stream::pending_read_op : memory_stream::pending_read {
+        pending_read_op(const executor_type& executor,
+                        const MutableBufferSequence& buffers,
+                        ReadHandler handler)
+            : executor_(executor),
+              buffers_(buffers),
+              handler_(std::move(handler))
+        {
+        }
+
+        void complete(std::deque<unsigned char>& data,
+                      const boost::system::error_code& ec) final
+        {
+            std::size_t bytes_transferred = 0;
+            for (auto it = boost::asio::buffer_sequence_begin(buffers_);
+                 it != boost::asio::buffer_sequence_end(buffers_);
+                 ++it) {
+                boost::asio::mutable_buffer buf(*it);
+                bytes_transferred += consume(data,
+                                             static_cast<unsigned char*>(buf.data()),
+                                             buf.size());
+            }
+
+            post_completion(executor_,
+                            std::move(handler_),
+                            bytes_transferred ? boost::system::error_code() : ec,
+                            bytes_transferred);
+        }
+
+        executor_type executor_;
+        MutableBufferSequence buffers_;
+        ReadHandler handler_;
+    };
+
+    template <typename MutableBufferSequence, typename ReadHandler>
+    auto memory_stream::async_read_some(const MutableBufferSequence& buffers, ReadHandler&& handler)
+    {
+        auto initiation = [this](auto&& handler, const MutableBufferSequence& buffers)
+                          {
+                              using handler_type = std::decay_t<decltype(handler)>;
+
+                              if (0 == boost::asio::buffer_size(buffers)) {
+                                  post_completion(executor_, std::move(handler), boost::system::error_code(), 0);
+                                  return;
+                              }
+
+                              std::unique_ptr<pending_read> op =
+                                  std::make_unique<pending_read_op<MutableBufferSequence, handler_type>>(executor_,
+                                                                                                         buffers,
+                                                                                                         std::move(handler));
+
+                              std::lock_guard<std::mutex> lock(in_->mutex);
+                              if (!in_->data.empty()) {
+                                  op->complete(in_->data, boost::system::error_code());
+                              } else if (in_->closed) {
+                                  op->complete(in_->data, boost::asio::error::eof);
+                              } else {
+                                  in_->reader = std::move(op);
+                              }
+                          };
+
+        return boost::asio::async_initiate<ReadHandler, void(boost::system::error_code, std::size_t)>(
+                    initiation, handler, buffers);
+    }
+
+    template <typename ConstBufferSequence, typename WriteHandler>
+    auto memory_stream::async_write_some(const ConstBufferSequence& buffers, WriteHandler&& handler)
+    {
+        auto initiation = [this](auto&& handler, const ConstBufferSequence& buffers)
+                          {
+                              std::size_t bytes_transferred = boost::asio::buffer_size(buffers);
+                              boost::system::error_code ec;
+
+                              {
+                                  std::lock_guard<std::mutex> lock(out_->mutex);
+                                  if (out_->closed) {
+                                      ec = boost::asio::error::broken_pipe;
+                                      bytes_transferred = 0;
+                                  } else {
+                                      for (auto it = boost::asio::buffer_sequence_begin(buffers);
+                                           it != boost::asio::buffer_sequence_end(buffers);
+                                           ++it) {
+                                          boost::asio::const_buffer buf(*it);
+                                          auto begin = static_cast<const unsigned char*>(buf.data());
+                                          out_->data.insert(out_->data.end(), begin, begin + buf.size());
+                                      }
+
+                                      if (out_->reader && !out_->data.empty()) {
+                                          std::unique_ptr<pending_read> reader = std::move(out_->reader);
+                                          reader->complete(out_->data, boost::system::error_code());
+                                      }
+                                  }
+                              }
+
+                              post_completion(executor_, std::move(handler), ec, bytes_transferred);
+                          };
+
+        return boost::asio::async_initiate<WriteHandler, void(boost::system::error_code, std::size_t)>(
+                    initiation, handler, buffers);
+    }
+
+}   // namespace asio
+}   // namespace xtt
+
+#endif
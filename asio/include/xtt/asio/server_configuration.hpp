@@ -0,0 +1,139 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#ifndef XTT_ASIO_SERVERCONFIGURATION_HPP
+#define XTT_ASIO_SERVERCONFIGURATION_HPP
+#pragma once
+
+#include <xtt/asio/server_context.hpp>
+
+#include <xtt.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace xtt {
+namespace asio {
+
+    using group_public_key_map = std::unordered_map<group_identity, std::shared_ptr<const group_public_key_context>>;
+
+    /*
+     * Everything a server needs to serve handshakes that may change while it runs:
+     *  its certificates, the groups it accepts, and its suite policy.
+     *
+     * Snapshots are immutable once created,
+     *  so a handshake that holds one sees a consistent configuration
+     *  however many reloads happen meanwhile.
+     */
+    class server_configuration {
+    public:
+        /*
+         * Returns nullptr if `certificates` is empty.
+         *
+         * A `group_identity_filter` is built from the GIDs in `gpks`.
+         * A null `policy` allows every suite.
+         */
+        static
+        std::shared_ptr<const server_configuration>
+        create(shared_server_certificate_map certificates,
+               group_public_key_map gpks,
+               std::shared_ptr<const suite_policy> policy = nullptr);
+
+    public:
+        /*
+         * Pin this snapshot for `ctx`'s handshake:
+         *  its certificates, suite policy and group filter are set on `ctx`.
+         *
+         * GPKs should be looked up (with `find_gpk`)
+         *  through a `shared_ptr` to this snapshot held by the GPK lookup callback.
+         */
+        template <typename Stream>
+        void apply_to(basic_server_context<Stream>& ctx) const
+        {
+            ctx.load_certificate(certificates_);
+            ctx.set_suite_policy(policy_);
+            ctx.set_group_filter(group_filter_);
+        }
+
+        /*
+         * Returns nullptr if `gid` isn't a known group.
+         *
+         * The GPK is shared with this snapshot, not copied,
+         *  so it can be handed straight to the GPK lookup handler.
+         */
+        std::shared_ptr<const group_public_key_context> find_gpk(const group_identity& gid) const;
+
+        std::size_t group_count() const;
+
+    private:
+        server_configuration() = default;
+
+        shared_server_certificate_map certificates_;
+        group_public_key_map gpks_;
+        std::shared_ptr<const suite_policy> policy_;
+        std::shared_ptr<const group_identity_filter> group_filter_;
+    };
+
+    /*
+     * The current `server_configuration`, replaceable while handshakes run.
+     *
+     * `load` never blocks: it copies the current `shared_ptr`
+     *  under a reader count rather than a lock,
+     *  so I/O threads never wait on a reload.
+     * `publish` swaps in the new snapshot and then waits out any `load`s still copying the old one;
+     *  the expensive part, building the new snapshot, happens before `publish`.
+     * A snapshot is freed once the last handshake pinning it has finished.
+     */
+    class server_configuration_store {
+    public:
+        explicit server_configuration_store(std::shared_ptr<const server_configuration> initial);
+
+        ~server_configuration_store();
+
+        server_configuration_store(const server_configuration_store&) = delete;
+        server_configuration_store& operator=(const server_configuration_store&) = delete;
+
+        std::shared_ptr<const server_configuration> load() const;
+
+        void publish(std::shared_ptr<const server_configuration> config);
+
+    private:
+        // Returns the reader slot to pass to `leave`
+        unsigned enter() const;
+        void leave(unsigned slot) const;
+
+        // Returns once every `load` that may have seen the previous `current_` has finished
+        void wait_for_readers();
+
+        std::atomic<const std::shared_ptr<const server_configuration>*> current_;
+
+        // Loads count themselves in the slot of the current epoch,
+        //  so `wait_for_readers` can wait out each slot in turn while new loads use the other.
+        mutable std::atomic<unsigned> epoch_;
+        mutable std::atomic<std::size_t> readers_[2];
+
+        std::mutex publish_mutex_;
+    };
+
+}   // namespace asio
+}   // namespace xtt
+
+#endif
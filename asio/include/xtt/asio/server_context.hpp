@@ -22,42 +22,235 @@
 
 #include <xtt.hpp>
 
+#include <xtt/asio/error_category.hpp>
+
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/io_context.hpp>
+#include <boost/asio/associated_executor.hpp>
 #include <boost/asio/bind_executor.hpp>
+#include <boost/asio/post.hpp>
 #include <boost/asio/write.hpp>
 #include <boost/asio/read.hpp>
 #include <boost/asio/strand.hpp>
 #include <boost/system/error_code.hpp>
 
+#include <algorithm>
 #include <memory>
 #include <unordered_map>
 #include <functional>
 #include <tuple>
+#include <type_traits>
+#include <utility>
 
 namespace xtt {
 namespace asio {
 
     using server_certificate_map = std::unordered_map<suite_spec, std::unique_ptr<server_certificate_context>>;
 
-    class server_context {
+    using shared_server_certificate_map = std::shared_ptr<const server_certificate_map>;
+
+    /*
+     * Parse a certificate and private key once, for every suite that can use them.
+     *
+     * The result can be handed to any number of server contexts,
+     *  so the certificate is not parsed and copied for every connection.
+     *
+     * Returns nullptr (and sets `ec`) if the certificate or key are invalid.
+     */
+    shared_server_certificate_map
+    make_server_certificate_map(const std::vector<unsigned char>& certificate,
+                                const std::vector<unsigned char>& private_key,
+                                boost::system::error_code& ec);
+
+    namespace detail {
+
+        // Streams that wrap another (e.g. ssl::stream) expose `next_layer_type`
+        // and know their own lowest layer. Anything else is its own lowest layer.
+
+        template <typename Stream, typename = void>
+        struct lowest_layer_of {
+            using type = Stream;
+
+            static type& get(Stream& stream)
+            {
+                return stream;
+            }
+
+            static const type& get(const Stream& stream)
+            {
+                return stream;
+            }
+        };
+
+        template <typename Stream>
+        struct lowest_layer_of<Stream, decltype(void(std::declval<typename Stream::next_layer_type*>()))> {
+            using type = typename Stream::lowest_layer_type;
+
+            static type& get(Stream& stream)
+            {
+                return stream.lowest_layer();
+            }
+
+            static const type& get(const Stream& stream)
+            {
+                return stream.lowest_layer();
+            }
+        };
+
+    }   // namespace detail
+
+    /*
+     * Counts of the I/O done on a server context's stream.
+     *
+     * Each read or write call corresponds to one `read_some`/`write_some`
+     *  on the stream, i.e. roughly one syscall on a socket.
+     */
+    struct io_statistics {
+        std::size_t read_calls = 0;
+        std::size_t write_calls = 0;
+        std::size_t bytes_read = 0;
+        std::size_t bytes_written = 0;
+    };
+
+    /*
+     * Server side of an XTT handshake, over any `Stream` meeting the
+     *  AsyncReadStream and AsyncWriteStream requirements
+     *  (a TCP or AF_UNIX socket, an ssl::stream, a `memory_stream`, ...).
+     */
+    template <typename Stream>
+    class basic_server_context {
     public:
-        server_context(boost::asio::ip::tcp::socket tcp_socket,
-                       server_cookie_context& cookie_ctx);
+        using next_layer_type = Stream;
+        using lowest_layer_type = typename detail::lowest_layer_of<Stream>::type;
+        using executor_type = boost::asio::executor;
+
+        basic_server_context(Stream stream,
+                             server_cookie_context& cookie_ctx);
 
         void load_certificate(const std::vector<unsigned char>& certificate,
                               const std::vector<unsigned char>& private_key,
                               boost::system::error_code& ec);
 
-        const boost::asio::ip::tcp::socket& lowest_layer() const;
-        boost::asio::ip::tcp::socket& lowest_layer();
+        /*
+         * Use certificates shared with other contexts
+         *  (see `make_server_certificate_map`).
+         */
+        void load_certificate(shared_server_certificate_map certificates);
+
+        /*
+         * Reject clients whose chosen suite `policy` disallows,
+         *  with `return_code::UNKNOWN_SUITE_SPEC`, before any cryptographic work.
+         *
+         * By default, any suite with a loaded certificate is accepted.
+         * A policy can be shared by any number of contexts.
+         */
+        void set_suite_policy(std::shared_ptr<const suite_policy> policy);
+
+        /*
+         * Reject clients claiming a group ID not in `filter`,
+         *  with `return_code::UNKNOWN_GID`, as soon as the ID is parsed
+         *  (without calling `async_lookup_gpk`).
+         *
+         * A small fraction of unknown GIDs pass the filter,
+         *  so `async_lookup_gpk` must still handle them.
+         */
+        void set_group_filter(std::shared_ptr<const group_identity_filter> filter);
+
+        /*
+         * Reject clients whose pseudonym is in `revoked`, with `get_revoked_pseudonym_ec()`,
+         *  as soon as their group signature has been verified
+         *  (before `async_assign_id` is called).
+         *
+         * Updates to `revoked` apply to handshakes already in progress.
+         */
+        void set_revocation_list(std::shared_ptr<const pseudonym_revocation_list> revoked);
+
+        /*
+         * Record the bytes received from the client, with their arrival times,
+         *  to `trace` (e.g. for replaying with `xtt_replay`).
+         *
+         * Must be set before `async_handle_connect`.
+         */
+        void set_trace(std::shared_ptr<handshake_trace_writer> trace);
+
+        executor_type get_executor();
+
+        const next_layer_type& next_layer() const;
+        next_layer_type& next_layer();
+
+        const lowest_layer_type& lowest_layer() const;
+        lowest_layer_type& lowest_layer();
+
+        /*
+         * Close the stream on the context's strand,
+         *  so a handshake in progress (which then fails) isn't raced on other threads.
+         *
+         * `handler()` is then posted to its associated executor (by default, the context's strand).
+         *  The context must not be destroyed before then.
+         */
+        template <typename Handler>
+        void async_close(Handler handler);
 
         std::unique_ptr<pseudonym> get_clients_pseudonym() const;
 
+        bool get_clients_pseudonym(pseudonym_lrsw& out) const;
+
+        template <typename Algorithm>
+        bool get_clients_pseudonym(pseudonym_value<Algorithm>& out) const;
+
+        OPTIONAL_NS::optional<suite_spec> get_suite_spec() const;
+
         std::unique_ptr<longterm_key> get_clients_longterm_key() const;
 
         OPTIONAL_NS::optional<identity> get_clients_identity() const;
 
+        /*
+         * The identity `async_assign_id` gave the client in this handshake,
+         *  whether or not the handshake went on to succeed
+         *  (empty if none was assigned).
+         */
+        const OPTIONAL_NS::optional<identity>& get_assigned_identity() const;
+
+        /*
+         * Everything learned about the client,
+         *  captured once when the handshake finished successfully
+         *  (empty before then, or if the handshake failed).
+         */
+        const OPTIONAL_NS::optional<handshake_result>& get_handshake_result() const;
+
+        /*
+         * Hand over the handshake result, and securely erase everything else.
+         *
+         * The message buffers and libxtt handshake state are wiped,
+         *  and this context's reference to the certificates is released.
+         * The stream is left untouched, for use by the application.
+         *
+         * Returns an empty optional if the handshake did not finish successfully.
+         *
+         * The message buffers, readahead buffer and libxtt handshake state
+         *  are allocated apart from the context, and freed here,
+         *  so a context kept after `finish` holds little more than its stream.
+         * After `finish`, the context must not be used to run another handshake,
+         *  and the client's details are only available from the returned `handshake_result`.
+         */
+        OPTIONAL_NS::optional<handshake_result> finish();
+
+        /*
+         * Enable or disable read coalescing (enabled by default).
+         *
+         * When enabled, each read pulls as much as the stream has available
+         *  into a per-connection readahead buffer, and libxtt is fed from there,
+         *  so a message whose header and body arrive together costs one read.
+         *  The buffer is allocated on the first such read.
+         * When disabled, exactly the bytes libxtt asks for are read,
+         *  and no readahead buffer is kept.
+         *
+         * Must be set before `async_handle_connect`.
+         */
+        void set_read_coalescing(bool enabled);
+
+        const io_statistics& get_io_statistics() const;
+
         /*
          * Begin the server's end of an XTT handshake, from the very first client message.
          *
@@ -73,6 +266,8 @@ namespace asio {
          *   -  Further, `async_lookup_gpk` MUST NOT call `handler` itself.
          *      Instead, it must invoke the handler in a manner equivalent to using
          *      `boost::asio:io_context::post()`.
+         *   -  `handler` takes `(const boost::system::error_code&, std::shared_ptr<const group_public_key_context>)`,
+         *      so a GPK shared by many handshakes can be passed without copying it.
          *
          * - `async_assign_id` must have the signature:
          *      template <typename AssignIDHandler>
@@ -105,6 +300,12 @@ namespace asio {
         void
         async_do_read(std::tuple<GPKLookupCallback, AssignIdCallback, Handler> func_pack);
 
+        template <typename GPKLookupCallback,
+                  typename AssignIdCallback,
+                  typename Handler>
+        void
+        feed_from_readahead(std::tuple<GPKLookupCallback, AssignIdCallback, Handler> func_pack);
+
         template <typename GPKLookupCallback,
                   typename AssignIdCallback,
                   typename Handler>
@@ -128,7 +329,7 @@ namespace asio {
                   typename Handler>
         void
         async_found_gpk_callback(boost::system::error_code ec,
-                                 std::unique_ptr<group_public_key_context> gpk_ctx,
+                                 std::shared_ptr<const group_public_key_context> gpk_ctx,
                                  std::tuple<GPKLookupCallback, AssignIdCallback, Handler> func_pack);
 
         template <typename GPKLookupCallback,
@@ -163,26 +364,57 @@ namespace asio {
         bool set_cert(std::tuple<GPKLookupCallback, AssignIdCallback, Handler>& func_pack);
 
     private:
-        std::array<unsigned char, MAX_HANDSHAKE_CLIENT_MESSAGE_LENGTH> in_buffer_;
-        std::array<unsigned char, MAX_HANDSHAKE_SERVER_MESSAGE_LENGTH> out_buffer_;
+        // Only needed until the handshake is over, so freed by `finish`
+        struct handshake_state {
+            handshake_state();
+
+            std::array<unsigned char, MAX_HANDSHAKE_CLIENT_MESSAGE_LENGTH> in_buffer;
+            std::array<unsigned char, MAX_HANDSHAKE_SERVER_MESSAGE_LENGTH> out_buffer;
+            server_handshake_context handshake_ctx;
+        };
+
+        std::unique_ptr<handshake_state> state_;
+        std::unique_ptr<unsigned char[]> readahead_;     // MAX_HANDSHAKE_CLIENT_MESSAGE_LENGTH bytes, when coalescing
+        std::size_t readahead_begin_;
+        std::size_t readahead_end_;
+        bool read_coalescing_;
         server_handshake_context::io_buffer io_buf_;
-        server_handshake_context handshake_ctx_;
 
-        boost::asio::ip::tcp::socket socket_;
+        Stream socket_;
         boost::asio::strand<boost::asio::executor> strand_;
 
         xtt::identity requested_client_id_;
         xtt::group_identity claimed_group_id_;
-        server_certificate_map cert_map_;
-        server_certificate_map::const_iterator cert_;
+        shared_server_certificate_map cert_map_;
+        const server_certificate_context* cert_;
+        std::shared_ptr<const suite_policy> suite_policy_;
+        std::shared_ptr<const group_identity_filter> group_filter_;
+        std::shared_ptr<const pseudonym_revocation_list> revocation_list_;
+        std::shared_ptr<handshake_trace_writer> trace_;
+        std::uint32_t trace_connection_;
         server_cookie_context& cookie_ctx_;
 
+        OPTIONAL_NS::optional<identity> assigned_id_;
+        OPTIONAL_NS::optional<handshake_result> result_;
+
+        io_statistics io_stats_;
+
         boost::system::error_code ec_;
     };
 
+    using server_context = basic_server_context<boost::asio::ip::tcp::socket>;
+
 }   // namespace asio
 }   // namespace xtt
 
 #include "server_context.inl"
 
+namespace xtt {
+namespace asio {
+
+    extern template class basic_server_context<boost::asio::ip::tcp::socket>;
+
+}   // namespace asio
+}   // namespace xtt
+
 #endif
@@ -16,20 +16,295 @@
  *
  *****************************************************************************/
 
-#include <xtt/asio/error_category.hpp>
-
 namespace xtt {
 namespace asio {
 
+    template <typename Stream>
+    basic_server_context<Stream>::handshake_state::handshake_state()
+        : in_buffer(),
+          out_buffer(),
+          handshake_ctx(in_buffer.data(), in_buffer.size(), out_buffer.data(), out_buffer.size())
+    {
+    }
+
+    template <typename Stream>
+    basic_server_context<Stream>::basic_server_context(Stream stream,
+                                                       server_cookie_context& cookie_ctx)
+        : state_(std::make_unique<handshake_state>()),
+          readahead_(),
+          readahead_begin_(0),
+          readahead_end_(0),
+          read_coalescing_(true),
+          io_buf_(),
+          socket_(std::move(stream)),
+          strand_(boost::asio::make_strand(executor_type(socket_.get_executor()))),
+          cert_map_(),
+          cert_(nullptr),
+          suite_policy_(),
+          group_filter_(),
+          revocation_list_(),
+          trace_(),
+          trace_connection_(0),
+          cookie_ctx_(cookie_ctx),
+          assigned_id_(),
+          result_(),
+          io_stats_()
+    {
+    }
+
+    template <typename Stream>
+    void basic_server_context<Stream>::load_certificate(const std::vector<unsigned char>& certificate,
+                                                        const std::vector<unsigned char>& private_key,
+                                                        boost::system::error_code& ec)
+    {
+        auto certificates = make_server_certificate_map(certificate, private_key, ec);
+        if (ec)
+            return;
+
+        load_certificate(std::move(certificates));
+    }
+
+    template <typename Stream>
+    void basic_server_context<Stream>::load_certificate(shared_server_certificate_map certificates)
+    {
+        cert_map_ = std::move(certificates);
+        cert_ = nullptr;
+    }
+
+    template <typename Stream>
+    void basic_server_context<Stream>::set_suite_policy(std::shared_ptr<const suite_policy> policy)
+    {
+        suite_policy_ = std::move(policy);
+    }
+
+    template <typename Stream>
+    void basic_server_context<Stream>::set_group_filter(std::shared_ptr<const group_identity_filter> filter)
+    {
+        group_filter_ = std::move(filter);
+    }
+
+    template <typename Stream>
+    void basic_server_context<Stream>::set_revocation_list(std::shared_ptr<const pseudonym_revocation_list> revoked)
+    {
+        revocation_list_ = std::move(revoked);
+    }
+
+    template <typename Stream>
+    void basic_server_context<Stream>::set_trace(std::shared_ptr<handshake_trace_writer> trace)
+    {
+        trace_ = std::move(trace);
+    }
+
+    template <typename Stream>
+    typename basic_server_context<Stream>::executor_type
+    basic_server_context<Stream>::get_executor()
+    {
+        return socket_.get_executor();
+    }
+
+    template <typename Stream>
+    const typename basic_server_context<Stream>::next_layer_type&
+    basic_server_context<Stream>::next_layer() const
+    {
+        return socket_;
+    }
+
+    template <typename Stream>
+    typename basic_server_context<Stream>::next_layer_type&
+    basic_server_context<Stream>::next_layer()
+    {
+        return socket_;
+    }
+
+    template <typename Stream>
+    const typename basic_server_context<Stream>::lowest_layer_type&
+    basic_server_context<Stream>::lowest_layer() const
+    {
+        return detail::lowest_layer_of<Stream>::get(socket_);
+    }
+
+    template <typename Stream>
+    typename basic_server_context<Stream>::lowest_layer_type&
+    basic_server_context<Stream>::lowest_layer()
+    {
+        return detail::lowest_layer_of<Stream>::get(socket_);
+    }
+
+    template <typename Stream>
+    template <typename Handler>
+    void basic_server_context<Stream>::async_close(Handler handler)
+    {
+        boost::asio::post(strand_,
+                          [this, handler(std::move(handler))]()
+                          {
+                              boost::system::error_code ignored;
+                              this->lowest_layer().close(ignored);
+
+                              boost::asio::post(boost::asio::get_associated_executor(handler, strand_),
+                                                handler);
+                          });
+    }
+
+    template <typename Stream>
+    std::unique_ptr<pseudonym> basic_server_context<Stream>::get_clients_pseudonym() const
+    {
+        if (!state_)
+            return {};
+
+        return state_->handshake_ctx.get_clients_pseudonym();
+    }
+
+    template <typename Stream>
+    bool basic_server_context<Stream>::get_clients_pseudonym(pseudonym_lrsw& out) const
+    {
+        if (!state_)
+            return false;
+
+        return state_->handshake_ctx.get_clients_pseudonym(out);
+    }
+
+    template <typename Stream>
+    template <typename Algorithm>
+    bool basic_server_context<Stream>::get_clients_pseudonym(pseudonym_value<Algorithm>& out) const
+    {
+        if (!state_)
+            return false;
+
+        return state_->handshake_ctx.get_clients_pseudonym(out);
+    }
+
+    template <typename Stream>
+    OPTIONAL_NS::optional<suite_spec> basic_server_context<Stream>::get_suite_spec() const
+    {
+        if (!state_)
+            return {};
+
+        return state_->handshake_ctx.get_suite_spec();
+    }
+
+    template <typename Stream>
+    std::unique_ptr<longterm_key> basic_server_context<Stream>::get_clients_longterm_key() const
+    {
+        if (!state_)
+            return {};
+
+        return state_->handshake_ctx.get_clients_longterm_key();
+    }
+
+    template <typename Stream>
+    OPTIONAL_NS::optional<identity> basic_server_context<Stream>::get_clients_identity() const
+    {
+        if (!state_)
+            return {};
+
+        return state_->handshake_ctx.get_clients_identity();
+    }
+
+    template <typename Stream>
+    const OPTIONAL_NS::optional<handshake_result>&
+    basic_server_context<Stream>::get_handshake_result() const
+    {
+        return result_;
+    }
+
+    template <typename Stream>
+    const OPTIONAL_NS::optional<identity>&
+    basic_server_context<Stream>::get_assigned_identity() const
+    {
+        return assigned_id_;
+    }
+
+    template <typename Stream>
+    OPTIONAL_NS::optional<handshake_result>
+    basic_server_context<Stream>::finish()
+    {
+        OPTIONAL_NS::optional<handshake_result> ret = std::move(result_);
+        result_ = OPTIONAL_NS::nullopt;
+
+        if (state_) {
+            state_->handshake_ctx.wipe();
+            secure_zero(state_->in_buffer.data(), state_->in_buffer.size());
+            secure_zero(state_->out_buffer.data(), state_->out_buffer.size());
+            state_.reset();
+        }
+        if (readahead_) {
+            secure_zero(readahead_.get(), MAX_HANDSHAKE_CLIENT_MESSAGE_LENGTH);
+            readahead_.reset();
+        }
+        readahead_begin_ = 0;
+        readahead_end_ = 0;
+        io_buf_ = server_handshake_context::io_buffer();
+
+        cert_ = nullptr;
+        cert_map_.reset();
+
+        return ret;
+    }
+
+    template <typename Stream>
+    void basic_server_context<Stream>::set_read_coalescing(bool enabled)
+    {
+        read_coalescing_ = enabled;
+        if (!enabled)
+            readahead_.reset();
+    }
+
+    template <typename Stream>
+    const io_statistics& basic_server_context<Stream>::get_io_statistics() const
+    {
+        return io_stats_;
+    }
+
+    template <typename Stream>
     template <typename GPKLookupCallback,
               typename AssignIdCallback,
               typename Handler>
     void
-    server_context::async_do_read(std::tuple<GPKLookupCallback, AssignIdCallback, Handler> func_pack)
+    basic_server_context<Stream>::async_do_read(std::tuple<GPKLookupCallback, AssignIdCallback, Handler> func_pack)
     {
+        if (read_coalescing_) {
+            if (readahead_begin_ != readahead_end_) {
+                feed_from_readahead(std::move(func_pack));
+                return;
+            }
+
+            if (!readahead_)
+                readahead_ = std::make_unique<unsigned char[]>(MAX_HANDSHAKE_CLIENT_MESSAGE_LENGTH);
+
+            ++io_stats_.read_calls;
+            socket_.async_read_some(boost::asio::buffer(readahead_.get(), MAX_HANDSHAKE_CLIENT_MESSAGE_LENGTH),
+                                    boost::asio::bind_executor(strand_,
+                                                               [this, func_pack(std::move(func_pack))]
+                                                               (auto&& ec, auto&& bytes_transferred)
+                                                               {
+                                                                   if (ec) {
+                                                                       std::get<2>(func_pack)(ec);
+                                                                       return;
+                                                                   }
+
+                                                                   io_stats_.bytes_read += bytes_transferred;
+                                                                   if (trace_)
+                                                                       trace_->record(trace_connection_, readahead_.get(), bytes_transferred);
+                                                                   readahead_begin_ = 0;
+                                                                   readahead_end_ = bytes_transferred;
+
+                                                                   this->feed_from_readahead(std::move(func_pack));
+                                                               }));
+            return;
+        }
+
+        auto len = io_buf_.len;
         boost::asio::async_read(socket_,
                                 boost::asio::buffer(io_buf_.ptr,
                                                     io_buf_.len),
+                                [this, len](const boost::system::error_code& ec, std::size_t bytes_so_far) -> std::size_t
+                                {
+                                    if (ec || bytes_so_far >= len)
+                                        return 0;
+
+                                    ++io_stats_.read_calls;
+                                    return len - bytes_so_far;
+                                },
                                 boost::asio::bind_executor(strand_,
                                                            [this, func_pack(std::move(func_pack))]
                                                            (auto&& ec, auto&& bytes_transferred)
@@ -39,7 +314,11 @@ namespace asio {
                                                                    return;
                                                                }
 
-                                                               return_code current_rc = handshake_ctx_.handle_io(0,   // no bytes written
+                                                               io_stats_.bytes_read += bytes_transferred;
+                                                               if (trace_)
+                                                                   trace_->record(trace_connection_, io_buf_.ptr, bytes_transferred);
+
+                                                               return_code current_rc = state_->handshake_ctx.handle_io(0,   // no bytes written
                                                                                                                  bytes_transferred,
                                                                                                                  io_buf_);
 
@@ -48,15 +327,46 @@ namespace asio {
                                                            }));
     }
 
+    template <typename Stream>
     template <typename GPKLookupCallback,
               typename AssignIdCallback,
               typename Handler>
     void
-    server_context::async_do_write(std::tuple<GPKLookupCallback, AssignIdCallback, Handler> func_pack)
+    basic_server_context<Stream>::feed_from_readahead(std::tuple<GPKLookupCallback, AssignIdCallback, Handler> func_pack)
     {
+        std::size_t bytes_read = std::min<std::size_t>(readahead_end_ - readahead_begin_, io_buf_.len);
+        std::copy(readahead_.get() + readahead_begin_,
+                  readahead_.get() + readahead_begin_ + bytes_read,
+                  io_buf_.ptr);
+        readahead_begin_ += bytes_read;
+
+        return_code current_rc = state_->handshake_ctx.handle_io(0,   // no bytes written
+                                                          bytes_read,
+                                                          io_buf_);
+
+        async_run_state_machine(current_rc,
+                                std::move(func_pack));
+    }
+
+    template <typename Stream>
+    template <typename GPKLookupCallback,
+              typename AssignIdCallback,
+              typename Handler>
+    void
+    basic_server_context<Stream>::async_do_write(std::tuple<GPKLookupCallback, AssignIdCallback, Handler> func_pack)
+    {
+        auto len = io_buf_.len;
         boost::asio::async_write(socket_,
                                  boost::asio::buffer(io_buf_.ptr,
                                                      io_buf_.len),
+                                 [this, len](const boost::system::error_code& ec, std::size_t bytes_so_far) -> std::size_t
+                                 {
+                                     if (ec || bytes_so_far >= len)
+                                         return 0;
+
+                                     ++io_stats_.write_calls;
+                                     return len - bytes_so_far;
+                                 },
                                  boost::asio::bind_executor(strand_,
                                                             [this, func_pack(std::move(func_pack))]
                                                             (auto&& ec, auto&& bytes_transferred)
@@ -66,7 +376,9 @@ namespace asio {
                                                                     return;
                                                                 }
 
-                                                                return_code current_rc = handshake_ctx_.handle_io(bytes_transferred,
+                                                                io_stats_.bytes_written += bytes_transferred;
+
+                                                                return_code current_rc = state_->handshake_ctx.handle_io(bytes_transferred,
                                                                                                                   0,  // no bytes read
                                                                                                                   io_buf_);
 
@@ -75,82 +387,88 @@ namespace asio {
                                                             }));
     }
 
+    template <typename Stream>
     template <typename GPKLookupCallback,
               typename AssignIdCallback,
               typename Handler>
-    bool server_context::set_cert(std::tuple<GPKLookupCallback, AssignIdCallback, Handler>& func_pack)
+    bool basic_server_context<Stream>::set_cert(std::tuple<GPKLookupCallback, AssignIdCallback, Handler>& func_pack)
     {
         // Take func_pack by reference, because this function is synchronous
 
-        if (cert_ != cert_map_.end())
+        if (cert_)
             return true;
 
-        auto suite_spec = handshake_ctx_.get_suite_spec();
-        if (!suite_spec) {
+        auto suite_spec = state_->handshake_ctx.get_suite_spec();
+        if (!suite_spec || (suite_policy_ && !suite_policy_->is_allowed(*suite_spec))) {
             this->ec_ = boost::system::error_code(static_cast<int>(return_code::UNKNOWN_SUITE_SPEC),
                                                                    get_xtt_category());
             async_send_error_msg(std::move(func_pack));
             return false;
         }
 
-        auto cert_it = cert_map_.find(*suite_spec);
-        if (cert_map_.end() != cert_it) {
-            cert_ = cert_it;
+        if (cert_map_) {
+            auto cert_it = cert_map_->find(*suite_spec);
+            if (cert_map_->end() != cert_it) {
+                cert_ = cert_it->second.get();
 
-            return true;
-        } else {
-            this->ec_ = boost::system::error_code(static_cast<int>(return_code::UNKNOWN_CERTIFICATE),
-                                                  get_xtt_category());
-            async_send_error_msg(std::move(func_pack));
-            return false;
+                return true;
+            }
         }
+
+        this->ec_ = boost::system::error_code(static_cast<int>(return_code::UNKNOWN_CERTIFICATE),
+                                              get_xtt_category());
+        async_send_error_msg(std::move(func_pack));
+        return false;
     }
 
+    template <typename Stream>
     template <typename GPKLookupCallback,
               typename AssignIdCallback,
               typename Handler>
     void
-    server_context::async_buildserverattest(std::tuple<GPKLookupCallback, AssignIdCallback, Handler> func_pack)
+    basic_server_context<Stream>::async_buildserverattest(std::tuple<GPKLookupCallback, AssignIdCallback, Handler> func_pack)
     {
         if (!set_cert(func_pack)) {
             return; // set_cert takes care of raising the callback
         }
 
-        return_code new_rc = handshake_ctx_.build_serverattest(io_buf_,
-                                                               *cert_->second,
+        return_code new_rc = state_->handshake_ctx.build_serverattest(io_buf_,
+                                                               *cert_,
                                                                cookie_ctx_);
 
         async_run_state_machine(new_rc,
                                 std::move(func_pack));
     }
 
+    template <typename Stream>
     template <typename GPKLookupCallback,
               typename AssignIdCallback,
               typename Handler>
     void
-    server_context::async_preparseidclientattest(std::tuple<GPKLookupCallback, AssignIdCallback, Handler> func_pack)
+    basic_server_context<Stream>::async_preparseidclientattest(std::tuple<GPKLookupCallback, AssignIdCallback, Handler> func_pack)
     {
         if (!set_cert(func_pack)) {
             return; // set_cert takes care of raising the callback
         }
 
-        return_code new_rc = handshake_ctx_.preparse_idclientattest(io_buf_,
+        return_code new_rc = state_->handshake_ctx.preparse_idclientattest(io_buf_,
                                                                     requested_client_id_,
                                                                     claimed_group_id_,
                                                                     cookie_ctx_,
-                                                                    *cert_->second);
+                                                                    *cert_);
 
         async_run_state_machine(new_rc,
                                 std::move(func_pack));
     }
 
+    template <typename Stream>
     template <typename GPKLookupCallback,
               typename AssignIdCallback,
               typename Handler>
     void
-    server_context::async_found_gpk_callback(boost::system::error_code ec,
-                                             std::unique_ptr<group_public_key_context> gpk_ctx,
-                                             std::tuple<GPKLookupCallback, AssignIdCallback, Handler> func_pack)
+    basic_server_context<Stream>::async_found_gpk_callback(boost::system::error_code ec,
+                                                           std::shared_ptr<const group_public_key_context> gpk_ctx,
+                                                           std::tuple<GPKLookupCallback, AssignIdCallback, Handler> func_pack)
     {
         if (ec) {
             ec_ = ec;
@@ -162,21 +480,22 @@ namespace asio {
             return; // set_cert takes care of raising the callback
         }
 
-        return_code new_rc = handshake_ctx_.verify_groupsignature(io_buf_,
+        return_code new_rc = state_->handshake_ctx.verify_groupsignature(io_buf_,
                                                                   *gpk_ctx,
-                                                                  *cert_->second);
+                                                                  *cert_);
 
         async_run_state_machine(new_rc,
                                 std::move(func_pack));
     }
 
+    template <typename Stream>
     template <typename GPKLookupCallback,
               typename AssignIdCallback,
               typename Handler>
     void
-    server_context::async_assigned_id_callback(boost::system::error_code ec,
-                                               identity assigned_id,
-                                               std::tuple<GPKLookupCallback, AssignIdCallback, Handler> func_pack)
+    basic_server_context<Stream>::async_assigned_id_callback(boost::system::error_code ec,
+                                                             identity assigned_id,
+                                                             std::tuple<GPKLookupCallback, AssignIdCallback, Handler> func_pack)
     {
         if (ec) {
             ec_ = ec;
@@ -184,26 +503,35 @@ namespace asio {
             return;
         }
 
-        return_code new_rc = handshake_ctx_.build_idserverfinished(io_buf_,
+        assigned_id_ = assigned_id;
+
+        return_code new_rc = state_->handshake_ctx.build_idserverfinished(io_buf_,
                                                                    assigned_id);
 
         async_run_state_machine(new_rc,
                                 std::move(func_pack));
     }
 
+    template <typename Stream>
     template <typename GPKLookupCallback,
               typename AssignIdCallback,
               typename Handler>
     void
-    server_context::async_verifygroupsignature(std::tuple<GPKLookupCallback, AssignIdCallback, Handler> func_pack)
+    basic_server_context<Stream>::async_verifygroupsignature(std::tuple<GPKLookupCallback, AssignIdCallback, Handler> func_pack)
     {
+        if (group_filter_ && !group_filter_->may_contain(claimed_group_id_)) {
+            ec_ = get_unknown_gid_ec();
+            async_send_error_msg(std::move(func_pack));
+            return;
+        }
+
         boost::asio::post(strand_,
                           [this, func_pack(std::move(func_pack))]()
                           {
                               std::get<0>(func_pack)(claimed_group_id_,
                                                      requested_client_id_,
                                                      [this, func_pack(std::move(func_pack))]
-                                                     (auto&& ec, std::unique_ptr<group_public_key_context> gpk_ctx)
+                                                     (auto&& ec, std::shared_ptr<const group_public_key_context> gpk_ctx)
                                                      {
                                                          this->async_found_gpk_callback(ec,
                                                                                         std::move(gpk_ctx),
@@ -213,12 +541,28 @@ namespace asio {
     }
 
 
+    template <typename Stream>
     template <typename GPKLookupCallback,
               typename AssignIdCallback,
               typename Handler>
     void
-    server_context::async_buildidserverfinished(std::tuple<GPKLookupCallback, AssignIdCallback, Handler> func_pack)
+    basic_server_context<Stream>::async_buildidserverfinished(std::tuple<GPKLookupCallback, AssignIdCallback, Handler> func_pack)
     {
+        if (revocation_list_) {
+            pseudonym_lrsw nym;
+            if (!state_->handshake_ctx.get_clients_pseudonym(nym)) {
+                ec_ = boost::system::error_code(static_cast<int>(return_code::DAA),
+                                                get_xtt_category());
+                async_send_error_msg(std::move(func_pack));
+                return;
+            }
+            if (revocation_list_->is_revoked(nym)) {
+                ec_ = get_revoked_pseudonym_ec();
+                async_send_error_msg(std::move(func_pack));
+                return;
+            }
+        }
+
         boost::asio::post(strand_,
                           [this, func_pack(std::move(func_pack))]()
                           {
@@ -234,12 +578,13 @@ namespace asio {
                           });
     }
 
+    template <typename Stream>
     template <typename GPKLookupCallback,
               typename AssignIdCallback,
               typename Handler>
     void
-    server_context::async_run_state_machine(return_code current_rc,
-                                            std::tuple<GPKLookupCallback, AssignIdCallback, Handler> func_pack)
+    basic_server_context<Stream>::async_run_state_machine(return_code current_rc,
+                                                          std::tuple<GPKLookupCallback, AssignIdCallback, Handler> func_pack)
     {
         switch (current_rc) {
             case return_code::WANT_WRITE:
@@ -269,6 +614,8 @@ namespace asio {
             case return_code::HANDSHAKE_FINISHED:
                 ec_ = boost::system::error_code();
 
+                result_ = state_->handshake_ctx.get_handshake_result();
+
                 boost::asio::post(strand_,
                                   [this, func_pack(std::move(func_pack))]()
                                   {
@@ -295,15 +642,21 @@ namespace asio {
         }
     }
 
+    template <typename Stream>
     template <typename GPKLookupCallback,
               typename AssignIdCallback,
               typename Handler>
     void
-    server_context::async_handle_connect(GPKLookupCallback async_lookup_gpk,
-                                         AssignIdCallback async_assign_id,
-                                         Handler handler)
+    basic_server_context<Stream>::async_handle_connect(GPKLookupCallback async_lookup_gpk,
+                                                       AssignIdCallback async_assign_id,
+                                                       Handler handler)
     {
-        return_code current_rc = handshake_ctx_.handle_connect(io_buf_);
+        if (trace_)
+            trace_connection_ = trace_->begin_connection();
+
+        assigned_id_ = OPTIONAL_NS::nullopt;
+
+        return_code current_rc = state_->handshake_ctx.handle_connect(io_buf_);
 
         auto func_pack = std::make_tuple(std::move(async_lookup_gpk),
                                          std::move(async_assign_id),
@@ -312,19 +665,32 @@ namespace asio {
         async_run_state_machine(current_rc, std::move(func_pack));
     }
 
+    template <typename Stream>
     template <typename GPKLookupCallback,
               typename AssignIdCallback,
               typename Handler>
     void
-    server_context::async_send_error_msg(std::tuple<GPKLookupCallback, AssignIdCallback, Handler> func_pack)
+    basic_server_context<Stream>::async_send_error_msg(std::tuple<GPKLookupCallback, AssignIdCallback, Handler> func_pack)
     {
-        (void)handshake_ctx_.build_error_msg(io_buf_);
+        (void)state_->handshake_ctx.build_error_msg(io_buf_);
+
+        auto len = io_buf_.len;
         boost::asio::async_write(socket_,
                                  boost::asio::buffer(io_buf_.ptr,
                                                      io_buf_.len),
+                                 [this, len](const boost::system::error_code& ec, std::size_t bytes_so_far) -> std::size_t
+                                 {
+                                     if (ec || bytes_so_far >= len)
+                                         return 0;
+
+                                     ++io_stats_.write_calls;
+                                     return len - bytes_so_far;
+                                 },
                                  boost::asio::bind_executor(strand_,
-                                                            [this, func_pack(std::move(func_pack))](auto&&, auto&&)
+                                                            [this, func_pack(std::move(func_pack))](auto&&, auto&& bytes_transferred)
                                                             {
+                                                                io_stats_.bytes_written += bytes_transferred;
+
                                                                 std::get<2>(func_pack)(this->ec_);
                                                             }));
     }
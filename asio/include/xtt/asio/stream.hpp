@@ -0,0 +1,144 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#ifndef XTT_ASIO_STREAM_HPP
+#define XTT_ASIO_STREAM_HPP
+#pragma once
+
+#include <xtt.hpp>
+
+#include <xtt/asio/error_category.hpp>
+#include <xtt/asio/server_context.hpp>
+
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/executor.hpp>
+#include <boost/system/error_code.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace xtt {
+namespace asio {
+
+    /*
+     * An authenticated, encrypted byte stream over `Stream`,
+     *  for application data once a handshake has finished.
+     *
+     * Meets the AsyncReadStream and AsyncWriteStream requirements.
+     *
+     * On the wire, each direction starts with a `salt_length`-byte random salt,
+     *  chosen by the sender for this stream and mixed into that direction's keys
+     *  (see `record_cipher::mix_salt`), so keys reused across connections
+     *  never repeat a nonce.
+     * After that, each record is a 2-byte big-endian payload length,
+     *  the encrypted payload, and the AEAD tag.
+     * The length is authenticated as additional data.
+     *
+     * Each `async_write_some` gathers as much of its buffers as fits
+     *  into a single record (so many small buffers cost one AEAD call
+     *  and one write), encrypts it in place and writes it.
+     * Reads pull as many bytes as are available, so several small records
+     *  can arrive in one read, and are decrypted in place.
+     * Both directions use a buffer allocated once, at construction.
+     *
+     * As with sockets, at most one read and one write may be outstanding at a time.
+     * Handlers are invoked via their associated executor, defaulting to this stream's.
+     */
+    template <typename Stream>
+    class stream {
+    public:
+        using next_layer_type = Stream;
+        using lowest_layer_type = typename detail::lowest_layer_of<Stream>::type;
+        using executor_type = boost::asio::executor;
+
+        static constexpr std::size_t salt_length = 32;
+        static constexpr std::size_t header_length = 2;
+        static constexpr std::size_t max_record_payload = 16384;
+        static constexpr std::size_t max_record_length = header_length + max_record_payload + record_cipher::tag_length;
+
+        /*
+         * `tx_cipher` protects records sent to the peer,
+         *  and `rx_cipher` records received from it.
+         *
+         * The peer must use the same keys, swapped.
+         *
+         * Throws `std::invalid_argument` if the two ciphers share a key,
+         *  since the two directions would then share a nonce space.
+         */
+        stream(Stream next_layer,
+               record_cipher tx_cipher,
+               record_cipher rx_cipher);
+
+        stream(const stream&) = delete;
+        stream& operator=(const stream&) = delete;
+
+        executor_type get_executor();
+
+        const next_layer_type& next_layer() const;
+        next_layer_type& next_layer();
+
+        const lowest_layer_type& lowest_layer() const;
+        lowest_layer_type& lowest_layer();
+
+        /*
+         * Fails with `return_code::RECORD_FAILED_CRYPTO` if a record fails authentication,
+         *  or `return_code::INCORRECT_LENGTH` if its length is invalid.
+         * The stream is unusable after either error.
+         */
+        template <typename MutableBufferSequence, typename ReadHandler>
+        auto async_read_some(const MutableBufferSequence& buffers, ReadHandler&& handler);
+
+        template <typename ConstBufferSequence, typename WriteHandler>
+        auto async_write_some(const ConstBufferSequence& buffers, WriteHandler&& handler);
+
+    private:
+        template <typename MutableBufferSequence, typename Handler>
+        void continue_read(const MutableBufferSequence& buffers, Handler handler);
+
+        template <typename Handler>
+        static void complete(Handler handler,
+                             const executor_type& executor,
+                             const boost::system::error_code& ec,
+                             std::size_t bytes_transferred);
+
+        Stream next_layer_;
+
+        record_cipher tx_cipher_;
+        record_cipher rx_cipher_;
+
+        // The salt, then room for a record; the salt is only sent before the first one
+        std::vector<unsigned char> tx_buffer_;
+        bool tx_salt_sent_;
+        bool rx_salt_received_;
+
+        // Raw bytes received but not yet consumed are [rx_begin_, rx_end_).
+        // Once the record at rx_begin_ is opened, its plaintext is [plain_begin_, plain_end_).
+        std::vector<unsigned char> rx_buffer_;
+        std::size_t rx_begin_;
+        std::size_t rx_end_;
+        std::size_t plain_begin_;
+        std::size_t plain_end_;
+    };
+
+}   // namespace asio
+}   // namespace xtt
+
+#include "stream.inl"
+
+#endif
@@ -0,0 +1,273 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/associated_executor.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/write.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace xtt {
+namespace asio {
+
+    template <typename Stream>
+    constexpr std::size_t stream<Stream>::salt_length;
+
+    template <typename Stream>
+    constexpr std::size_t stream<Stream>::header_length;
+
+    template <typename Stream>
+    constexpr std::size_t stream<Stream>::max_record_payload;
+
+    template <typename Stream>
+    constexpr std::size_t stream<Stream>::max_record_length;
+
+    template <typename Stream>
+    stream<Stream>::stream(Stream next_layer,
+                           record_cipher tx_cipher,
+                           record_cipher rx_cipher)
+        : next_layer_(std::move(next_layer)),
+          tx_cipher_(std::move(tx_cipher)),
+          rx_cipher_(std::move(rx_cipher)),
+          tx_buffer_(salt_length + max_record_length),
+          tx_salt_sent_(false),
+          rx_salt_received_(false),
+          rx_buffer_(salt_length + 2 * max_record_length),
+          rx_begin_(0),
+          rx_end_(0),
+          plain_begin_(0),
+          plain_end_(0)
+    {
+        if (tx_cipher_.shares_key_with(rx_cipher_))
+            throw std::invalid_argument("xtt::asio::stream needs a different key for each direction");
+
+        xtt_crypto_get_random(tx_buffer_.data(), salt_length);
+        tx_cipher_.mix_salt(tx_buffer_.data(), salt_length);
+    }
+
+    template <typename Stream>
+    typename stream<Stream>::executor_type
+    stream<Stream>::get_executor()
+    {
+        return next_layer_.get_executor();
+    }
+
+    template <typename Stream>
+    const typename stream<Stream>::next_layer_type&
+    stream<Stream>::next_layer() const
+    {
+        return next_layer_;
+    }
+
+    template <typename Stream>
+    typename stream<Stream>::next_layer_type&
+    stream<Stream>::next_layer()
+    {
+        return next_layer_;
+    }
+
+    template <typename Stream>
+    const typename stream<Stream>::lowest_layer_type&
+    stream<Stream>::lowest_layer() const
+    {
+        return detail::lowest_layer_of<Stream>::get(next_layer_);
+    }
+
+    template <typename Stream>
+    typename stream<Stream>::lowest_layer_type&
+    stream<Stream>::lowest_layer()
+    {
+        return detail::lowest_layer_of<Stream>::get(next_layer_);
+    }
+
+    template <typename Stream>
+    template <typename Handler>
+    void stream<Stream>::complete(Handler handler,
+                                  const executor_type& executor,
+                                  const boost::system::error_code& ec,
+                                  std::size_t bytes_transferred)
+    {
+        auto handler_executor = boost::asio::get_associated_executor(handler, executor);
+        boost::asio::dispatch(handler_executor,
+                              [handler(std::move(handler)), ec, bytes_transferred]() mutable
+                              {
+                                  handler(ec, bytes_transferred);
+                              });
+    }
+
+    template <typename Stream>
+    template <typename MutableBufferSequence, typename ReadHandler>
+    auto stream<Stream>::async_read_some(const MutableBufferSequence& buffers, ReadHandler&& handler)
+    {
+        auto initiation = [this](auto&& handler, const MutableBufferSequence& buffers)
+                          {
+                              using handler_type = std::decay_t<decltype(handler)>;
+
+                              // Never complete from within the initiating function
+                              boost::asio::post(get_executor(),
+                                                [this, buffers, handler(handler_type(std::move(handler)))]() mutable
+                                                {
+                                                    if (0 == boost::asio::buffer_size(buffers)) {
+                                                        complete(std::move(handler), get_executor(), boost::system::error_code(), 0);
+                                                        return;
+                                                    }
+
+                                                    continue_read(buffers, std::move(handler));
+                                                });
+                          };
+
+        return boost::asio::async_initiate<ReadHandler, void(boost::system::error_code, std::size_t)>(
+                    initiation, handler, buffers);
+    }
+
+    template <typename Stream>
+    template <typename MutableBufferSequence, typename Handler>
+    void stream<Stream>::continue_read(const MutableBufferSequence& buffers, Handler handler)
+    {
+        // 1) Hand out plaintext from an already-opened record
+        if (plain_begin_ != plain_end_) {
+            std::size_t bytes_copied = boost::asio::buffer_copy(buffers,
+                                                                boost::asio::buffer(rx_buffer_.data() + plain_begin_,
+                                                                                    plain_end_ - plain_begin_));
+            plain_begin_ += bytes_copied;
+            if (plain_begin_ == plain_end_)
+                rx_begin_ = plain_end_ + record_cipher::tag_length;
+
+            complete(std::move(handler), get_executor(), boost::system::error_code(), bytes_copied);
+            return;
+        }
+
+        // 2) Take the peer's salt, which comes before its first record
+        std::size_t available = rx_end_ - rx_begin_;
+        if (!rx_salt_received_ && available >= salt_length) {
+            rx_cipher_.mix_salt(rx_buffer_.data() + rx_begin_, salt_length);
+            rx_salt_received_ = true;
+            rx_begin_ += salt_length;
+            available -= salt_length;
+        }
+
+        // 3) Open the next record, if all of it has arrived
+        if (rx_salt_received_ && available >= header_length) {
+            unsigned char *header = rx_buffer_.data() + rx_begin_;
+            std::size_t payload_length = (static_cast<std::size_t>(header[0]) << 8) | header[1];
+            if (0 == payload_length || payload_length > max_record_payload) {
+                complete(std::move(handler), get_executor(), get_incorrect_length_ec(), 0);
+                return;
+            }
+
+            if (available >= header_length + payload_length + record_cipher::tag_length) {
+                unsigned char *payload = header + header_length;
+                if (!rx_cipher_.open(payload, payload_length,
+                                     header, header_length,
+                                     payload + payload_length)) {
+                    complete(std::move(handler), get_executor(), get_record_failed_crypto_ec(), 0);
+                    return;
+                }
+
+                plain_begin_ = rx_begin_ + header_length;
+                plain_end_ = plain_begin_ + payload_length;
+
+                continue_read(buffers, std::move(handler));
+                return;
+            }
+        }
+
+        // 4) Otherwise, read more (keeping any partial record at the front of the buffer)
+        if (0 != rx_begin_) {
+            std::memmove(rx_buffer_.data(), rx_buffer_.data() + rx_begin_, available);
+            rx_begin_ = 0;
+            rx_end_ = available;
+        }
+
+        next_layer_.async_read_some(boost::asio::buffer(rx_buffer_.data() + rx_end_,
+                                                        rx_buffer_.size() - rx_end_),
+                                    [this, buffers, handler(std::move(handler))](const boost::system::error_code& ec,
+                                                                                 std::size_t bytes_transferred) mutable
+                                    {
+                                        if (ec) {
+                                            complete(std::move(handler), get_executor(), ec, 0);
+                                            return;
+                                        }
+
+                                        rx_end_ += bytes_transferred;
+
+                                        continue_read(buffers, std::move(handler));
+                                    });
+    }
+
+    template <typename Stream>
+    template <typename ConstBufferSequence, typename WriteHandler>
+    auto stream<Stream>::async_write_some(const ConstBufferSequence& buffers, WriteHandler&& handler)
+    {
+        auto initiation = [this](auto&& handler, const ConstBufferSequence& buffers)
+                          {
+                              using handler_type = std::decay_t<decltype(handler)>;
+
+                              // Gather as much as fits into one record, directly into the send buffer
+                              unsigned char *header = tx_buffer_.data() + salt_length;
+                              unsigned char *payload = header + header_length;
+                              std::size_t payload_length = boost::asio::buffer_copy(boost::asio::buffer(payload, max_record_payload),
+                                                                                    buffers);
+                              if (0 == payload_length) {
+                                  boost::asio::post(get_executor(),
+                                                    [this, handler(handler_type(std::move(handler)))]() mutable
+                                                    {
+                                                        complete(std::move(handler), get_executor(), boost::system::error_code(), 0);
+                                                    });
+                                  return;
+                              }
+
+                              header[0] = static_cast<unsigned char>(payload_length >> 8);
+                              header[1] = static_cast<unsigned char>(payload_length);
+
+                              if (!tx_cipher_.seal(payload, payload_length,
+                                                   header, header_length,
+                                                   payload + payload_length)) {
+                                  boost::asio::post(get_executor(),
+                                                    [this, handler(handler_type(std::move(handler)))]() mutable
+                                                    {
+                                                        complete(std::move(handler), get_executor(), get_record_failed_crypto_ec(), 0);
+                                                    });
+                                  return;
+                              }
+
+                              std::size_t salt_prefix = tx_salt_sent_ ? 0 : salt_length;
+                              tx_salt_sent_ = true;
+
+                              boost::asio::async_write(next_layer_,
+                                                       boost::asio::buffer(header - salt_prefix,
+                                                                           salt_prefix + header_length + payload_length + record_cipher::tag_length),
+                                                       [this, payload_length, handler(handler_type(std::move(handler)))]
+                                                       (const boost::system::error_code& ec, std::size_t) mutable
+                                                       {
+                                                           complete(std::move(handler),
+                                                                    get_executor(),
+                                                                    ec,
+                                                                    ec ? 0 : payload_length);
+                                                       });
+                          };
+
+        return boost::asio::async_initiate<WriteHandler, void(boost::system::error_code, std::size_t)>(
+                    initiation, handler, buffers);
+    }
+
+}   // namespace asio
+}   // namespace xtt
@@ -0,0 +1,323 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#ifndef XTT_ASIO_UDPSERVER_HPP
+#define XTT_ASIO_UDPSERVER_HPP
+#pragma once
+
+#include <xtt/asio/server_context.hpp>
+#include <xtt/asio/memory_stream.hpp>
+
+#include <xtt.hpp>
+
+#include <boost/asio/ip/udp.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/system/error_code.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+namespace xtt {
+namespace asio {
+
+    /*
+     * Header at the start of every datagram of a handshake over UDP
+     *  (integers are big-endian):
+     *
+     *      handshake_id (4) | message_index (1) | message_length (2) | fragment_offset (2)
+     *
+     * `handshake_id` is chosen by the client for each handshake, and echoed by the server.
+     * `message_index` counts each side's messages from 0:
+     *  ClientInit and IdClientAttest from the client,
+     *  and the server's reply to each (ServerAttest, then IdServerFinished or an error).
+     * The rest of the datagram holds bytes `fragment_offset` onwards
+     *  of that message (`message_length` bytes in all),
+     *  so a message may be split over several datagrams, arriving in any order.
+     */
+    struct udp_fragment_header {
+        static constexpr std::size_t length = 9;
+
+        std::uint32_t handshake_id;
+        std::uint8_t message_index;
+        std::uint16_t message_length;
+        std::uint16_t fragment_offset;
+
+        /*
+         * Returns an empty optional if the datagram is too short to hold a header.
+         */
+        static
+        OPTIONAL_NS::optional<udp_fragment_header>
+        parse(const unsigned char *datagram, std::size_t datagram_length);
+
+        void serialize(unsigned char *out) const;
+    };
+
+    /*
+     * Serves XTT handshakes over a single UDP socket.
+     *
+     * Each client endpoint gets a session, which reassembles the client's messages
+     *  from their fragments (see `udp_fragment_header`) and runs the usual
+     *  `basic_server_context` state machine over an in-process stream.
+     *  Each message the server writes is sent back as one datagram.
+     *
+     * The client drives retransmission.
+     * A fragment of a message that has already been reassembled
+     *  is answered by re-sending the server's reply to it (once there is one)
+     *  rather than being fed to the handshake again.
+     * Finished sessions linger for `session_timeout` so that a lost
+     *  IdServerFinished can still be re-sent.
+     * A ClientInit with a new `handshake_id` replaces its endpoint's session
+     *  only once that session has finished.
+     *  Otherwise it is ignored, so a spoofed ClientInit can't abort the handshake in progress,
+     *  and a client that restarts its handshake must wait for the old one to time out.
+     *
+     * libxtt keeps the handshake state from ClientInit onwards
+     *  (the cookie in IdClientAttest is checked against it),
+     *  so a session is allocated for each ClientInit,
+     *  before the client has shown it can receive at its address.
+     * A session is verified once the client's IdClientAttest passes the cookie check.
+     * To bound the cost of a spoofed flood:
+     *  - with `max_sessions` sessions held, a new client evicts the oldest unverified session
+     *    if that has been waiting for its IdClientAttest for longer than a grace period
+     *    (see `set_unverified_grace_period`), and is ignored otherwise,
+     *  - ServerAttests are rate-limited per source address (see `set_attest_rate_limit`),
+     *    bounding the traffic reflected at any one address,
+     *  - and in total (see `set_total_attest_rate_limit`), bounding the signatures computed
+     *    and the sessions started however many addresses a flood comes from,
+     *  - and sessions with no traffic for `session_timeout` are dropped.
+     */
+    class udp_server {
+    public:
+        using executor_type = boost::asio::executor;
+
+        udp_server(boost::asio::ip::udp::socket socket,
+                   server_cookie_context& cookie_ctx,
+                   std::size_t max_sessions = 1024,
+                   std::chrono::steady_clock::duration session_timeout = std::chrono::seconds(10));
+
+        void load_certificate(const std::vector<unsigned char>& certificate,
+                              const std::vector<unsigned char>& private_key,
+                              boost::system::error_code& ec);
+
+        /*
+         * See `basic_server_context::set_suite_policy`.
+         */
+        void set_suite_policy(std::shared_ptr<const suite_policy> policy);
+
+        /*
+         * See `basic_server_context::set_group_filter`.
+         */
+        void set_group_filter(std::shared_ptr<const group_identity_filter> filter);
+
+        /*
+         * See `basic_server_context::set_revocation_list`.
+         */
+        void set_revocation_list(std::shared_ptr<const pseudonym_revocation_list> revoked);
+
+        /*
+         * Send each source address at most `per_second` ServerAttests
+         *  (new and re-sent) on average, in bursts of at most `burst`.
+         *  ClientInits over the limit are ignored.
+         *
+         * Addresses are hashed (with a random key) into a fixed table of limits,
+         *  so a flood from many addresses takes no extra memory,
+         *  and addresses that collide share a limit.
+         *
+         * Defaults to 10 per second, in bursts of at most 20.
+         * Must be set before `async_serve`.
+         */
+        void set_attest_rate_limit(double per_second, std::size_t burst);
+
+        /*
+         * Send at most `per_second` ServerAttests (new and re-sent) in total,
+         *  on average, in bursts of at most `burst`.
+         *  ClientInits over the limit are ignored.
+         *
+         * Defaults to 1000 per second, in bursts of at most 1000.
+         * Must be set before `async_serve`.
+         */
+        void set_total_attest_rate_limit(double per_second, std::size_t burst);
+
+        /*
+         * How long a session waiting for the client's IdClientAttest
+         *  is safe from being evicted to make room for a new client
+         *  (while `max_sessions` sessions are held).
+         *
+         * Should comfortably exceed the round trip time of legitimate clients.
+         * Defaults to 1 second.
+         * Must be set before `async_serve`.
+         */
+        void set_unverified_grace_period(std::chrono::steady_clock::duration grace_period);
+
+        /*
+         * Start receiving datagrams and serving handshakes,
+         *  until `close` is called.
+         *
+         * `async_lookup_gpk` and `async_assign_id` are as for
+         *  `basic_server_context::async_handle_connect`,
+         *  and are copied into every session.
+         *
+         * `handler` is called once per session, and must have the signature:
+         *      void handler(const boost::system::error_code& ec,
+         *                   const boost::asio::ip::udp::endpoint& client,
+         *                   const OPTIONAL_NS::optional<handshake_result>& result);
+         */
+        template <typename GPKLookupCallback,
+                  typename AssignIdCallback,
+                  typename Handler>
+        void async_serve(GPKLookupCallback async_lookup_gpk,
+                         AssignIdCallback async_assign_id,
+                         Handler handler);
+
+        /*
+         * Stop receiving and abort all sessions still in progress
+         *  (their handlers are called with an error).
+         *
+         * Let the executor run until those handlers have been called
+         *  before destroying the udp_server.
+         */
+        void close();
+
+        /*
+         * Number of sessions currently held (including lingering ones).
+         * Not synchronized: only call from the thread running the executor.
+         */
+        std::size_t session_count() const;
+
+        const boost::asio::ip::udp::socket& socket() const;
+        boost::asio::ip::udp::socket& socket();
+
+    private:
+        struct session {
+            session(const boost::asio::ip::udp::endpoint& client,
+                    std::uint32_t handshake_id,
+                    std::pair<memory_stream, memory_stream> ends,
+                    server_cookie_context& cookie_ctx);
+
+            boost::asio::ip::udp::endpoint client;
+            std::uint32_t handshake_id;
+
+            // Our end of the in-process stream; the other end is xtt_context's.
+            memory_stream datagram_side;
+            basic_server_context<memory_stream> xtt_context;
+
+            boost::asio::steady_timer timer;
+            std::chrono::steady_clock::time_point started;
+
+            // The client message being reassembled, and which of its bytes have arrived
+            std::uint8_t next_index;
+            std::vector<unsigned char> reassembly;
+            std::vector<bool> received;
+            std::size_t received_count;
+
+            // The datagram replying to each client message, by message_index
+            std::vector<std::vector<unsigned char>> replies;
+            std::array<unsigned char, MAX_HANDSHAKE_SERVER_MESSAGE_LENGTH> out_buffer;
+
+            bool verified;
+            // Position in unverified_, until verified
+            std::list<std::shared_ptr<session>>::iterator unverified_position;
+
+            bool finished;
+        };
+
+        using session_map = std::map<boost::asio::ip::udp::endpoint, std::shared_ptr<session>>;
+
+        struct attest_bucket {
+            double tokens;
+            std::chrono::steady_clock::time_point updated;
+        };
+
+        template <typename Callbacks>
+        void async_receive(std::shared_ptr<Callbacks> callbacks);
+
+        template <typename Callbacks>
+        void handle_datagram(std::size_t length,
+                             const std::shared_ptr<Callbacks>& callbacks);
+
+        template <typename Callbacks>
+        std::shared_ptr<session> start_session(std::uint32_t handshake_id,
+                                               const std::shared_ptr<Callbacks>& callbacks);
+
+        void add_fragment(const std::shared_ptr<session>& s,
+                          const udp_fragment_header& header,
+                          const unsigned char *fragment,
+                          std::size_t fragment_length);
+
+        void resend(const std::shared_ptr<session>& s, std::uint8_t message_index);
+
+        bool take_attest_token(const boost::asio::ip::address& address);
+
+        static bool take_token(attest_bucket& bucket, double per_second, double burst);
+
+        void mark_verified(const std::shared_ptr<session>& s);
+
+        void async_pump_replies(std::shared_ptr<session> s);
+
+        void send(const std::shared_ptr<session>& s, std::size_t reply_index);
+
+        void arm_timer(const std::shared_ptr<session>& s);
+
+        void erase_session(const std::shared_ptr<session>& s);
+
+    private:
+        boost::asio::ip::udp::socket socket_;
+        boost::asio::strand<executor_type> strand_;
+
+        server_cookie_context& cookie_ctx_;
+        shared_server_certificate_map certificates_;
+        std::shared_ptr<const suite_policy> suite_policy_;
+        std::shared_ptr<const group_identity_filter> group_filter_;
+        std::shared_ptr<const pseudonym_revocation_list> revocation_list_;
+
+        std::size_t max_sessions_;
+        std::chrono::steady_clock::duration session_timeout_;
+
+        double attest_rate_;
+        double attest_burst_;
+        std::vector<attest_bucket> attest_buckets_;
+        std::array<unsigned char, 16> attest_hash_key_;
+
+        double total_attest_rate_;
+        double total_attest_burst_;
+        attest_bucket total_attest_bucket_;
+
+        std::chrono::steady_clock::duration unverified_grace_period_;
+
+        std::array<unsigned char, udp_fragment_header::length + MAX_HANDSHAKE_CLIENT_MESSAGE_LENGTH> in_buffer_;
+        boost::asio::ip::udp::endpoint sender_;
+
+        session_map sessions_;
+        // Sessions not yet verified, oldest first
+        std::list<std::shared_ptr<session>> unverified_;
+        bool closed_;
+    };
+
+}   // namespace asio
+}   // namespace xtt
+
+#include "udp_server.inl"
+
+#endif
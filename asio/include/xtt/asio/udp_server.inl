@@ -0,0 +1,184 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include <boost/asio/bind_executor.hpp>
+#include <boost/asio/post.hpp>
+
+#include <utility>
+
+namespace xtt {
+namespace asio {
+
+    template <typename GPKLookupCallback,
+              typename AssignIdCallback,
+              typename Handler>
+    void udp_server::async_serve(GPKLookupCallback async_lookup_gpk,
+                                 AssignIdCallback async_assign_id,
+                                 Handler handler)
+    {
+        auto callbacks = std::make_shared<std::tuple<GPKLookupCallback, AssignIdCallback, Handler>>(std::move(async_lookup_gpk),
+                                                                                                    std::move(async_assign_id),
+                                                                                                    std::move(handler));
+
+        boost::asio::post(strand_,
+                          [this, callbacks(std::move(callbacks))]()
+                          {
+                              this->async_receive(std::move(callbacks));
+                          });
+    }
+
+    template <typename Callbacks>
+    void udp_server::async_receive(std::shared_ptr<Callbacks> callbacks)
+    {
+        if (closed_)
+            return;
+
+        socket_.async_receive_from(boost::asio::buffer(in_buffer_),
+                                   sender_,
+                                   boost::asio::bind_executor(strand_,
+                                                              [this, callbacks(std::move(callbacks))]
+                                                              (const boost::system::error_code& ec, std::size_t length)
+                                                              {
+                                                                  if (ec == boost::asio::error::operation_aborted || closed_)
+                                                                      return;
+
+                                                                  // Errors on a UDP socket (e.g. ICMP port unreachable)
+                                                                  // concern a single peer, so keep serving.
+                                                                  if (!ec)
+                                                                      this->handle_datagram(length, callbacks);
+
+                                                                  this->async_receive(std::move(callbacks));
+                                                              }));
+    }
+
+    template <typename Callbacks>
+    void udp_server::handle_datagram(std::size_t length,
+                                     const std::shared_ptr<Callbacks>& callbacks)
+    {
+        auto header = udp_fragment_header::parse(in_buffer_.data(), length);
+        if (!header)
+            return;
+
+        const unsigned char *fragment = in_buffer_.data() + udp_fragment_header::length;
+        std::size_t fragment_length = length - udp_fragment_header::length;
+
+        std::shared_ptr<session> s;
+        auto it = sessions_.find(sender_);
+        if (sessions_.end() != it) {
+            s = it->second;
+
+            if (header->handshake_id == s->handshake_id) {
+                if (header->message_index < s->next_index) {
+                    // Retransmission: our reply was lost (or isn't ready yet)
+                    resend(s, header->message_index);
+                    return;
+                }
+
+                add_fragment(s, *header, fragment, fragment_length);
+                return;
+            }
+
+            // Only a ClientInit starts a new handshake,
+            // and one in progress isn't given up for it (the ClientInit may be spoofed).
+            if (0 != header->message_index || !s->finished)
+                return;
+        } else if (0 != header->message_index) {
+            return;
+        }
+
+        // Make room by evicting an unverified session only once it's had time to verify,
+        // so a flood of ClientInits can't push out clients in the middle of a handshake.
+        std::shared_ptr<session> evicted;
+        if (!s && sessions_.size() >= max_sessions_) {
+            if (unverified_.empty() ||
+                std::chrono::steady_clock::now() - unverified_.front()->started < unverified_grace_period_)
+                return;
+
+            evicted = unverified_.front();
+        }
+
+        if (!take_attest_token(sender_.address()))
+            return;
+
+        if (s)
+            erase_session(s);
+        if (evicted)
+            erase_session(evicted);
+
+        s = start_session(header->handshake_id, callbacks);
+        add_fragment(s, *header, fragment, fragment_length);
+    }
+
+    template <typename Callbacks>
+    std::shared_ptr<udp_server::session>
+    udp_server::start_session(std::uint32_t handshake_id,
+                              const std::shared_ptr<Callbacks>& callbacks)
+    {
+        auto s = std::make_shared<session>(sender_,
+                                           handshake_id,
+                                           memory_stream::make_pair(socket_.get_executor()),
+                                           cookie_ctx_);
+
+        s->xtt_context.load_certificate(certificates_);
+        s->xtt_context.set_suite_policy(suite_policy_);
+        s->xtt_context.set_group_filter(group_filter_);
+        s->xtt_context.set_revocation_list(revocation_list_);
+
+        sessions_.emplace(s->client, s);
+        s->unverified_position = unverified_.insert(unverified_.end(), s);
+
+        // The GPK is only looked up once IdClientAttest has passed the cookie check
+        auto lookup_gpk = [this, s, callbacks](auto&& claimed_gid, auto&& requested_id, auto&& continuation)
+                          {
+                              boost::asio::post(strand_,
+                                                [this, s]()
+                                                {
+                                                    this->mark_verified(s);
+                                                });
+
+                              std::get<0>(*callbacks)(std::forward<decltype(claimed_gid)>(claimed_gid),
+                                                      std::forward<decltype(requested_id)>(requested_id),
+                                                      std::forward<decltype(continuation)>(continuation));
+                          };
+
+        s->xtt_context.async_handle_connect(std::move(lookup_gpk),
+                                            std::get<1>(*callbacks),
+                                            [this, s, callbacks](const boost::system::error_code& ec)
+                                            {
+                                                boost::asio::post(strand_,
+                                                                  [this, s, callbacks, ec]()
+                                                                  {
+                                                                      s->finished = true;
+
+                                                                      std::get<2>(*callbacks)(ec,
+                                                                                              s->client,
+                                                                                              s->xtt_context.get_handshake_result());
+
+                                                                      // Successful sessions linger, to answer retransmissions
+                                                                      if (ec)
+                                                                          this->erase_session(s);
+                                                                  });
+                                            });
+
+        async_pump_replies(s);
+
+        return s;
+    }
+
+}   // namespace asio
+}   // namespace xtt
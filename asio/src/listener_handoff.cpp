@@ -0,0 +1,135 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include <xtt/asio/listener_handoff.hpp>
+
+#include <boost/asio/error.hpp>
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+using namespace xtt;
+using namespace asio;
+
+namespace {
+
+    constexpr std::size_t control_length = CMSG_SPACE(sizeof(int) * max_handed_off_listeners);
+
+    boost::system::error_code last_error()
+    {
+        return boost::system::error_code(errno, boost::system::system_category());
+    }
+
+}
+
+void xtt::asio::send_listeners(boost::asio::local::stream_protocol::socket& socket,
+                               const std::vector<int>& listeners,
+                               boost::system::error_code& ec)
+{
+    if (listeners.empty() || listeners.size() > max_handed_off_listeners) {
+        ec = boost::asio::error::invalid_argument;
+        return;
+    }
+
+    // The payload is the number of handles, so the receiver can check none were dropped
+    unsigned char count = static_cast<unsigned char>(listeners.size());
+    struct iovec iov = {&count, sizeof(count)};
+
+    alignas(struct cmsghdr) unsigned char control[control_length] = {};
+    struct msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = CMSG_SPACE(sizeof(int) * listeners.size());
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * listeners.size());
+    std::memcpy(CMSG_DATA(cmsg), listeners.data(), sizeof(int) * listeners.size());
+
+    ssize_t sent;
+    do {
+        sent = ::sendmsg(socket.native_handle(), &msg, MSG_NOSIGNAL);
+    } while (sent < 0 && EINTR == errno);
+
+    if (sent < 0) {
+        ec = last_error();
+        return;
+    }
+
+    ec = boost::system::error_code();
+}
+
+std::vector<int> xtt::asio::receive_listeners(boost::asio::local::stream_protocol::socket& socket,
+                                              boost::system::error_code& ec)
+{
+    unsigned char count = 0;
+    struct iovec iov = {&count, sizeof(count)};
+
+    alignas(struct cmsghdr) unsigned char control[control_length] = {};
+    struct msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    ssize_t received;
+    do {
+        received = ::recvmsg(socket.native_handle(), &msg, MSG_CMSG_CLOEXEC);
+    } while (received < 0 && EINTR == errno);
+
+    if (received < 0) {
+        ec = last_error();
+        return {};
+    }
+    if (0 == received) {
+        ec = boost::asio::error::eof;
+        return {};
+    }
+
+    std::vector<int> listeners;
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (SOL_SOCKET != cmsg->cmsg_level || SCM_RIGHTS != cmsg->cmsg_type)
+            continue;
+
+        std::size_t n = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        const unsigned char *data = CMSG_DATA(cmsg);
+        for (std::size_t i = 0; i < n; ++i) {
+            int fd;
+            std::memcpy(&fd, data + i * sizeof(int), sizeof(int));
+            listeners.push_back(fd);
+        }
+    }
+
+    if ((msg.msg_flags & MSG_CTRUNC) || listeners.size() != count) {
+        for (int fd : listeners)
+            ::close(fd);
+
+        ec = boost::asio::error::message_size;
+        return {};
+    }
+
+    ec = boost::system::error_code();
+
+    return listeners;
+}
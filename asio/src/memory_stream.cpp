@@ -0,0 +1,115 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include <xtt/asio/memory_stream.hpp>
+
+#include <algorithm>
+
+using namespace xtt;
+using namespace asio;
+
+std::pair<memory_stream, memory_stream>
+memory_stream::make_pair(const executor_type& executor)
+{
+    auto a_to_b = std::make_shared<channel>();
+    auto b_to_a = std::make_shared<channel>();
+
+    return std::pair<memory_stream, memory_stream>(memory_stream(executor, b_to_a, a_to_b),
+                                                   memory_stream(executor, a_to_b, b_to_a));
+}
+
+memory_stream::memory_stream(const executor_type& executor,
+                             std::shared_ptr<channel> in,
+                             std::shared_ptr<channel> out)
+    : executor_(executor),
+      in_(std::move(in)),
+      out_(std::move(out))
+{
+}
+
+memory_stream::~memory_stream()
+{
+    close();
+}
+
+memory_stream& memory_stream::operator=(memory_stream&& other)
+{
+    if (this != &other) {
+        close();
+
+        executor_ = std::move(other.executor_);
+        in_ = std::move(other.in_);
+        out_ = std::move(other.out_);
+    }
+
+    return *this;
+}
+
+memory_stream::executor_type memory_stream::get_executor() const
+{
+    return executor_;
+}
+
+bool memory_stream::is_open() const
+{
+    if (!in_)
+        return false;
+
+    std::lock_guard<std::mutex> lock(in_->mutex);
+    return !in_->closed;
+}
+
+void memory_stream::close()
+{
+    // Moved-from
+    if (!in_ || !out_)
+        return;
+
+    // Our own pending read is aborted; the peer's sees end-of-stream.
+    close_channel(*in_, boost::asio::error::operation_aborted);
+    close_channel(*out_, boost::asio::error::eof);
+}
+
+void memory_stream::close(boost::system::error_code& ec)
+{
+    close();
+
+    ec = boost::system::error_code();
+}
+
+void memory_stream::close_channel(channel& chan, const boost::system::error_code& ec)
+{
+    std::lock_guard<std::mutex> lock(chan.mutex);
+    chan.closed = true;
+
+    if (chan.reader) {
+        std::unique_ptr<pending_read> reader = std::move(chan.reader);
+        reader->complete(chan.data, ec);
+    }
+}
+
+std::size_t memory_stream::consume(std::deque<unsigned char>& data,
+                                   unsigned char* dest,
+                                   std::size_t dest_length)
+{
+    std::size_t count = std::min(dest_length, data.size());
+    std::copy(data.begin(), data.begin() + count, dest);
+    data.erase(data.begin(), data.begin() + count);
+
+    return count;
+}
@@ -0,0 +1,117 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include <xtt/asio/server_configuration.hpp>
+
+#include <thread>
+#include <vector>
+
+using namespace xtt;
+using namespace asio;
+
+std::shared_ptr<const server_configuration>
+server_configuration::create(shared_server_certificate_map certificates,
+                             group_public_key_map gpks,
+                             std::shared_ptr<const suite_policy> policy)
+{
+    if (!certificates || certificates->empty())
+        return nullptr;
+
+    std::vector<group_identity> gids;
+    gids.reserve(gpks.size());
+    for (const auto& entry : gpks)
+        gids.push_back(entry.first);
+
+    std::shared_ptr<server_configuration> ret(new server_configuration());
+    ret->certificates_ = std::move(certificates);
+    ret->gpks_ = std::move(gpks);
+    ret->policy_ = policy ? std::move(policy) : std::make_shared<const suite_policy>();
+    ret->group_filter_ = std::make_shared<const group_identity_filter>(gids);
+
+    return ret;
+}
+
+std::shared_ptr<const group_public_key_context> server_configuration::find_gpk(const group_identity& gid) const
+{
+    auto it = gpks_.find(gid);
+    if (gpks_.end() == it)
+        return nullptr;
+
+    return it->second;
+}
+
+std::size_t server_configuration::group_count() const
+{
+    return gpks_.size();
+}
+
+server_configuration_store::server_configuration_store(std::shared_ptr<const server_configuration> initial)
+    : current_(new std::shared_ptr<const server_configuration>(std::move(initial))),
+      epoch_(0),
+      readers_{{0}, {0}},
+      publish_mutex_()
+{
+}
+
+server_configuration_store::~server_configuration_store()
+{
+    delete current_.load();
+}
+
+std::shared_ptr<const server_configuration> server_configuration_store::load() const
+{
+    unsigned slot = enter();
+    std::shared_ptr<const server_configuration> ret = *current_.load();
+    leave(slot);
+
+    return ret;
+}
+
+void server_configuration_store::publish(std::shared_ptr<const server_configuration> config)
+{
+    auto current = std::make_unique<const std::shared_ptr<const server_configuration>>(std::move(config));
+
+    std::lock_guard<std::mutex> lock(publish_mutex_);
+
+    std::unique_ptr<const std::shared_ptr<const server_configuration>> old(current_.exchange(current.release()));
+    wait_for_readers();
+}
+
+unsigned server_configuration_store::enter() const
+{
+    unsigned slot = epoch_.load() & 1;
+    readers_[slot].fetch_add(1);
+
+    return slot;
+}
+
+void server_configuration_store::leave(unsigned slot) const
+{
+    readers_[slot].fetch_sub(1);
+}
+
+void server_configuration_store::wait_for_readers()
+{
+    // A load counted in a slot after that slot was seen empty
+    //  loaded `current_` after the swap, so two flips cover every earlier load.
+    for (int i = 0; i < 2; ++i) {
+        unsigned slot = epoch_.fetch_add(1) & 1;
+        while (0 != readers_[slot].load())
+            std::this_thread::yield();
+    }
+}
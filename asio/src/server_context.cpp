@@ -18,67 +18,36 @@
 
 #include <xtt/asio/server_context.hpp>
 
+#include <type_traits>
+
 using namespace xtt;
 using namespace asio;
 
-server_context::server_context(boost::asio::ip::tcp::socket tcp_socket,
-                               server_cookie_context& cookie_ctx)
-    : in_buffer_(),
-      out_buffer_(),
-      io_buf_(),
-      handshake_ctx_(in_buffer_.data(), in_buffer_.size(), out_buffer_.data(), out_buffer_.size()),
-      socket_(std::move(tcp_socket)),
-      strand_(boost::asio::make_strand(socket_.lowest_layer().get_executor())),
-      cert_map_(),
-      cert_(cert_map_.end()),
-      cookie_ctx_(cookie_ctx)
-{
-}
-
-void server_context::load_certificate(const std::vector<unsigned char>& certificate,
-                                      const std::vector<unsigned char>& private_key,
-                                      boost::system::error_code& ec)
+shared_server_certificate_map
+xtt::asio::make_server_certificate_map(const std::vector<unsigned char>& certificate,
+                                       const std::vector<unsigned char>& private_key,
+                                       boost::system::error_code& ec)
 {
     // TODO: Figure out a way to determine type(ECDSAP256 vs. ...) from serialized values
 
-    auto cert = xtt::server_certificate_context_ecdsap256::from_certificate_and_key(certificate, private_key);
+    auto cert = server_certificate_context_ecdsap256::from_certificate_and_key(certificate, private_key);
     if (!cert) {
         ec = boost::system::error_code(static_cast<int>(return_code::BAD_CERTIFICATE),
-                                                        get_xtt_category());
-        return;
+                                       get_xtt_category());
+        return {};
     }
 
-    cert_map_[suite_spec::X25519_LRSW_ECDSAP256_CHACHA20POLY1305_SHA512] = cert->clone();
-    cert_map_[suite_spec::X25519_LRSW_ECDSAP256_CHACHA20POLY1305_BLAKE2B] = cert->clone();
-    cert_map_[suite_spec::X25519_LRSW_ECDSAP256_AES256GCM_SHA512] = cert->clone();
-    cert_map_[suite_spec::X25519_LRSW_ECDSAP256_AES256GCM_BLAKE2B] = cert->clone();
+    auto certificates = std::make_shared<server_certificate_map>();
+    for_each_suite([&certificates, &cert](auto traits)
+                   {
+                       using traits_type = decltype(traits);
+                       if (std::is_same<typename traits_type::signature, algorithm::ecdsap256>::value)
+                           (*certificates)[traits_type::value] = cert->clone();
+                   });
 
     ec = boost::system::error_code();
-}
 
-const boost::asio::ip::tcp::socket&
-server_context::lowest_layer() const
-{
-    return socket_;
-}
-
-boost::asio::ip::tcp::socket&
-server_context::lowest_layer()
-{
-    return socket_;
+    return certificates;
 }
 
-std::unique_ptr<pseudonym> server_context::get_clients_pseudonym() const
-{
-    return handshake_ctx_.get_clients_pseudonym();
-}
-
-std::unique_ptr<longterm_key> server_context::get_clients_longterm_key() const
-{
-    return handshake_ctx_.get_clients_longterm_key();
-}
-
-OPTIONAL_NS::optional<identity> server_context::get_clients_identity() const
-{
-    return handshake_ctx_.get_clients_identity();
-}
+template class xtt::asio::basic_server_context<boost::asio::ip::tcp::socket>;
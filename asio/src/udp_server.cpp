@@ -0,0 +1,375 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include <xtt/asio/udp_server.hpp>
+
+#include <boost/asio/write.hpp>
+
+#include <sodium.h>
+
+#include <algorithm>
+#include <cstring>
+
+using namespace xtt;
+using namespace asio;
+
+namespace {
+
+    const std::size_t attest_bucket_count = 4096;
+
+}
+
+constexpr std::size_t udp_fragment_header::length;
+
+OPTIONAL_NS::optional<udp_fragment_header>
+udp_fragment_header::parse(const unsigned char *datagram, std::size_t datagram_length)
+{
+    if (datagram_length < length)
+        return OPTIONAL_NS::nullopt;
+
+    udp_fragment_header ret;
+    ret.handshake_id = (std::uint32_t(datagram[0]) << 24)
+                       | (std::uint32_t(datagram[1]) << 16)
+                       | (std::uint32_t(datagram[2]) << 8)
+                       | std::uint32_t(datagram[3]);
+    ret.message_index = datagram[4];
+    ret.message_length = static_cast<std::uint16_t>((datagram[5] << 8) | datagram[6]);
+    ret.fragment_offset = static_cast<std::uint16_t>((datagram[7] << 8) | datagram[8]);
+
+    return ret;
+}
+
+void udp_fragment_header::serialize(unsigned char *out) const
+{
+    out[0] = static_cast<unsigned char>(handshake_id >> 24);
+    out[1] = static_cast<unsigned char>(handshake_id >> 16);
+    out[2] = static_cast<unsigned char>(handshake_id >> 8);
+    out[3] = static_cast<unsigned char>(handshake_id);
+    out[4] = message_index;
+    out[5] = static_cast<unsigned char>(message_length >> 8);
+    out[6] = static_cast<unsigned char>(message_length);
+    out[7] = static_cast<unsigned char>(fragment_offset >> 8);
+    out[8] = static_cast<unsigned char>(fragment_offset);
+}
+
+udp_server::session::session(const boost::asio::ip::udp::endpoint& client_in,
+                             std::uint32_t handshake_id_in,
+                             std::pair<memory_stream, memory_stream> ends,
+                             server_cookie_context& cookie_ctx)
+    : client(client_in),
+      handshake_id(handshake_id_in),
+      datagram_side(std::move(ends.first)),
+      xtt_context(std::move(ends.second), cookie_ctx),
+      timer(datagram_side.get_executor()),
+      started(std::chrono::steady_clock::now()),
+      next_index(0),
+      reassembly(),
+      received(),
+      received_count(0),
+      replies(),
+      out_buffer(),
+      verified(false),
+      unverified_position(),
+      finished(false)
+{
+}
+
+udp_server::udp_server(boost::asio::ip::udp::socket socket,
+                       server_cookie_context& cookie_ctx,
+                       std::size_t max_sessions,
+                       std::chrono::steady_clock::duration session_timeout)
+    : socket_(std::move(socket)),
+      strand_(boost::asio::make_strand(executor_type(socket_.get_executor()))),
+      cookie_ctx_(cookie_ctx),
+      certificates_(),
+      suite_policy_(),
+      group_filter_(),
+      revocation_list_(),
+      max_sessions_(max_sessions),
+      session_timeout_(session_timeout),
+      attest_rate_(10),
+      attest_burst_(20),
+      attest_buckets_(attest_bucket_count, attest_bucket{attest_burst_, std::chrono::steady_clock::now()}),
+      attest_hash_key_(),
+      total_attest_rate_(1000),
+      total_attest_burst_(1000),
+      total_attest_bucket_{total_attest_burst_, std::chrono::steady_clock::now()},
+      unverified_grace_period_(std::chrono::seconds(1)),
+      in_buffer_(),
+      sender_(),
+      sessions_(),
+      unverified_(),
+      closed_(false)
+{
+    static_assert(sizeof(attest_hash_key_) == crypto_shorthash_KEYBYTES,
+                  "attest_hash_key_ must be a SipHash key");
+    randombytes_buf(attest_hash_key_.data(), attest_hash_key_.size());
+}
+
+void udp_server::load_certificate(const std::vector<unsigned char>& certificate,
+                                  const std::vector<unsigned char>& private_key,
+                                  boost::system::error_code& ec)
+{
+    auto certificates = make_server_certificate_map(certificate, private_key, ec);
+    if (ec)
+        return;
+
+    certificates_ = std::move(certificates);
+}
+
+void udp_server::set_suite_policy(std::shared_ptr<const suite_policy> policy)
+{
+    suite_policy_ = std::move(policy);
+}
+
+void udp_server::set_group_filter(std::shared_ptr<const group_identity_filter> filter)
+{
+    group_filter_ = std::move(filter);
+}
+
+void udp_server::set_revocation_list(std::shared_ptr<const pseudonym_revocation_list> revoked)
+{
+    revocation_list_ = std::move(revoked);
+}
+
+void udp_server::set_attest_rate_limit(double per_second, std::size_t burst)
+{
+    attest_rate_ = per_second;
+    attest_burst_ = static_cast<double>(burst);
+
+    for (auto& bucket : attest_buckets_)
+        bucket.tokens = attest_burst_;
+}
+
+void udp_server::set_total_attest_rate_limit(double per_second, std::size_t burst)
+{
+    total_attest_rate_ = per_second;
+    total_attest_burst_ = static_cast<double>(burst);
+
+    total_attest_bucket_.tokens = total_attest_burst_;
+}
+
+void udp_server::set_unverified_grace_period(std::chrono::steady_clock::duration grace_period)
+{
+    unverified_grace_period_ = grace_period;
+}
+
+void udp_server::close()
+{
+    boost::asio::post(strand_,
+                      [this]()
+                      {
+                          closed_ = true;
+
+                          boost::system::error_code ignored;
+                          socket_.close(ignored);
+
+                          for (auto& entry : sessions_) {
+                              entry.second->timer.cancel();
+                              entry.second->datagram_side.close();
+                          }
+                          sessions_.clear();
+                          unverified_.clear();
+                      });
+}
+
+std::size_t udp_server::session_count() const
+{
+    return sessions_.size();
+}
+
+const boost::asio::ip::udp::socket& udp_server::socket() const
+{
+    return socket_;
+}
+
+boost::asio::ip::udp::socket& udp_server::socket()
+{
+    return socket_;
+}
+
+void udp_server::async_pump_replies(std::shared_ptr<session> s)
+{
+    s->datagram_side.async_read_some(boost::asio::buffer(s->out_buffer),
+                                     boost::asio::bind_executor(strand_,
+                                                                [this, s](const boost::system::error_code& ec, std::size_t length)
+                                                                {
+                                                                    if (ec)
+                                                                        return;
+
+                                                                    udp_fragment_header header;
+                                                                    header.handshake_id = s->handshake_id;
+                                                                    header.message_index = static_cast<std::uint8_t>(s->replies.size());
+                                                                    header.message_length = static_cast<std::uint16_t>(length);
+                                                                    header.fragment_offset = 0;
+
+                                                                    std::vector<unsigned char> datagram(udp_fragment_header::length + length);
+                                                                    header.serialize(datagram.data());
+                                                                    std::copy(s->out_buffer.begin(),
+                                                                              s->out_buffer.begin() + length,
+                                                                              datagram.begin() + udp_fragment_header::length);
+                                                                    s->replies.push_back(std::move(datagram));
+
+                                                                    if (!closed_)
+                                                                        this->send(s, s->replies.size() - 1);
+
+                                                                    this->async_pump_replies(s);
+                                                                }));
+}
+
+void udp_server::add_fragment(const std::shared_ptr<session>& s,
+                              const udp_fragment_header& header,
+                              const unsigned char *fragment,
+                              std::size_t fragment_length)
+{
+    // A fragment of a later message can't be placed until this one is complete,
+    // so it's dropped (and the client will re-send it).
+    if (header.message_index != s->next_index)
+        return;
+
+    if (0 == fragment_length
+            || 0 == header.message_length
+            || header.message_length > MAX_HANDSHAKE_CLIENT_MESSAGE_LENGTH
+            || header.fragment_offset + fragment_length > header.message_length)
+        return;
+
+    if (s->reassembly.empty()) {
+        s->reassembly.resize(header.message_length);
+        s->received.assign(header.message_length, false);
+        s->received_count = 0;
+    } else if (s->reassembly.size() != header.message_length) {
+        return;
+    }
+
+    std::copy(fragment, fragment + fragment_length, s->reassembly.begin() + header.fragment_offset);
+    for (std::size_t i = header.fragment_offset; i < header.fragment_offset + fragment_length; ++i) {
+        if (!s->received[i]) {
+            s->received[i] = true;
+            ++s->received_count;
+        }
+    }
+
+    arm_timer(s);
+
+    if (s->received_count < s->reassembly.size())
+        return;
+
+    // memory_stream copies the data before async_write_some returns,
+    // so the message need not outlive this call.
+    boost::asio::async_write(s->datagram_side,
+                             boost::asio::buffer(s->reassembly),
+                             [](const boost::system::error_code&, std::size_t) {});
+
+    s->reassembly.clear();
+    s->received.clear();
+    ++s->next_index;
+}
+
+void udp_server::resend(const std::shared_ptr<session>& s, std::uint8_t message_index)
+{
+    if (message_index >= s->replies.size())
+        return;
+
+    // A re-sent ServerAttest is reflected traffic like the first one
+    if (0 == message_index && !take_attest_token(s->client.address()))
+        return;
+
+    send(s, message_index);
+}
+
+bool udp_server::take_attest_token(const boost::asio::ip::address& address)
+{
+    unsigned char digest[crypto_shorthash_BYTES];
+    if (address.is_v4()) {
+        auto bytes = address.to_v4().to_bytes();
+        crypto_shorthash(digest, bytes.data(), bytes.size(), attest_hash_key_.data());
+    } else {
+        auto bytes = address.to_v6().to_bytes();
+        crypto_shorthash(digest, bytes.data(), bytes.size(), attest_hash_key_.data());
+    }
+
+    std::uint64_t hash;
+    std::memcpy(&hash, digest, sizeof(hash));
+    attest_bucket& bucket = attest_buckets_[hash % attest_buckets_.size()];
+
+    return take_token(bucket, attest_rate_, attest_burst_)
+        && take_token(total_attest_bucket_, total_attest_rate_, total_attest_burst_);
+}
+
+bool udp_server::take_token(attest_bucket& bucket, double per_second, double burst)
+{
+    auto now = std::chrono::steady_clock::now();
+    double elapsed_s = std::chrono::duration<double>(now - bucket.updated).count();
+    bucket.tokens = std::min(burst, bucket.tokens + elapsed_s * per_second);
+    bucket.updated = now;
+
+    if (bucket.tokens < 1)
+        return false;
+
+    bucket.tokens -= 1;
+    return true;
+}
+
+void udp_server::mark_verified(const std::shared_ptr<session>& s)
+{
+    auto it = sessions_.find(s->client);
+    if (sessions_.end() == it || it->second != s || s->verified)
+        return;
+
+    s->verified = true;
+    unverified_.erase(s->unverified_position);
+}
+
+void udp_server::send(const std::shared_ptr<session>& s, std::size_t reply_index)
+{
+    // The session (and so the reply) is kept alive until the send completes
+    socket_.async_send_to(boost::asio::buffer(s->replies[reply_index]),
+                          s->client,
+                          boost::asio::bind_executor(strand_,
+                                                     [s](const boost::system::error_code&, std::size_t)
+                                                     {
+                                                     }));
+}
+
+void udp_server::arm_timer(const std::shared_ptr<session>& s)
+{
+    s->timer.expires_after(session_timeout_);
+    s->timer.async_wait(boost::asio::bind_executor(strand_,
+                                                   [this, s](const boost::system::error_code& ec)
+                                                   {
+                                                       if (ec)
+                                                           return;     // re-armed or cancelled
+
+                                                       this->erase_session(s);
+                                                   }));
+}
+
+void udp_server::erase_session(const std::shared_ptr<session>& s)
+{
+    auto it = sessions_.find(s->client);
+    if (sessions_.end() != it && it->second == s) {
+        sessions_.erase(it);
+        if (!s->verified)
+            unverified_.erase(s->unverified_position);
+    }
+
+    s->timer.cancel();
+
+    // Ends the handshake (if still running) and the reply pump
+    s->datagram_side.close();
+}
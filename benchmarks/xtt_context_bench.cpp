@@ -0,0 +1,231 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+/*
+ * Measures the cost of bulk-loading server certificate and group public key contexts,
+ *  as when a server reads its configuration:
+ *  - through the factories, which run the C initializer once per context,
+ *  - by default-constructing and then initializing, which runs it twice,
+ *  - and of moving the loaded contexts.
+ *
+ * Results are written as JSON (to stdout, or to the file given as the only argument).
+ */
+
+#include <xtt.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    const std::size_t batch_size = 1024;
+    const std::chrono::milliseconds min_duration(200);
+
+    // Repeat `op` (which loads `batch_size` contexts) until `min_duration` has passed,
+    //  and return the time per context.
+    template <typename Op>
+    double measure(Op op)
+    {
+        using clock = std::chrono::steady_clock;
+
+        std::size_t iterations = 0;
+        auto start = clock::now();
+        auto elapsed = clock::duration::zero();
+        do {
+            op();
+            ++iterations;
+            elapsed = clock::now() - start;
+        } while (elapsed < min_duration);
+
+        return std::chrono::duration<double, std::nano>(elapsed).count() / (iterations * batch_size);
+    }
+
+    void write_measurement(std::ostream& out, const char *name, double ns_per_context, bool last = false)
+    {
+        out << "    \"" << name << "\": {\"ns_per_context\": " << ns_per_context << "}"
+            << (last ? "\n" : ",\n");
+    }
+
+    void bench_server_certificates(std::ostream& out)
+    {
+        std::vector<unsigned char> certificate(XTT_SERVER_CERTIFICATE_ECDSAP256_LENGTH, 0x42);
+        std::vector<unsigned char> private_key(sizeof(xtt_ecdsap256_priv_key), 0x17);
+        std::string certificate_as_text(2*certificate.size(), 'A');
+        std::string private_key_as_text(2*private_key.size(), 'B');
+
+        std::vector<std::unique_ptr<xtt::server_certificate_context>> loaded;
+        loaded.reserve(batch_size);
+
+        std::vector<xtt::server_certificate_context_ecdsap256_value> loaded_values;
+        loaded_values.reserve(batch_size);
+
+        out << "  \"server_certificate_context_ecdsap256\": {\n";
+
+        write_measurement(out, "default_then_initialize", measure([&]()
+            {
+                loaded.clear();
+                for (std::size_t i = 0; i < batch_size; ++i) {
+                    auto ctx = std::make_unique<xtt::server_certificate_context_ecdsap256>();
+                    xtt_initialize_server_certificate_context_ecdsap256(ctx->get(),
+                                                                        certificate.data(),
+                                                                        reinterpret_cast<const xtt_ecdsap256_priv_key*>(private_key.data()));
+                    loaded.push_back(std::move(ctx));
+                }
+            }));
+
+        write_measurement(out, "from_certificate_and_key", measure([&]()
+            {
+                loaded.clear();
+                for (std::size_t i = 0; i < batch_size; ++i)
+                    loaded.push_back(xtt::server_certificate_context_ecdsap256::from_certificate_and_key(certificate.data(), certificate.size(),
+                                                                                                          private_key.data(), private_key.size()));
+            }));
+
+        write_measurement(out, "from_certificate_and_key_text", measure([&]()
+            {
+                loaded.clear();
+                for (std::size_t i = 0; i < batch_size; ++i)
+                    loaded.push_back(xtt::server_certificate_context_ecdsap256::from_certificate_and_key(certificate_as_text,
+                                                                                                          private_key_as_text));
+            }));
+
+        write_measurement(out, "value_from_certificate_and_key", measure([&]()
+            {
+                loaded_values.clear();
+                for (std::size_t i = 0; i < batch_size; ++i)
+                    loaded_values.push_back(*xtt::server_certificate_context_ecdsap256_value::from_certificate_and_key(certificate.data(), certificate.size(),
+                                                                                                                        private_key.data(), private_key.size()));
+            }));
+
+        // Growing a vector moves every element already in it
+        std::vector<xtt::server_certificate_context_ecdsap256> contexts(batch_size);
+        write_measurement(out, "move", measure([&]()
+            {
+                std::vector<xtt::server_certificate_context_ecdsap256> moved;
+                moved.reserve(batch_size);
+                for (auto& ctx : contexts)
+                    moved.push_back(std::move(ctx));
+                contexts.swap(moved);
+            }), true);
+
+        out << "  },\n";
+    }
+
+    void bench_group_public_keys(std::ostream& out)
+    {
+        std::vector<unsigned char> gpk(sizeof(xtt_daa_group_pub_key_lrsw), 0x42);
+        std::vector<unsigned char> basename(32, 0x17);
+        std::string gpk_as_text(2*gpk.size(), 'A');
+        std::string basename_as_text(2*basename.size(), 'B');
+
+        std::vector<std::unique_ptr<xtt::group_public_key_context>> loaded;
+        loaded.reserve(batch_size);
+
+        std::vector<xtt::group_public_key_context_lrsw_value> loaded_values;
+        loaded_values.reserve(batch_size);
+
+        out << "  \"group_public_key_context_lrsw\": {\n";
+
+        write_measurement(out, "default_then_initialize", measure([&]()
+            {
+                loaded.clear();
+                for (std::size_t i = 0; i < batch_size; ++i) {
+                    auto ctx = std::make_unique<xtt::group_public_key_context_lrsw>();
+                    xtt_initialize_group_public_key_context_lrsw(ctx->get(),
+                                                                 basename.data(),
+                                                                 static_cast<uint16_t>(basename.size()),
+                                                                 reinterpret_cast<const xtt_daa_group_pub_key_lrsw*>(gpk.data()));
+                    loaded.push_back(std::move(ctx));
+                }
+            }));
+
+        write_measurement(out, "from_gpk_and_basename", measure([&]()
+            {
+                loaded.clear();
+                for (std::size_t i = 0; i < batch_size; ++i)
+                    loaded.push_back(xtt::group_public_key_context_lrsw::from_gpk_and_basename(gpk.data(), gpk.size(),
+                                                                                               basename.data(), basename.size()));
+            }));
+
+        write_measurement(out, "from_gpk_and_basename_text", measure([&]()
+            {
+                loaded.clear();
+                for (std::size_t i = 0; i < batch_size; ++i)
+                    loaded.push_back(xtt::group_public_key_context_lrsw::from_gpk_and_basename(gpk_as_text, basename_as_text));
+            }));
+
+        write_measurement(out, "value_from_gpk_and_basename", measure([&]()
+            {
+                loaded_values.clear();
+                for (std::size_t i = 0; i < batch_size; ++i)
+                    loaded_values.push_back(*xtt::group_public_key_context_lrsw_value::from_gpk_and_basename(gpk.data(), gpk.size(),
+                                                                                                              basename.data(), basename.size()));
+            }));
+
+        std::vector<xtt::group_public_key_context_lrsw> contexts(batch_size);
+        write_measurement(out, "move", measure([&]()
+            {
+                std::vector<xtt::group_public_key_context_lrsw> moved;
+                moved.reserve(batch_size);
+                for (auto& ctx : contexts)
+                    moved.push_back(std::move(ctx));
+                contexts.swap(moved);
+            }), true);
+
+        out << "  }\n";
+    }
+
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 2) {
+        std::cerr << "usage: " << argv[0] << " [output.json]\n";
+        return 1;
+    }
+
+    if (0 != xtt::initialize_crypto()) {
+        std::cerr << "Error initializing cryptography library\n";
+        return 1;
+    }
+
+    std::ostringstream json;
+    json << "{\n"
+         << "  \"batch_size\": " << batch_size << ",\n";
+    bench_server_certificates(json);
+    bench_group_public_keys(json);
+    json << "}\n";
+
+    if (2 == argc) {
+        std::ofstream out(argv[1]);
+        out << json.str();
+        if (!out) {
+            std::cerr << "Error writing " << argv[1] << "\n";
+            return 1;
+        }
+    } else {
+        std::cout << json.str();
+    }
+}
@@ -0,0 +1,626 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+/*
+ * Measures, for each suite_spec, the costs of the symmetric primitives:
+ *  - hashing a handshake transcript,
+ *  - a proxy for deriving a record key and IV from a secret
+ *    (libxtt doesn't export its PRF, so this times one keyed-hash block per output,
+ *    with the suite's hash, through libsodium),
+ *  - sealing and opening records of typical sizes.
+ *
+ * AES-256-GCM is also measured with a portable, table-based implementation,
+ *  as a stand-in for running without AES-NI
+ *  (libsodium only provides AES-256-GCM with AES-NI).
+ *
+ * Results are written as JSON (to stdout, or to the file given as the only argument),
+ *  so server-side suite preferences can be set from measurements.
+ */
+
+#include <xtt.hpp>
+
+#include <sodium.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+    const std::size_t transcript_length = 1024;
+    const std::size_t record_sizes[] = {64, 256, 1024, 16384};
+    const std::chrono::milliseconds min_duration(200);
+
+    const char *name(xtt::algorithm::chacha20poly1305) { return "CHACHA20POLY1305"; }
+    const char *name(xtt::algorithm::aes256gcm) { return "AES256GCM"; }
+    const char *name(xtt::algorithm::sha512) { return "SHA512"; }
+    const char *name(xtt::algorithm::blake2b) { return "BLAKE2B"; }
+
+    void hash(xtt::algorithm::sha512, const std::vector<unsigned char>& in, unsigned char *out)
+    {
+        crypto_hash_sha512(out, in.data(), in.size());
+    }
+
+    void hash(xtt::algorithm::blake2b, const std::vector<unsigned char>& in, unsigned char *out)
+    {
+        crypto_generichash_blake2b(out, crypto_generichash_blake2b_BYTES_MAX, in.data(), in.size(), nullptr, 0);
+    }
+
+    // One PRF block keyed by `secret`, standing in for libxtt's expansion of a handshake secret into a key or IV.
+    void prf(xtt::algorithm::sha512, const unsigned char *secret, const char *label, unsigned char *out)
+    {
+        crypto_auth_hmacsha512_state state;
+        crypto_auth_hmacsha512_init(&state, secret, 64);
+        crypto_auth_hmacsha512_update(&state, reinterpret_cast<const unsigned char*>(label), std::char_traits<char>::length(label));
+        crypto_auth_hmacsha512_final(&state, out);
+    }
+
+    void prf(xtt::algorithm::blake2b, const unsigned char *secret, const char *label, unsigned char *out)
+    {
+        crypto_generichash_blake2b(out, crypto_generichash_blake2b_BYTES_MAX,
+                                   reinterpret_cast<const unsigned char*>(label), std::char_traits<char>::length(label),
+                                   secret, 64);
+    }
+
+    // Portable (table-based) AES-256-GCM, in the style of a generic C fallback,
+    //  giving a baseline for AES-256-GCM on CPUs without AES-NI
+    //  (where libsodium doesn't provide it at all).
+    // Only for timing: it isn't constant-time.
+    namespace portable {
+
+        std::uint8_t sbox[256];
+        std::uint32_t te[4][256];
+
+        std::uint8_t xtime(std::uint8_t x)
+        {
+            return static_cast<std::uint8_t>((x << 1) ^ ((x & 0x80) ? 0x1B : 0x00));
+        }
+
+        std::uint8_t rotl8(std::uint8_t x, int shift)
+        {
+            return static_cast<std::uint8_t>((x << shift) | (x >> (8 - shift)));
+        }
+
+        void init_tables()
+        {
+            // p runs over all non-zero elements of GF(2^8), with q its inverse
+            std::uint8_t p = 1;
+            std::uint8_t q = 1;
+            do {
+                p = static_cast<std::uint8_t>(p ^ xtime(p));
+                q = static_cast<std::uint8_t>(q ^ (q << 1));
+                q = static_cast<std::uint8_t>(q ^ (q << 2));
+                q = static_cast<std::uint8_t>(q ^ (q << 4));
+                if (q & 0x80)
+                    q ^= 0x09;
+                sbox[p] = static_cast<std::uint8_t>(q ^ rotl8(q, 1) ^ rotl8(q, 2) ^ rotl8(q, 3) ^ rotl8(q, 4) ^ 0x63);
+            } while (p != 1);
+            sbox[0] = 0x63;
+
+            for (int i = 0; i < 256; ++i) {
+                std::uint32_t s = sbox[i];
+                std::uint32_t s2 = xtime(sbox[i]);
+                std::uint32_t s3 = s2 ^ s;
+                std::uint32_t word = (s2 << 24) | (s << 16) | (s << 8) | s3;
+                for (int t = 0; t < 4; ++t) {
+                    te[t][i] = word;
+                    word = (word >> 8) | (word << 24);
+                }
+            }
+        }
+
+        std::uint32_t load_be32(const unsigned char *in)
+        {
+            return (std::uint32_t(in[0]) << 24) | (std::uint32_t(in[1]) << 16) | (std::uint32_t(in[2]) << 8) | in[3];
+        }
+
+        void store_be32(unsigned char *out, std::uint32_t value)
+        {
+            out[0] = static_cast<unsigned char>(value >> 24);
+            out[1] = static_cast<unsigned char>(value >> 16);
+            out[2] = static_cast<unsigned char>(value >> 8);
+            out[3] = static_cast<unsigned char>(value);
+        }
+
+        std::uint64_t load_be64(const unsigned char *in)
+        {
+            return (std::uint64_t(load_be32(in)) << 32) | load_be32(in + 4);
+        }
+
+        void store_be64(unsigned char *out, std::uint64_t value)
+        {
+            store_be32(out, static_cast<std::uint32_t>(value >> 32));
+            store_be32(out + 4, static_cast<std::uint32_t>(value));
+        }
+
+        std::uint32_t sub_word(std::uint32_t w)
+        {
+            return (std::uint32_t(sbox[w >> 24]) << 24) | (std::uint32_t(sbox[(w >> 16) & 0xFF]) << 16)
+                | (std::uint32_t(sbox[(w >> 8) & 0xFF]) << 8) | sbox[w & 0xFF];
+        }
+
+        struct aes256gcm {
+            std::uint32_t round_keys[60];
+            std::uint64_t h_table[16][2];
+
+            explicit aes256gcm(const unsigned char *key);
+
+            void encrypt_block(const unsigned char *in, unsigned char *out) const;
+            void ghash_multiply(unsigned char *x) const;
+            void ghash(unsigned char *x, const unsigned char *data, std::size_t length) const;
+            void crypt(unsigned char *data, std::size_t length, const unsigned char *nonce) const;
+            void tag(unsigned char *out,
+                     const unsigned char *ad, std::size_t ad_length,
+                     const unsigned char *ciphertext, std::size_t length,
+                     const unsigned char *nonce) const;
+
+            void seal(unsigned char *data, std::size_t length,
+                      const unsigned char *ad, std::size_t ad_length,
+                      unsigned char *tag_out,
+                      const unsigned char *nonce) const
+            {
+                crypt(data, length, nonce);
+                tag(tag_out, ad, ad_length, data, length, nonce);
+            }
+
+            bool open(unsigned char *data, std::size_t length,
+                      const unsigned char *ad, std::size_t ad_length,
+                      const unsigned char *expected_tag,
+                      const unsigned char *nonce) const
+            {
+                unsigned char computed[16];
+                tag(computed, ad, ad_length, data, length, nonce);
+                if (0 != sodium_memcmp(computed, expected_tag, sizeof(computed)))
+                    return false;
+
+                crypt(data, length, nonce);
+                return true;
+            }
+        };
+
+        aes256gcm::aes256gcm(const unsigned char *key)
+        {
+            for (int i = 0; i < 8; ++i)
+                round_keys[i] = load_be32(key + 4 * i);
+
+            std::uint32_t rcon = 0x01;
+            for (int i = 8; i < 60; ++i) {
+                std::uint32_t temp = round_keys[i - 1];
+                if (0 == i % 8) {
+                    temp = sub_word((temp << 8) | (temp >> 24)) ^ (rcon << 24);
+                    rcon = xtime(static_cast<std::uint8_t>(rcon));
+                } else if (4 == i % 8) {
+                    temp = sub_word(temp);
+                }
+                round_keys[i] = round_keys[i - 8] ^ temp;
+            }
+
+            // 4-bit multiplication tables for H = E(K, 0^128)
+            unsigned char h[16] = {0};
+            encrypt_block(h, h);
+            std::uint64_t v[2] = {load_be64(h), load_be64(h + 8)};
+
+            h_table[0][0] = h_table[0][1] = 0;
+            for (int i = 8; i > 0; i >>= 1) {
+                h_table[i][0] = v[0];
+                h_table[i][1] = v[1];
+                std::uint64_t reduce = 0xE100000000000000ULL & (0 - (v[1] & 1));
+                v[1] = (v[0] << 63) | (v[1] >> 1);
+                v[0] = (v[0] >> 1) ^ reduce;
+            }
+            for (int i = 2; i < 16; i <<= 1) {
+                for (int j = 1; j < i; ++j) {
+                    h_table[i + j][0] = h_table[i][0] ^ h_table[j][0];
+                    h_table[i + j][1] = h_table[i][1] ^ h_table[j][1];
+                }
+            }
+        }
+
+        void aes256gcm::encrypt_block(const unsigned char *in, unsigned char *out) const
+        {
+            std::uint32_t s[4];
+            for (int i = 0; i < 4; ++i)
+                s[i] = load_be32(in + 4 * i) ^ round_keys[i];
+
+            for (int round = 1; round < 14; ++round) {
+                std::uint32_t t[4];
+                for (int i = 0; i < 4; ++i) {
+                    t[i] = te[0][s[i] >> 24]
+                        ^ te[1][(s[(i + 1) % 4] >> 16) & 0xFF]
+                        ^ te[2][(s[(i + 2) % 4] >> 8) & 0xFF]
+                        ^ te[3][s[(i + 3) % 4] & 0xFF]
+                        ^ round_keys[4 * round + i];
+                }
+                std::copy(t, t + 4, s);
+            }
+
+            for (int i = 0; i < 4; ++i) {
+                std::uint32_t word = (std::uint32_t(sbox[s[i] >> 24]) << 24)
+                    ^ (std::uint32_t(sbox[(s[(i + 1) % 4] >> 16) & 0xFF]) << 16)
+                    ^ (std::uint32_t(sbox[(s[(i + 2) % 4] >> 8) & 0xFF]) << 8)
+                    ^ std::uint32_t(sbox[s[(i + 3) % 4] & 0xFF]);
+                store_be32(out + 4 * i, word ^ round_keys[56 + i]);
+            }
+        }
+
+        void aes256gcm::ghash_multiply(unsigned char *x) const
+        {
+            static const std::uint64_t rem_4bit[16] = {
+                0x0000ULL << 48, 0x1C20ULL << 48, 0x3840ULL << 48, 0x2460ULL << 48,
+                0x7080ULL << 48, 0x6CA0ULL << 48, 0x48C0ULL << 48, 0x54E0ULL << 48,
+                0xE100ULL << 48, 0xFD20ULL << 48, 0xD940ULL << 48, 0xC560ULL << 48,
+                0x9180ULL << 48, 0x8DA0ULL << 48, 0xA9C0ULL << 48, 0xB5E0ULL << 48};
+
+            // From the last nibble to the first, multiply by x^4 (reducing), then add H * nibble
+            std::uint64_t z[2] = {0, 0};
+            bool first = true;
+            for (int i = 15; i >= 0; --i) {
+                const int nibbles[2] = {x[i] & 0x0F, x[i] >> 4};
+                for (int nibble : nibbles) {
+                    if (!first) {
+                        std::uint64_t rem = z[1] & 0x0F;
+                        z[1] = (z[0] << 60) | (z[1] >> 4);
+                        z[0] = (z[0] >> 4) ^ rem_4bit[rem];
+                    }
+                    first = false;
+
+                    z[0] ^= h_table[nibble][0];
+                    z[1] ^= h_table[nibble][1];
+                }
+            }
+
+            store_be64(x, z[0]);
+            store_be64(x + 8, z[1]);
+        }
+
+        void aes256gcm::ghash(unsigned char *x, const unsigned char *data, std::size_t length) const
+        {
+            for (std::size_t offset = 0; offset < length; offset += 16) {
+                std::size_t block = std::min<std::size_t>(16, length - offset);
+                for (std::size_t i = 0; i < block; ++i)
+                    x[i] ^= data[offset + i];
+                ghash_multiply(x);
+            }
+        }
+
+        void aes256gcm::crypt(unsigned char *data, std::size_t length, const unsigned char *nonce) const
+        {
+            unsigned char counter[16];
+            std::copy(nonce, nonce + 12, counter);
+
+            unsigned char keystream[16];
+            std::uint32_t block_number = 2;     // 1 is for the tag
+            for (std::size_t offset = 0; offset < length; offset += 16, ++block_number) {
+                store_be32(counter + 12, block_number);
+                encrypt_block(counter, keystream);
+
+                std::size_t block = std::min<std::size_t>(16, length - offset);
+                for (std::size_t i = 0; i < block; ++i)
+                    data[offset + i] ^= keystream[i];
+            }
+        }
+
+        void aes256gcm::tag(unsigned char *out,
+                            const unsigned char *ad, std::size_t ad_length,
+                            const unsigned char *ciphertext, std::size_t length,
+                            const unsigned char *nonce) const
+        {
+            unsigned char x[16] = {0};
+            ghash(x, ad, ad_length);
+            ghash(x, ciphertext, length);
+
+            unsigned char lengths[16];
+            store_be64(lengths, std::uint64_t(ad_length) * 8);
+            store_be64(lengths + 8, std::uint64_t(length) * 8);
+            ghash(x, lengths, sizeof(lengths));
+
+            unsigned char counter[16];
+            std::copy(nonce, nonce + 12, counter);
+            store_be32(counter + 12, 1);
+            encrypt_block(counter, out);
+            for (int i = 0; i < 16; ++i)
+                out[i] ^= x[i];
+        }
+
+    }   // namespace portable
+
+    struct measurement {
+        double ns_per_op;
+        double mb_per_s;
+    };
+
+    // Repeat `op` (which processes `bytes` bytes) until `min_duration` has passed.
+    template <typename Op>
+    measurement measure(std::size_t bytes, Op op)
+    {
+        using clock = std::chrono::steady_clock;
+
+        std::size_t iterations = 0;
+        auto start = clock::now();
+        auto elapsed = clock::duration::zero();
+        do {
+            for (int i = 0; i < 64; ++i)
+                op();
+            iterations += 64;
+            elapsed = clock::now() - start;
+        } while (elapsed < min_duration);
+
+        double ns = std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+        return {ns, bytes ? (bytes / ns) * 1e3 : 0.0};
+    }
+
+    // Opening needs records sealed under the opener's sequence numbers,
+    //  so seal each batch untimed, then time opening it.
+    //  Returns an empty optional if any record fails to open.
+    OPTIONAL_NS::optional<measurement> measure_open(std::size_t size,
+                                                    const unsigned char *ad,
+                                                    std::size_t ad_length,
+                                                    xtt::record_cipher& sealer,
+                                                    xtt::record_cipher& opener)
+    {
+        using clock = std::chrono::steady_clock;
+
+        const std::size_t batch_size = 64;
+        std::vector<unsigned char> records(batch_size * size, 0x17);
+        std::vector<unsigned char> tags(batch_size * xtt::record_cipher::tag_length);
+
+        std::size_t iterations = 0;
+        auto elapsed = clock::duration::zero();
+        do {
+            for (std::size_t i = 0; i < batch_size; ++i)
+                sealer.seal(&records[i * size], size, ad, ad_length, &tags[i * xtt::record_cipher::tag_length]);
+
+            auto start = clock::now();
+            for (std::size_t i = 0; i < batch_size; ++i) {
+                if (!opener.open(&records[i * size], size, ad, ad_length, &tags[i * xtt::record_cipher::tag_length]))
+                    return OPTIONAL_NS::nullopt;
+            }
+            elapsed += clock::now() - start;
+            iterations += batch_size;
+        } while (elapsed < min_duration);
+
+        double ns = std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+        return measurement{ns, (size / ns) * 1e3};
+    }
+
+    void write_measurement(std::ostream& out, const measurement& m)
+    {
+        out << "{\"ns_per_op\": " << m.ns_per_op << ", \"mb_per_s\": " << m.mb_per_s << "}";
+    }
+
+    // Check the portable AES-256-GCM against a published test vector
+    //  (McGrew & Viega, test case 14), and against libsodium's where available.
+    bool check_portable_aes256gcm()
+    {
+        const unsigned char key[32] = {0};
+        const unsigned char nonce[12] = {0};
+        const unsigned char expected_ciphertext[16] = {0xce, 0xa7, 0x40, 0x3d, 0x4d, 0x60, 0x6b, 0x6e,
+                                                       0x07, 0x4e, 0xc5, 0xd3, 0xba, 0xf3, 0x9d, 0x18};
+        const unsigned char expected_tag[16] = {0xd0, 0xd1, 0xc8, 0xa7, 0x99, 0x99, 0x6b, 0xf0,
+                                                0x26, 0x5b, 0x98, 0xb5, 0xd4, 0x8a, 0xb9, 0x19};
+
+        portable::aes256gcm cipher(key);
+        unsigned char data[16] = {0};
+        unsigned char tag[16];
+        cipher.seal(data, sizeof(data), nullptr, 0, tag, nonce);
+        if (!std::equal(data, data + 16, expected_ciphertext) || !std::equal(tag, tag + 16, expected_tag))
+            return false;
+
+        if (!crypto_aead_aes256gcm_is_available())
+            return true;
+
+        unsigned char other_key[32];
+        unsigned char other_nonce[12];
+        for (std::size_t i = 0; i < sizeof(other_key); ++i)
+            other_key[i] = static_cast<unsigned char>(i * 29 + 7);
+        for (std::size_t i = 0; i < sizeof(other_nonce); ++i)
+            other_nonce[i] = static_cast<unsigned char>(i * 13 + 1);
+        const unsigned char ad[5] = {1, 2, 3, 4, 5};
+
+        std::vector<unsigned char> ours(1000);
+        for (std::size_t i = 0; i < ours.size(); ++i)
+            ours[i] = static_cast<unsigned char>(i);
+        std::vector<unsigned char> theirs = ours;
+        unsigned char our_tag[16];
+        unsigned char their_tag[16];
+
+        portable::aes256gcm(other_key).seal(ours.data(), ours.size(), ad, sizeof(ad), our_tag, other_nonce);
+        crypto_aead_aes256gcm_encrypt_detached(theirs.data(), their_tag, nullptr,
+                                               theirs.data(), theirs.size(),
+                                               ad, sizeof(ad),
+                                               nullptr, other_nonce, other_key);
+
+        return ours == theirs && std::equal(our_tag, our_tag + 16, their_tag);
+    }
+
+    void bench_portable_aes256gcm(std::ostream& out)
+    {
+        unsigned char key[32];
+        unsigned char nonce[12];
+        std::fill(key, key + sizeof(key), 0x01);
+        std::fill(nonce, nonce + sizeof(nonce), 0x02);
+        portable::aes256gcm cipher(key);
+
+        out << "  \"aes256gcm_portable\": [";
+
+        bool first = true;
+        for (std::size_t size : record_sizes) {
+            std::vector<unsigned char> data(size, 0x17);
+            const unsigned char ad[2] = {static_cast<unsigned char>(size >> 8), static_cast<unsigned char>(size)};
+            unsigned char tag[16];
+
+            auto seal = measure(size, [&]() { cipher.seal(data.data(), data.size(), ad, sizeof(ad), tag, nonce); });
+
+            // Opening decrypts in place, so each iteration opens a fresh copy of one sealed record
+            std::vector<unsigned char> sealed(size, 0x17);
+            cipher.seal(sealed.data(), sealed.size(), ad, sizeof(ad), tag, nonce);
+            auto open = measure(size, [&]()
+                                      {
+                                          std::copy(sealed.begin(), sealed.end(), data.begin());
+                                          cipher.open(data.data(), data.size(), ad, sizeof(ad), tag, nonce);
+                                      });
+
+            out << (first ? "\n" : ",\n")
+                << "    {\"size\": " << size << ", \"seal\": ";
+            write_measurement(out, seal);
+            out << ", \"open\": ";
+            write_measurement(out, open);
+            out << "}";
+            first = false;
+        }
+
+        out << "\n  ],\n";
+    }
+
+    // Returns false if a record sealed by the benchmark failed to open
+    template <typename Traits>
+    bool bench_suite(std::ostream& out, Traits)
+    {
+        using aead = typename Traits::aead;
+        using hash_alg = typename Traits::hash;
+
+        out << "    {\n"
+            << "      \"suite_spec\": " << static_cast<int>(Traits::value) << ",\n"
+            << "      \"name\": \"X25519_LRSW_ECDSAP256_" << name(aead()) << "_" << name(hash_alg()) << "\",\n";
+
+        std::vector<unsigned char> transcript(transcript_length, 0x42);
+        unsigned char digest[64];
+        out << "      \"transcript_hash\": ";
+        write_measurement(out, measure(transcript.size(), [&]() { hash(hash_alg(), transcript, digest); }));
+        out << ",\n";
+
+        unsigned char secret[64] = {0};
+        unsigned char block[64];
+        out << "      \"key_derivation_proxy\": ";
+        write_measurement(out, measure(0, [&]()
+                                          {
+                                              prf(hash_alg(), secret, "key", block);
+                                              prf(hash_alg(), secret, "iv", block);
+                                          }));
+        out << ",\n";
+
+        xtt::record_keys keys;
+        keys.key.fill(0x01);
+        keys.iv.fill(0x02);
+        auto sealer = xtt::record_cipher::from_keys(Traits::value, keys);
+        auto opener = xtt::record_cipher::from_keys(Traits::value, keys);
+        out << "      \"aead_available\": " << (sealer ? "true" : "false") << ",\n"
+            << "      \"records\": [";
+
+        bool first = true;
+        for (std::size_t size : record_sizes) {
+            if (!sealer)
+                break;
+
+            std::vector<unsigned char> data(size, 0x17);
+            const unsigned char ad[2] = {static_cast<unsigned char>(size >> 8), static_cast<unsigned char>(size)};
+            unsigned char tag[xtt::record_cipher::tag_length];
+
+            auto seal = measure(size, [&]() { sealer->seal(data.data(), data.size(), ad, sizeof(ad), tag); });
+            sealer = xtt::record_cipher::from_keys(Traits::value, keys);
+
+            auto open = measure_open(size, ad, sizeof(ad), *sealer, *opener);
+            if (!open) {
+                std::cerr << "Record of " << size << " bytes failed to open\n";
+                return false;
+            }
+
+            sealer = xtt::record_cipher::from_keys(Traits::value, keys);
+            opener = xtt::record_cipher::from_keys(Traits::value, keys);
+
+            out << (first ? "\n" : ",\n")
+                << "        {\"size\": " << size << ", \"seal\": ";
+            write_measurement(out, seal);
+            out << ", \"open\": ";
+            write_measurement(out, *open);
+            out << "}";
+            first = false;
+        }
+
+        out << (first ? "]\n" : "\n      ]\n")
+            << "    }";
+
+        return true;
+    }
+
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 2) {
+        std::cerr << "usage: " << argv[0] << " [output.json]\n";
+        return 1;
+    }
+
+    if (0 != xtt::initialize_crypto()) {
+        std::cerr << "Error initializing cryptography library\n";
+        return 1;
+    }
+
+    // libsodium only detects AES-NI in sodium_init (which may be called repeatedly)
+    if (sodium_init() < 0) {
+        std::cerr << "Error initializing libsodium\n";
+        return 1;
+    }
+
+    portable::init_tables();
+    if (!check_portable_aes256gcm()) {
+        std::cerr << "Portable AES-256-GCM gives wrong results\n";
+        return 1;
+    }
+
+    std::ostringstream json;
+    json << "{\n"
+         << "  \"aesni_available\": " << (crypto_aead_aes256gcm_is_available() ? "true" : "false") << ",\n";
+    bench_portable_aes256gcm(json);
+    json << "  \"suites\": [\n";
+
+    bool first = true;
+    bool ok = true;
+    xtt::for_each_suite([&](auto traits)
+                        {
+                            if (!ok)
+                                return;
+                            if (!first)
+                                json << ",\n";
+                            ok = bench_suite(json, traits);
+                            first = false;
+                        });
+    if (!ok)
+        return 1;
+
+    json << "\n  ]\n"
+         << "}\n";
+
+    if (2 == argc) {
+        std::ofstream out(argv[1]);
+        out << json.str();
+        if (!out) {
+            std::cerr << "Error writing " << argv[1] << "\n";
+            return 1;
+        }
+    } else {
+        std::cout << json.str();
+    }
+}
@@ -0,0 +1,551 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+/*
+ * Measures the I/O cost of serving XTT handshakes over TCP loopback,
+ *  to compare the Boost.Asio backends (build once with USE_IO_URING=OFF and once with ON).
+ *
+ * The parent serves handshakes on one thread the way the example server does:
+ *  a `connection_manager` of `xtt::asio::server_context`s over TCP sockets,
+ *  with the configuration from a `server_configuration`,
+ *  so the library's own read and write path is what's measured.
+ * A forked child runs blocking libxtt clients, each doing full handshakes one connection at a time;
+ *  their cost doesn't count towards the server's syscalls or CPU time.
+ *
+ * Reported, per handshake: the server's syscalls (counted with the raw_syscalls:sys_enter tracepoint,
+ *  so this needs tracefs and permission to open tracepoint events; otherwise it's null)
+ *  and its CPU time. Also the handshake rate, and how the handshakes ended.
+ *
+ * Both the server's data (certificate, private key, GPK and basename)
+ *  and the client's (DAA credential and secret key, root ID and public key)
+ *  are read from the working directory (see xtt's examples/data).
+ *
+ * Results are written as JSON (to stdout, or to the file given as the last argument).
+ */
+
+#include <xtt/asio.hpp>
+#include <xtt.h>
+
+#include <sodium.h>
+
+#include <boost/asio.hpp>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    const char *daa_gpk_file = "daa_gpk.bin";
+    const char *basename_file = "basename.bin";
+    const char *server_certificate_file = "server_certificate.bin";
+    const char *server_privatekey_file = "server_privatekey.bin";
+    const char *daa_cred_file = "daa_cred.bin";
+    const char *daa_secretkey_file = "daa_secretkey.bin";
+    const char *root_id_file = "root_id.bin";
+    const char *root_pubkey_file = "root_pub.bin";
+
+    using boost::asio::ip::tcp;
+
+    const char *backend_name()
+    {
+#if defined(BOOST_ASIO_HAS_IO_URING_AS_DEFAULT)
+        return "io_uring";
+#else
+        return "epoll";
+#endif
+    }
+
+    // Counts syscalls made by this process (and threads it starts later), or reports unavailable
+    class syscall_counter {
+    public:
+        syscall_counter()
+            : fd_(-1)
+        {
+            long id = tracepoint_id();
+            if (id < 0)
+                return;
+
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.type = PERF_TYPE_TRACEPOINT;
+            attr.size = sizeof(attr);
+            attr.config = static_cast<std::uint64_t>(id);
+            attr.disabled = 1;
+            attr.inherit = 1;
+            fd_ = static_cast<int>(::syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+
+        ~syscall_counter()
+        {
+            if (fd_ >= 0)
+                ::close(fd_);
+        }
+
+        syscall_counter(const syscall_counter&) = delete;
+        syscall_counter& operator=(const syscall_counter&) = delete;
+
+        bool available() const { return fd_ >= 0; }
+
+        void start()
+        {
+            if (fd_ >= 0) {
+                ::ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+                ::ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+
+        std::uint64_t stop()
+        {
+            std::uint64_t count = 0;
+            if (fd_ >= 0) {
+                ::ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+                if (sizeof(count) != ::read(fd_, &count, sizeof(count)))
+                    count = 0;
+            }
+            return count;
+        }
+
+    private:
+        static long tracepoint_id()
+        {
+            for (const char *path : {"/sys/kernel/tracing/events/raw_syscalls/sys_enter/id",
+                                     "/sys/kernel/debug/tracing/events/raw_syscalls/sys_enter/id"}) {
+                std::ifstream file(path);
+                long id;
+                if (file >> id)
+                    return id;
+            }
+            return -1;
+        }
+
+        int fd_;
+    };
+
+    // User plus system CPU time used by this process so far
+    double cpu_time_us()
+    {
+        rusage usage;
+        ::getrusage(RUSAGE_SELF, &usage);
+        return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1e6
+               + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+    }
+
+    /*
+     * Serves handshakes like the example server, on the io_context's one thread.
+     */
+    class server {
+    public:
+        server(boost::asio::io_context& io_context,
+               tcp::acceptor& acceptor,
+               std::shared_ptr<const xtt::asio::server_configuration> config)
+            : io_context_(io_context),
+              acceptor_(acceptor),
+              config_(std::move(config)),
+              cookie_ctx_(),
+              id_allocator_(),
+              connections_(io_context.get_executor()),
+              finished_(0),
+              outcomes_()
+        {
+        }
+
+        void start()
+        {
+            acceptor_.async_accept([this](const boost::system::error_code& ec, tcp::socket socket)
+                                   {
+                                       if (ec)
+                                           return;
+
+                                       socket.set_option(tcp::no_delay(true));
+                                       this->run_handshake(std::move(socket));
+                                       this->start();
+                                   });
+        }
+
+        std::size_t finished() const
+        {
+            return finished_;
+        }
+
+        const std::map<std::string, std::size_t>& outcomes() const
+        {
+            return outcomes_;
+        }
+
+    private:
+        void run_handshake(tcp::socket socket)
+        {
+            xtt::asio::server_context& xtt_context = connections_.create(std::move(socket), cookie_ctx_);
+            config_->apply_to(xtt_context);
+
+            connections_.async_handle_connect(xtt_context,
+                                              [this](xtt::group_identity claimed_gid,
+                                                     xtt::identity,
+                                                     auto&& continuation)
+                                              {
+                                                  auto gpk = config_->find_gpk(claimed_gid);
+                                                  boost::asio::post(io_context_,
+                                                                    [continuation, gpk]()
+                                                                    {
+                                                                        continuation(gpk ? boost::system::error_code() : xtt::asio::get_unknown_gid_ec(),
+                                                                                     gpk);
+                                                                    });
+                                              },
+                                              xtt::asio::make_assign_id_callback(id_allocator_, xtt_context),
+                                              xtt::asio::release_identity_on_failure(id_allocator_,
+                                                                                     xtt_context,
+                                                                                     [this](const boost::system::error_code& ec)
+                                                                                     {
+                                                                                         ++finished_;
+                                                                                         ++outcomes_[ec ? ec.message() : "success"];
+                                                                                     }));
+        }
+
+        boost::asio::io_context& io_context_;
+        tcp::acceptor& acceptor_;
+        std::shared_ptr<const xtt::asio::server_configuration> config_;
+
+        xtt::server_cookie_context cookie_ctx_;
+        xtt::hash_identity_allocator id_allocator_;
+        xtt::asio::connection_manager connections_;
+
+        std::size_t finished_;
+        std::map<std::string, std::size_t> outcomes_;
+    };
+
+    struct client_credentials {
+        xtt_group_id gid;
+        xtt_daa_priv_key_lrsw priv_key;
+        xtt_daa_credential_lrsw cred;
+        std::vector<unsigned char> basename;
+        xtt_certificate_root_id root_id;
+        xtt_ecdsap256_pub_key root_pubkey;
+    };
+
+    bool read_fully(int fd, unsigned char *buf, std::size_t length)
+    {
+        std::size_t so_far = 0;
+        while (so_far < length) {
+            ssize_t n = ::recv(fd, buf + so_far, length - so_far, 0);
+            if (n <= 0)
+                return false;
+            so_far += static_cast<std::size_t>(n);
+        }
+        return true;
+    }
+
+    bool write_fully(int fd, const unsigned char *buf, std::size_t length)
+    {
+        std::size_t so_far = 0;
+        while (so_far < length) {
+            ssize_t n = ::send(fd, buf + so_far, length - so_far, MSG_NOSIGNAL);
+            if (n <= 0)
+                return false;
+            so_far += static_cast<std::size_t>(n);
+        }
+        return true;
+    }
+
+    // One handshake over the connected, blocking socket `fd`
+    void client_handshake(int fd,
+                          xtt_client_group_context& group_ctx,
+                          xtt_server_root_certificate_context& root_ctx)
+    {
+        std::array<unsigned char, MAX_HANDSHAKE_SERVER_MESSAGE_LENGTH> in_buffer;
+        std::array<unsigned char, MAX_HANDSHAKE_CLIENT_MESSAGE_LENGTH> out_buffer;
+        xtt_client_handshake_context ctx;
+        uint16_t io_len = 0;
+        unsigned char *io_ptr = nullptr;
+
+        xtt_return_code_type rc = xtt_initialize_client_handshake_context(&ctx,
+                                                                          in_buffer.data(), static_cast<uint16_t>(in_buffer.size()),
+                                                                          out_buffer.data(), static_cast<uint16_t>(out_buffer.size()),
+                                                                          XTT_VERSION_ONE,
+                                                                          XTT_X25519_LRSW_ECDSAP256_CHACHA20POLY1305_SHA512);
+        if (XTT_RETURN_SUCCESS != rc)
+            return;
+
+        rc = xtt_handshake_client_start(&io_len, &io_ptr, &ctx);
+        for (;;) {
+            switch (rc) {
+                case XTT_RETURN_WANT_WRITE:
+                    if (!write_fully(fd, io_ptr, io_len))
+                        return;
+                    rc = xtt_handshake_client_handle_io(io_len, 0, &io_len, &io_ptr, &ctx);
+                    break;
+                case XTT_RETURN_WANT_READ:
+                    if (!read_fully(fd, io_ptr, io_len))
+                        return;
+                    rc = xtt_handshake_client_handle_io(0, io_len, &io_len, &io_ptr, &ctx);
+                    break;
+                case XTT_RETURN_WANT_PREPARSESERVERATTEST:
+                    {
+                        // There's only the one root, so the claimed one isn't checked
+                        xtt_certificate_root_id claimed_root;
+                        rc = xtt_handshake_client_preparse_serverattest(&claimed_root, &io_len, &io_ptr, &ctx);
+                    }
+                    break;
+                case XTT_RETURN_WANT_BUILDIDCLIENTATTEST:
+                    rc = xtt_handshake_client_build_idclientattest(&io_len, &io_ptr,
+                                                                   &root_ctx,
+                                                                   &xtt_null_identity,
+                                                                   &group_ctx,
+                                                                   &ctx);
+                    break;
+                case XTT_RETURN_WANT_PARSEIDSERVERFINISHED:
+                    rc = xtt_handshake_client_parse_idserverfinished(&io_len, &io_ptr, &ctx);
+                    break;
+                default:
+                    // Finished, or failed (which the server reports)
+                    return;
+            }
+        }
+    }
+
+    // One client's handshakes, run in the forked child
+    void run_client(unsigned short port, std::size_t handshakes, const client_credentials& creds)
+    {
+        xtt_client_group_context group_ctx;
+        xtt_group_id gid = creds.gid;
+        xtt_daa_priv_key_lrsw priv_key = creds.priv_key;
+        xtt_daa_credential_lrsw cred = creds.cred;
+        xtt_initialize_client_group_context_lrsw(&group_ctx, &gid, &priv_key, &cred,
+                                                 creds.basename.data(), static_cast<uint16_t>(creds.basename.size()));
+
+        xtt_server_root_certificate_context root_ctx;
+        xtt_certificate_root_id root_id = creds.root_id;
+        xtt_ecdsap256_pub_key root_pubkey = creds.root_pubkey;
+        xtt_initialize_server_root_certificate_context_ecdsap256(&root_ctx, &root_id, &root_pubkey);
+
+        sockaddr_in addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        for (std::size_t i = 0; i < handshakes; ++i) {
+            int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+            int one = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            if (0 != ::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)))
+                std::_Exit(1);
+
+            client_handshake(fd, group_ctx, root_ctx);
+            ::close(fd);
+        }
+    }
+
+    std::vector<unsigned char> read_file(const char *file_name)
+    {
+        std::ifstream file(file_name, std::ios::in | std::ios::binary);
+        return std::vector<unsigned char>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    }
+
+    template <typename T>
+    bool read_exactly(const char *file_name, T& out)
+    {
+        std::vector<unsigned char> contents = read_file(file_name);
+        if (contents.size() != sizeof(out.data)) {
+            std::cerr << "Error reading '" << file_name << "'\n";
+            return false;
+        }
+
+        std::copy(contents.begin(), contents.end(), out.data);
+        return true;
+    }
+
+    std::shared_ptr<const xtt::asio::server_configuration> load_server_configuration()
+    {
+        auto gpk = xtt::group_public_key_context_lrsw::from_gpk_and_basename(read_file(daa_gpk_file),
+                                                                            read_file(basename_file));
+        if (!gpk) {
+            std::cerr << "Error deserializing GPK and basename\n";
+            return nullptr;
+        }
+
+        // GID = SHA-256(GPK), as in the example server
+        std::vector<unsigned char> raw_gid(crypto_hash_sha256_BYTES);
+        std::vector<unsigned char> gpk_serial = gpk->get_gpk();
+        crypto_hash_sha256(raw_gid.data(), gpk_serial.data(), gpk_serial.size());
+        auto gid = xtt::group_identity::deserialize(raw_gid);
+        if (!gid) {
+            std::cerr << "Error computing GID from GPK\n";
+            return nullptr;
+        }
+
+        xtt::asio::group_public_key_map gpks;
+        gpks[*gid] = std::move(gpk);
+
+        boost::system::error_code cert_ec;
+        auto certificates = xtt::asio::make_server_certificate_map(read_file(server_certificate_file),
+                                                                   read_file(server_privatekey_file),
+                                                                   cert_ec);
+        if (cert_ec) {
+            std::cerr << "Error deserializing certificate\n";
+            return nullptr;
+        }
+
+        return xtt::asio::server_configuration::create(std::move(certificates), std::move(gpks));
+    }
+
+    bool load_client_credentials(client_credentials& creds)
+    {
+        xtt_daa_group_pub_key_lrsw gpk;
+        if (!read_exactly(daa_gpk_file, gpk) ||
+            !read_exactly(daa_cred_file, creds.cred) ||
+            !read_exactly(daa_secretkey_file, creds.priv_key) ||
+            !read_exactly(root_id_file, creds.root_id) ||
+            !read_exactly(root_pubkey_file, creds.root_pubkey))
+            return false;
+
+        creds.basename = read_file(basename_file);
+
+        // GID = SHA-256(GPK), as in the example server
+        crypto_hash_sha256(creds.gid.data, gpk.data, sizeof(gpk.data));
+
+        return true;
+    }
+
+}
+
+int main(int argc, char *argv[])
+{
+    std::size_t handshakes = 2000;
+    std::size_t concurrency = 16;
+    const char *output_file = nullptr;
+    bool usage_error = false;
+    for (int i = 1; i < argc; ++i) {
+        if (0 == std::strcmp(argv[i], "--handshakes") && i + 1 < argc)
+            handshakes = std::strtoul(argv[++i], nullptr, 10);
+        else if (0 == std::strcmp(argv[i], "--concurrency") && i + 1 < argc)
+            concurrency = std::strtoul(argv[++i], nullptr, 10);
+        else if (!output_file && argv[i][0] != '-')
+            output_file = argv[i];
+        else
+            usage_error = true;
+    }
+    if (usage_error || 0 == concurrency || handshakes < concurrency) {
+        std::cerr << "usage: " << argv[0] << " [--handshakes N] [--concurrency C] [output.json]\n";
+        return 1;
+    }
+    handshakes -= handshakes % concurrency;
+
+    if (0 != xtt::initialize_crypto()) {
+        std::cerr << "Error initializing cryptography library\n";
+        return 1;
+    }
+
+    auto config = load_server_configuration();
+    client_credentials creds;
+    if (!config || !load_client_credentials(creds))
+        return 1;
+
+    boost::asio::io_context io_context;
+    tcp::acceptor acceptor(io_context, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+    unsigned short port = acceptor.local_endpoint().port();
+
+    io_context.notify_fork(boost::asio::io_context::fork_prepare);
+    pid_t child = ::fork();
+    if (child < 0) {
+        std::cerr << "Error forking the client process\n";
+        return 1;
+    }
+    if (0 == child) {
+        // The clients use blocking sockets, and never touch the parent's io_context
+        std::vector<std::thread> clients;
+        for (std::size_t i = 0; i < concurrency; ++i)
+            clients.emplace_back(run_client, port, handshakes / concurrency, std::cref(creds));
+        for (auto& client : clients)
+            client.join();
+        std::_Exit(0);
+    }
+    io_context.notify_fork(boost::asio::io_context::fork_parent);
+
+    server xtt_server(io_context, acceptor, std::move(config));
+    syscall_counter syscalls;
+
+    xtt_server.start();
+
+    auto start = std::chrono::steady_clock::now();
+    double cpu_start_us = cpu_time_us();
+    syscalls.start();
+    while (xtt_server.finished() < handshakes && 0 != io_context.run_one())
+        ;
+    std::uint64_t syscall_count = syscalls.stop();
+    double cpu_us = cpu_time_us() - cpu_start_us;
+    double elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int status = 0;
+    ::waitpid(child, &status, 0);
+    if (xtt_server.finished() < handshakes || !WIFEXITED(status) || 0 != WEXITSTATUS(status)) {
+        std::cerr << "Only " << xtt_server.finished() << " of " << handshakes << " handshakes finished\n";
+        return 1;
+    }
+
+    std::ofstream file;
+    if (output_file) {
+        file.open(output_file);
+        if (!file) {
+            std::cerr << "Error opening '" << output_file << "'\n";
+            return 1;
+        }
+    }
+    std::ostream& out = output_file ? file : std::cout;
+
+    out << "{\n";
+    out << "  \"backend\": \"" << backend_name() << "\",\n";
+    out << "  \"handshakes\": " << handshakes << ",\n";
+    out << "  \"concurrency\": " << concurrency << ",\n";
+    out << "  \"handshakes_per_s\": " << handshakes / elapsed_s << ",\n";
+    out << "  \"outcomes\": {";
+    const char *separator = "\n";
+    for (const auto& outcome : xtt_server.outcomes()) {
+        out << separator << "    \"" << outcome.first << "\": " << outcome.second;
+        separator = ",\n";
+    }
+    out << "\n  },\n";
+    out << "  \"cpu_us_per_handshake\": " << cpu_us / handshakes << ",\n";
+    out << "  \"syscalls_per_handshake\": ";
+    if (syscalls.available())
+        out << double(syscall_count) / handshakes << "\n";
+    else
+        out << "null\n";
+    out << "}\n";
+}
@@ -0,0 +1,348 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+/*
+ * Replays a handshake trace (recorded with `server_context::set_trace`)
+ *  against server contexts running over in-memory streams,
+ *  so handshake performance can be measured on real client traffic
+ *  without the network or the clients.
+ *
+ * Each recorded connection gets its own server context, and all run concurrently
+ *  on one thread, either as fast as possible or (with `--paced`)
+ *  with each client's bytes arriving at their recorded times.
+ *
+ * Randomness (including the cookie key) comes from a ChaCha20 stream with a fixed seed,
+ *  so repeated replays of a trace do the same work.
+ *  The server's randomness (its ephemeral key, nonce and cookie key) thus differs
+ *  from when the trace was recorded, so each recorded IdClientAttest fails the cookie check
+ *  in preparse_idclientattest, before its group signature is looked at.
+ *  The replay therefore measures handling ClientInit and building and sending ServerAttest
+ *  (including the server's signature), and then rejecting IdClientAttest;
+ *  expect every handshake to end with a bad-cookie error.
+ *  Group-signature verification isn't exercised.
+ *
+ * Like the example server, it reads its certificate, key, GPK and basename
+ *  from the working directory.
+ */
+
+#include <xtt/asio.hpp>
+
+#include <sodium.h>
+
+#include <boost/asio.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+    const char *daa_gpk_file = "daa_gpk.bin";
+    const char *basename_file = "basename.bin";
+    const char *server_certificate_file = "server_certificate.bin";
+    const char *server_privatekey_file = "server_privatekey.bin";
+
+    using clock_type = std::chrono::steady_clock;
+
+    // Deterministic replacement for libsodium's RNG
+    unsigned char rng_key[crypto_stream_chacha20_KEYBYTES] = {'x', 't', 't', '_', 'r', 'e', 'p', 'l', 'a', 'y'};
+    std::uint64_t rng_counter = 0;
+
+    void deterministic_buf(void * const buf, const size_t size)
+    {
+        unsigned char nonce[crypto_stream_chacha20_NONCEBYTES];
+        for (std::size_t i = 0; i < sizeof(nonce); ++i)
+            nonce[i] = static_cast<unsigned char>(rng_counter >> (8 * i));
+        ++rng_counter;
+
+        std::memset(buf, 0, size);
+        crypto_stream_chacha20(static_cast<unsigned char*>(buf), size, nonce, rng_key);
+    }
+
+    uint32_t deterministic_random()
+    {
+        uint32_t ret;
+        deterministic_buf(&ret, sizeof(ret));
+        return ret;
+    }
+
+    uint32_t deterministic_uniform(const uint32_t upper_bound)
+    {
+        if (upper_bound < 2)
+            return 0;
+
+        // Reject the values that would bias the result
+        uint32_t min = (1U + ~upper_bound) % upper_bound;
+        uint32_t r;
+        do {
+            r = deterministic_random();
+        } while (r < min);
+
+        return r % upper_bound;
+    }
+
+    const char *deterministic_name() { return "xtt_replay"; }
+    void deterministic_stir() {}
+    int deterministic_close() { return 0; }
+
+    randombytes_implementation deterministic_rng = {
+        deterministic_name,
+        deterministic_random,
+        deterministic_stir,
+        deterministic_uniform,
+        deterministic_buf,
+        deterministic_close
+    };
+
+    using gpk_map_type = std::unordered_map<xtt::group_identity, std::unique_ptr<xtt::group_public_key_context>>;
+
+    struct connection {
+        connection(std::pair<xtt::asio::memory_stream, xtt::asio::memory_stream> ends,
+                   xtt::server_cookie_context& cookie_ctx)
+            : client(std::move(ends.first)),
+              server(std::move(ends.second), cookie_ctx),
+              records(),
+              started(),
+              finished(),
+              ec(),
+              done(false)
+        {
+        }
+
+        xtt::asio::memory_stream client;
+        xtt::asio::basic_server_context<xtt::asio::memory_stream> server;
+
+        std::vector<const xtt::handshake_trace_record*> records;
+
+        clock_type::time_point started;
+        clock_type::time_point finished;
+        boost::system::error_code ec;
+        bool done;
+    };
+
+    int initialize(std::vector<unsigned char>& certificate,
+                   std::vector<unsigned char>& private_key,
+                   gpk_map_type& gpk_map);
+
+    void send_record(connection& conn, const xtt::handshake_trace_record& record);
+
+    double percentile(std::vector<double>& sorted, double p);
+
+}
+
+int main(int argc, char *argv[])
+{
+    bool paced = false;
+    const char *trace_file = nullptr;
+    bool usage_error = false;
+    for (int i = 1; i < argc; ++i) {
+        if (0 == std::strcmp(argv[i], "--paced"))
+            paced = true;
+        else if (!trace_file)
+            trace_file = argv[i];
+        else
+            usage_error = true;
+    }
+    if (!trace_file || usage_error) {
+        std::cerr << "usage: " << argv[0] << " [--paced] <trace file>\n";
+        return 1;
+    }
+
+    // Must precede any use of libsodium
+    randombytes_set_implementation(&deterministic_rng);
+    if (0 != xtt::initialize_crypto()) {
+        std::cerr << "Error initializing cryptography library\n";
+        return 1;
+    }
+
+    auto trace = xtt::read_handshake_trace(trace_file);
+    if (!trace) {
+        std::cerr << "Error reading trace '" << trace_file << "'\n";
+        return 1;
+    }
+
+    std::vector<unsigned char> certificate;
+    std::vector<unsigned char> private_key;
+    gpk_map_type gpk_map;
+    if (0 != initialize(certificate, private_key, gpk_map))
+        return 1;
+
+    boost::system::error_code cert_ec;
+    auto certificates = xtt::asio::make_server_certificate_map(certificate, private_key, cert_ec);
+    if (cert_ec) {
+        std::cerr << "Error deserializing certificate\n";
+        return 1;
+    }
+
+    boost::asio::io_context io_context;
+    xtt::server_cookie_context cookie_ctx;
+    xtt::hash_identity_allocator id_allocator;
+
+    std::map<std::uint32_t, std::unique_ptr<connection>> connections;
+    for (const auto& record : *trace) {
+        auto& conn = connections[record.connection];
+        if (!conn)
+            conn = std::make_unique<connection>(xtt::asio::memory_stream::make_pair(io_context.get_executor()),
+                                                cookie_ctx);
+        conn->records.push_back(&record);
+    }
+
+    auto lookup_gpk = [&gpk_map, &io_context](xtt::group_identity claimed_gid,
+                                              xtt::identity,
+                                              auto&& continuation)
+                      {
+                          auto gpk_it = gpk_map.find(claimed_gid);
+                          boost::asio::post(io_context,
+                                            [continuation, found(gpk_map.end() != gpk_it), gpk_it]()
+                                            {
+                                                if (!found)
+                                                    continuation(xtt::asio::get_unknown_gid_ec(),
+                                                                 std::unique_ptr<xtt::group_public_key_context>());
+                                                else
+                                                    continuation(boost::system::error_code(), gpk_it->second->clone());
+                                            });
+                      };
+
+    auto replay_start = clock_type::now();
+    std::vector<std::unique_ptr<boost::asio::steady_timer>> timers;
+    for (auto& entry : connections) {
+        connection& conn = *entry.second;
+
+        conn.server.load_certificate(certificates);
+        conn.server.async_handle_connect(lookup_gpk,
+                                         xtt::asio::make_assign_id_callback(id_allocator, conn.server),
+                                         xtt::asio::release_identity_on_failure(id_allocator,
+                                                                                conn.server,
+                                                                                [&conn](const boost::system::error_code& ec)
+                                                                                {
+                                                                                    conn.finished = clock_type::now();
+                                                                                    conn.ec = ec;
+                                                                                    conn.done = true;
+                                                                                }));
+
+        if (!paced) {
+            conn.started = replay_start;
+            for (const auto *record : conn.records)
+                send_record(conn, *record);
+            continue;
+        }
+
+        // Each record is sent at its recorded time, relative to the start of the trace
+        conn.started = replay_start + std::chrono::microseconds(conn.records.front()->time_us);
+        for (const auto *record : conn.records) {
+            timers.push_back(std::make_unique<boost::asio::steady_timer>(io_context,
+                                                                         replay_start + std::chrono::microseconds(record->time_us)));
+            timers.back()->async_wait([&conn, record](const boost::system::error_code& ec)
+                                      {
+                                          if (!ec)
+                                              send_record(conn, *record);
+                                      });
+        }
+    }
+
+    // Returns once every server has finished, or is waiting for bytes the trace doesn't have
+    io_context.run();
+    double elapsed_s = std::chrono::duration<double>(clock_type::now() - replay_start).count();
+
+    std::map<std::string, std::size_t> outcomes;
+    std::vector<double> latencies_ms;
+    std::size_t incomplete = 0;
+    for (const auto& entry : connections) {
+        const connection& conn = *entry.second;
+        if (!conn.done) {
+            ++incomplete;
+            continue;
+        }
+
+        ++outcomes[conn.ec ? conn.ec.message() : "success"];
+        latencies_ms.push_back(std::chrono::duration<double, std::milli>(conn.finished - conn.started).count());
+    }
+    std::sort(latencies_ms.begin(), latencies_ms.end());
+
+    std::cout << "Replayed " << connections.size() << " connections (" << trace->size() << " records)"
+              << (paced ? " at recorded pacing" : " at full speed") << " in " << elapsed_s << " s\n";
+    std::cout << "\thandshakes/s:       " << (elapsed_s > 0 ? latencies_ms.size() / elapsed_s : 0) << "\n";
+    std::cout << "\tlatency p50 (ms):   " << percentile(latencies_ms, 0.50) << "\n";
+    std::cout << "\tlatency p99 (ms):   " << percentile(latencies_ms, 0.99) << "\n";
+    std::cout << "\tincomplete:         " << incomplete << "\n";
+    for (const auto& outcome : outcomes)
+        std::cout << "\t" << outcome.first << ": " << outcome.second << "\n";
+}
+
+namespace {
+
+    void send_record(connection& conn, const xtt::handshake_trace_record& record)
+    {
+        // memory_stream copies the data before async_write returns
+        boost::asio::async_write(conn.client,
+                                 boost::asio::buffer(record.data),
+                                 [](const boost::system::error_code&, std::size_t) {});
+    }
+
+    double percentile(std::vector<double>& sorted, double p)
+    {
+        if (sorted.empty())
+            return 0;
+
+        return sorted[static_cast<std::size_t>(p * (sorted.size() - 1))];
+    }
+
+    int initialize(std::vector<unsigned char>& certificate,
+                   std::vector<unsigned char>& private_key,
+                   gpk_map_type& gpk_map)
+    {
+        std::ifstream gpk_file(daa_gpk_file, std::ios::in | std::ios::binary);
+        std::vector<unsigned char> serialized_gpk((std::istreambuf_iterator<char>(gpk_file)), std::istreambuf_iterator<char>());
+
+        std::ifstream bsn_file(basename_file, std::ios::in | std::ios::binary);
+        std::vector<unsigned char> basename((std::istreambuf_iterator<char>(bsn_file)), std::istreambuf_iterator<char>());
+
+        auto gpk = xtt::group_public_key_context_lrsw::from_gpk_and_basename(serialized_gpk, basename);
+        if (!gpk) {
+            std::cerr << "Error deserializing GPK and basename\n";
+            return -1;
+        }
+
+        // GID = SHA-256(GPK), as in the example server
+        std::vector<unsigned char> raw_gid(crypto_hash_sha256_BYTES);
+        std::vector<unsigned char> gpk_serial = gpk->get_gpk();
+        crypto_hash_sha256(raw_gid.data(), gpk_serial.data(), gpk_serial.size());
+        auto gid = xtt::group_identity::deserialize(raw_gid);
+        if (!gid) {
+            std::cerr << "Error computing GID from GPK\n";
+            return -1;
+        }
+        gpk_map[*gid] = std::move(gpk);
+
+        std::ifstream cert_file(server_certificate_file, std::ios::in | std::ios::binary);
+        certificate.assign((std::istreambuf_iterator<char>(cert_file)), std::istreambuf_iterator<char>());
+
+        std::ifstream privkey_file(server_privatekey_file, std::ios::in | std::ios::binary);
+        private_key.assign((std::istreambuf_iterator<char>(privkey_file)), std::istreambuf_iterator<char>());
+
+        return 0;
+    }
+
+}
@@ -23,6 +23,7 @@
 #include <xtt/config.hpp>
 #include <xtt/crypto.hpp>
 #include <xtt/server_handshake_context.hpp>
+#include <xtt/handshake_result.hpp>
 #include <xtt/server_cookie_context.hpp>
 #include <xtt/group_public_key_context.hpp>
 #include <xtt/server_certificate_context.hpp>
@@ -30,6 +31,16 @@
 #include <xtt/group_identity.hpp>
 #include <xtt/longterm_key.hpp>
 #include <xtt/pseudonym.hpp>
+#include <xtt/identity_allocator.hpp>
+#include <xtt/pseudonym_identity_cache.hpp>
 #include <xtt/types.hpp>
+#include <xtt/algorithm.hpp>
+#include <xtt/suite_traits.hpp>
+#include <xtt/record_cipher.hpp>
+#include <xtt/suite_policy.hpp>
+#include <xtt/group_identity_filter.hpp>
+#include <xtt/pseudonym_revocation_list.hpp>
+#include <xtt/handshake_trace.hpp>
+#include <xtt/value_array.hpp>
 
 #endif
@@ -0,0 +1,71 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#ifndef XTT_CPP_ALGORITHM_HPP
+#define XTT_CPP_ALGORITHM_HPP
+#pragma once
+
+#include <xtt/crypto_types.h>
+
+#include <xtt/config.hpp>
+
+namespace xtt {
+
+    /*
+     * Tag types naming the algorithms used by XTT,
+     *  for selecting value types at compile time.
+     */
+    namespace algorithm {
+
+        // Key-exchange schemes
+        struct x25519 {};
+
+        // DAA schemes
+        struct lrsw {};
+
+        // Signature schemes
+        struct ecdsap256 {};
+
+        // AEAD schemes
+        struct chacha20poly1305 {};
+        struct aes256gcm {};
+
+        // Hash functions
+        struct sha512 {};
+        struct blake2b {};
+
+    }   // namespace algorithm
+
+    template <typename Algorithm>
+    struct algorithm_traits;
+
+    template <>
+    struct algorithm_traits<algorithm::lrsw> {
+        using pseudonym_type = xtt_daa_pseudonym_lrsw;
+        using group_public_key_type = xtt_daa_group_pub_key_lrsw;
+    };
+
+    template <>
+    struct algorithm_traits<algorithm::ecdsap256> {
+        using public_key_type = xtt_ecdsap256_pub_key;
+        using private_key_type = xtt_ecdsap256_priv_key;
+    };
+
+}   // namespace xtt
+
+#endif
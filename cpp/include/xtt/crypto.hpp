@@ -23,8 +23,15 @@
 #include <xtt/crypto_wrapper.h>
 #include <xtt/config.hpp>
 
+#include <cstddef>
+
 namespace xtt {
     int initialize_crypto();
+
+    /*
+     * Zero `len` bytes at `ptr`, in a way the compiler won't optimize away.
+     */
+    void secure_zero(void *ptr, std::size_t len);
 }   // namespace xtt
 
 #endif
@@ -28,6 +28,7 @@
 #include <vector>
 #include <functional>
 #include OPTIONAL_H
+#include STRING_VIEW_H
 
 namespace xtt { class group_identity; }
 namespace std {
@@ -52,7 +53,7 @@ namespace xtt {
 
         static
         OPTIONAL_NS::optional<group_identity>
-        deserialize(const std::string& serialized);
+        deserialize(STRING_VIEW_NS::string_view serialized);
 
     public:
         group_identity() = default;
@@ -0,0 +1,70 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#ifndef XTT_CPP_GROUPIDENTITYFILTER_HPP
+#define XTT_CPP_GROUPIDENTITYFILTER_HPP
+#pragma once
+
+#include <xtt/group_identity.hpp>
+
+#include <xtt/config.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace xtt {
+
+    /*
+     * Compact, immutable set of provisioned group IDs (a Bloom filter),
+     *  for rejecting unknown GIDs before looking up their group public key.
+     *
+     * `may_contain` never returns false for a GID the filter was built with,
+     *  and returns true for an unknown GID with probability about 1%.
+     * Positions are derived with a keyed hash (SipHash) whose key is random
+     *  per filter, so clients can't search for GIDs that collide.
+     *
+     * The filter is never modified after construction,
+     *  so it can be read from any number of threads without locking.
+     * To follow changes to the set of groups, build a new filter
+     *  and hand it to new server contexts.
+     */
+    class group_identity_filter {
+    public:
+        static constexpr std::size_t bits_per_entry = 10;
+        static constexpr std::size_t hash_count = 7;
+
+        explicit group_identity_filter(const std::vector<group_identity>& gids);
+
+        bool may_contain(const group_identity& gid) const;
+
+        std::size_t size() const;
+
+    private:
+        template <typename Visitor>
+        void for_each_position(const group_identity& gid, Visitor&& visitor) const;
+
+        std::array<unsigned char, 16> key_;
+        std::vector<std::uint64_t> bits_;
+        std::size_t entries_;
+    };
+
+}   // namespace xtt
+
+#endif
@@ -24,9 +24,13 @@
 #include <xtt/group_identity.hpp>
 
 #include <xtt/config.hpp>
+#include <xtt/algorithm.hpp>
 
 #include <vector>
 #include <memory>
+#include <string>
+#include OPTIONAL_H
+#include STRING_VIEW_H
 
 namespace xtt { class group_public_key_context; }
 namespace xtt {
@@ -106,8 +110,8 @@ namespace xtt {
          */
         static
         std::unique_ptr<group_public_key_context>
-        from_gpk_and_basename(const std::string& gpk,
-                              const std::string& basename);
+        from_gpk_and_basename(STRING_VIEW_NS::string_view gpk,
+                              STRING_VIEW_NS::string_view basename);
 
     public:
         group_public_key_context_lrsw();
@@ -127,10 +131,101 @@ namespace xtt {
         struct xtt_group_public_key_context* get() final;
         const struct xtt_group_public_key_context* get() const final;
 
+    private:
+        struct uninitialized {};
+
+        /*
+         * Leave the context for the caller to initialize,
+         *  so the factories run the C initializer only once.
+         */
+        explicit group_public_key_context_lrsw(uninitialized) noexcept;
+
+        explicit group_public_key_context_lrsw(const xtt_group_public_key_context& gpk_ctx) noexcept;
+
+        template <typename Algorithm>
+        friend class group_public_key_context_value;
+
+    private:
+        xtt_group_public_key_context gpk_ctx_;
+    };
+
+    /*
+     * Group public key context held by value,
+     *  with the DAA algorithm fixed at compile time.
+     *
+     * Unlike `group_public_key_context`, this has no vtable
+     *  and needs no heap allocation,
+     *  so it is trivially copyable and can be stored contiguously.
+     */
+    template <typename Algorithm>
+    class group_public_key_context_value {
+    public:
+        /*
+         * Build from a single byte string,
+         *  in the form (GPK | basename_length (1 byte) | basename).
+         */
+        static
+        OPTIONAL_NS::optional<group_public_key_context_value>
+        deserialize(const unsigned char* serialized, std::size_t serialized_length);
+
+        static
+        OPTIONAL_NS::optional<group_public_key_context_value>
+        deserialize(const std::vector<unsigned char>& serialized);
+
+        /*
+         * Build from two separate byte strings,
+         *  one for the basename and the other for the GPK.
+         */
+        static
+        OPTIONAL_NS::optional<group_public_key_context_value>
+        from_gpk_and_basename(const unsigned char* gpk,
+                              std::size_t gpk_length,
+                              const unsigned char* basename,
+                              std::size_t basename_length);
+
+        static
+        OPTIONAL_NS::optional<group_public_key_context_value>
+        from_gpk_and_basename(const std::vector<unsigned char>& gpk,
+                              const std::vector<unsigned char>& basename);
+
+        /*
+         * Build from two separate ASCII-encoded hexadecimal strings,
+         *  one for the basename and the other for the GPK.
+         */
+        static
+        OPTIONAL_NS::optional<group_public_key_context_value>
+        from_gpk_and_basename(STRING_VIEW_NS::string_view gpk,
+                              STRING_VIEW_NS::string_view basename);
+
+    public:
+        group_public_key_context_value();
+
+        std::unique_ptr<group_public_key_context> clone() const;
+
+        std::vector<unsigned char> serialize() const;
+
+        std::vector<unsigned char> get_gpk() const;
+
+        std::vector<unsigned char> get_basename() const;
+
+        std::string get_gpk_as_text() const;
+
+        std::string get_basename_as_text() const;
+
+        struct xtt_group_public_key_context* get();
+        const struct xtt_group_public_key_context* get() const;
+
+    private:
+        explicit group_public_key_context_value(const xtt_group_public_key_context& gpk_ctx) noexcept;
+
     private:
         xtt_group_public_key_context gpk_ctx_;
     };
 
+    extern template class group_public_key_context_value<algorithm::lrsw>;
+
+    using group_public_key_context_lrsw_value = group_public_key_context_value<algorithm::lrsw>;
+
     std::ostream& operator<<(std::ostream& stream, const xtt::group_public_key_context& gpk_ctx);
 
 }   // namespace xtt
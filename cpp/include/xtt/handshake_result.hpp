@@ -0,0 +1,63 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#ifndef XTT_CPP_HANDSHAKERESULT_HPP
+#define XTT_CPP_HANDSHAKERESULT_HPP
+#pragma once
+
+#include <xtt/crypto_types.h>
+
+#include <xtt/config.hpp>
+#include <xtt/identity.hpp>
+#include <xtt/pseudonym.hpp>
+#include <xtt/longterm_key.hpp>
+#include <xtt/types.hpp>
+
+namespace xtt {
+
+    /*
+     * Everything learned about the client in a successful handshake.
+     *
+     * Filled in once, when the handshake finishes,
+     *  and holds all values inline (no heap allocations).
+     * The `clients_*` accessors return views into this struct,
+     *  so they are only valid while it is.
+     */
+    struct handshake_result {
+        suite_spec suite;
+
+        identity clients_identity;
+
+        xtt_daa_pseudonym_lrsw clients_pseudonym_raw;
+
+        xtt_ecdsap256_pub_key clients_longterm_key_raw;
+
+        pseudonym_view clients_pseudonym() const
+        {
+            return pseudonym_view(clients_pseudonym_raw);
+        }
+
+        longterm_key_view clients_longterm_key() const
+        {
+            return longterm_key_view(clients_longterm_key_raw);
+        }
+    };
+
+}   // namespace xtt
+
+#endif
@@ -0,0 +1,102 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#ifndef XTT_CPP_HANDSHAKETRACE_HPP
+#define XTT_CPP_HANDSHAKETRACE_HPP
+#pragma once
+
+#include <xtt/config.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include OPTIONAL_H
+
+namespace xtt {
+
+    /*
+     * Trace of the bytes clients sent during handshakes, and when,
+     *  for replaying real traffic offline (see benchmarks/xtt_replay.cpp).
+     *
+     * File format (integers are big-endian):
+     *      header:  magic ("XTTTRC01", 8 bytes)
+     *      record:  connection (4 bytes) | time_us (8 bytes) | length (2 bytes) | data (length bytes)
+     *  where `time_us` is microseconds since the trace was created,
+     *  and the records of each connection appear in the order the bytes arrived.
+     */
+    struct handshake_trace_record {
+        std::uint32_t connection;
+        std::uint64_t time_us;
+        std::vector<unsigned char> data;
+    };
+
+    /*
+     * Appends records to a trace file.
+     *
+     * All member functions are safe to call concurrently.
+     */
+    class handshake_trace_writer {
+    public:
+        /*
+         * Create (or truncate) the trace at `path`.
+         *
+         * Returns nullptr if the file can't be created.
+         */
+        static
+        std::unique_ptr<handshake_trace_writer>
+        create(const std::string& path);
+
+    public:
+        handshake_trace_writer(const handshake_trace_writer&) = delete;
+        handshake_trace_writer& operator=(const handshake_trace_writer&) = delete;
+
+        /*
+         * Allocate the number identifying a new connection's records.
+         */
+        std::uint32_t begin_connection();
+
+        void record(std::uint32_t connection, const unsigned char *data, std::size_t length);
+
+        bool flush();
+
+    private:
+        explicit handshake_trace_writer(std::ofstream file);
+
+        std::ofstream file_;
+        std::chrono::steady_clock::time_point start_;
+        std::uint32_t next_connection_;
+        std::mutex mutex_;
+    };
+
+    /*
+     * Read a whole trace.
+     *
+     * Returns an empty optional if the file can't be read or isn't a trace.
+     * A record truncated at the end of the file (e.g. by a crash) is dropped.
+     */
+    OPTIONAL_NS::optional<std::vector<handshake_trace_record>>
+    read_handshake_trace(const std::string& path);
+
+}   // namespace xtt
+
+#endif
@@ -27,6 +27,7 @@
 #include <string>
 #include <vector>
 #include OPTIONAL_H
+#include STRING_VIEW_H
 
 namespace xtt { class identity; }
 namespace std {
@@ -43,6 +44,11 @@ namespace xtt {
     public:
         static const identity null;
 
+        /*
+         * Longest text form of an identity, as written by serialize_to_text.
+         */
+        static constexpr std::size_t max_text_length = 39;
+
     public:
         static
         OPTIONAL_NS::optional<identity>
@@ -52,9 +58,13 @@ namespace xtt {
         OPTIONAL_NS::optional<identity>
         deserialize(const std::vector<unsigned char>& serialized);
 
+        /*
+         * Parse an IPv6 address in text form, without allocating.
+         * Malformed text (including a scope suffix) gives an empty optional.
+         */
         static
         OPTIONAL_NS::optional<identity>
-        deserialize(const std::string& serialized);
+        deserialize(STRING_VIEW_NS::string_view serialized);
 
     public:
         identity();
@@ -65,6 +75,13 @@ namespace xtt {
 
         std::string serialize_to_text() const;
 
+        /*
+         * Write the text form into `out`, which has room for `out_length` chars,
+         *  without allocating or NUL-terminating it.
+         * Returns the number of chars written, or 0 if `out` is too small.
+         */
+        std::size_t serialize_to_text(char* out, std::size_t out_length) const;
+
         bool is_null() const;
 
         bool operator==(const identity& other) const;
@@ -80,6 +97,29 @@ namespace xtt {
 
     std::ostream& operator<<(std::ostream& stream, const xtt::identity& id);
 
+    /*
+     * Write each of `count` identities in text form, followed by `separator`,
+     *  into `out`, which has room for `out_length` chars.
+     * `count * (identity::max_text_length + 1)` chars are always enough.
+     * Returns the number of chars written, or 0 if `out` is too small.
+     */
+    std::size_t format_identities(const identity* identities,
+                                  std::size_t count,
+                                  char* out,
+                                  std::size_t out_length,
+                                  char separator = '\n');
+
+    /*
+     * Parse each of `count` texts into the corresponding entry of `identities`.
+     * Malformed texts leave their identity null,
+     *  and are flagged in `malformed` (if given).
+     * Returns the number of malformed texts.
+     */
+    std::size_t parse_identities(const STRING_VIEW_NS::string_view* texts,
+                                 std::size_t count,
+                                 identity* identities,
+                                 bool* malformed = nullptr);
+
 
 }   // namespace xtt
 
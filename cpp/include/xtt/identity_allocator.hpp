@@ -0,0 +1,176 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#ifndef XTT_CPP_IDENTITYALLOCATOR_HPP
+#define XTT_CPP_IDENTITYALLOCATOR_HPP
+#pragma once
+
+#include <xtt/identity.hpp>
+#include <xtt/group_identity.hpp>
+#include <xtt/pseudonym.hpp>
+
+#include <xtt/config.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+#include OPTIONAL_H
+
+namespace xtt {
+
+    class identity_allocator {
+    public:
+        virtual ~identity_allocator() = default;
+
+        /*
+         * Choose the identity to assign to a client that authenticated
+         *  as a member of `gid` under pseudonym `nym`,
+         *  and which asked for `requested_id` (possibly `identity::null`).
+         *
+         * Returns an empty optional if no identity can be assigned.
+         */
+        virtual
+        OPTIONAL_NS::optional<identity>
+        allocate(const group_identity& gid,
+                 pseudonym_view nym,
+                 const identity& requested_id) = 0;
+
+        /*
+         * Hand back an identity obtained from `allocate`
+         *  that ended up not being used (e.g. the handshake failed).
+         *
+         * The default does nothing.
+         */
+        virtual void release(const identity& id);
+    };
+
+    /*
+     * Assigns id = SHA-256(GID || pseudonym), truncated to the identity length.
+     *
+     * If `honor_requested_id` is set, a client that requested a non-null
+     *  identity is given exactly that identity instead.
+     */
+    class hash_identity_allocator : public identity_allocator {
+    public:
+        explicit hash_identity_allocator(bool honor_requested_id = true);
+
+        OPTIONAL_NS::optional<identity>
+        allocate(const group_identity& gid,
+                 pseudonym_view nym,
+                 const identity& requested_id) final;
+
+    private:
+        bool honor_requested_id_;
+    };
+
+    /*
+     * Assigns identities of the form (prefix | counter),
+     *  where prefix is the first 8 bytes of `prefix`
+     *  and counter is a big-endian 64-bit value.
+     *
+     * Counters are leased in blocks of `block_size` from `lease_block`,
+     *  which must return the first counter of a fresh block
+     *  (or an empty optional if the central counter is unavailable).
+     *
+     * The first block is leased by `create`,
+     *  which returns nullptr if that lease fails.
+     * After that, `lease_block` is called on a background thread
+     *  once half of the current block has been used,
+     *  so a slow central counter doesn't usually block `allocate`.
+     * If a burst uses up the block before the next one has arrived,
+     *  `allocate` waits up to `lease_wait` for it,
+     *  then fails (returns an empty optional).
+     *
+     * Requested identities are ignored.
+     */
+    class sequential_identity_allocator : public identity_allocator {
+    public:
+        using block_source = std::function<OPTIONAL_NS::optional<std::uint64_t>(std::uint64_t block_size)>;
+
+        static
+        std::unique_ptr<sequential_identity_allocator>
+        create(const identity& prefix,
+               std::uint64_t block_size,
+               block_source lease_block,
+               std::chrono::milliseconds lease_wait = std::chrono::milliseconds(100));
+
+        OPTIONAL_NS::optional<identity>
+        allocate(const group_identity& gid,
+                 pseudonym_view nym,
+                 const identity& requested_id) final;
+
+    private:
+        sequential_identity_allocator(const identity& prefix,
+                                      std::uint64_t block_size,
+                                      block_source lease_block,
+                                      std::chrono::milliseconds lease_wait);
+
+        bool take_prefetched_block(std::chrono::milliseconds wait);
+
+        void start_prefetch();
+
+    private:
+        identity prefix_;
+        std::uint64_t block_size_;
+        block_source lease_block_;
+        std::chrono::milliseconds lease_wait_;
+
+        std::mutex mutex_;
+        std::uint64_t next_;
+        std::uint64_t end_;
+
+        // Destroyed first, waiting for any lease still running
+        std::future<OPTIONAL_NS::optional<std::uint64_t>> prefetch_;
+    };
+
+    /*
+     * Hands out identities from a preallocated pool.
+     *
+     * Both `allocate` and `release` are O(1) (on average).
+     * Identities currently handed out are tracked,
+     *  so `release` ignores an identity that isn't one of them
+     *  (one that never came from this pool, or that was already released).
+     * Requested identities are ignored.
+     */
+    class pooled_identity_allocator : public identity_allocator {
+    public:
+        explicit pooled_identity_allocator(std::vector<identity> pool);
+
+        OPTIONAL_NS::optional<identity>
+        allocate(const group_identity& gid,
+                 pseudonym_view nym,
+                 const identity& requested_id) final;
+
+        void release(const identity& id) final;
+
+        std::size_t available() const;
+
+    private:
+        mutable std::mutex mutex_;
+        std::vector<identity> free_;
+        std::unordered_set<identity> leased_;
+    };
+
+}   // namespace xtt
+
+#endif
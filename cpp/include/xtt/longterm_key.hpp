@@ -23,10 +23,13 @@
 #include <xtt/crypto_types.h>
 
 #include <xtt/config.hpp>
+#include <xtt/algorithm.hpp>
 
 #include <string>
 #include <vector>
 #include <memory>
+#include OPTIONAL_H
+#include STRING_VIEW_H
 
 namespace xtt { class longterm_key; }
 
@@ -64,7 +67,7 @@ namespace xtt {
 
         static
         std::unique_ptr<longterm_key>
-        deserialize(const std::string& serialized);
+        deserialize(STRING_VIEW_NS::string_view serialized);
 
     public:
         longterm_key_ecdsap256() = default;
@@ -116,7 +119,7 @@ namespace xtt {
 
         static
         std::unique_ptr<longterm_private_key>
-        deserialize(const std::string& serialized);
+        deserialize(STRING_VIEW_NS::string_view serialized);
 
     public:
         longterm_private_key_ecdsap256() = default;
@@ -136,8 +139,152 @@ namespace xtt {
         xtt_ecdsap256_priv_key raw_;
     };
 
+    /*
+     * Non-owning reference to the raw bytes of a longterm public key.
+     *
+     * Trivially copyable; the referenced bytes must outlive the view.
+     * Use `clone()` to get an owning copy.
+     */
+    class longterm_key_view {
+    public:
+        longterm_key_view(const xtt_ecdsap256_pub_key& raw)
+            : raw_(&raw)
+        {
+        }
+
+        longterm_key_view(const longterm_key& key)
+            : raw_(key.get())
+        {
+        }
+
+        std::size_t length() const
+        {
+            return sizeof(xtt_ecdsap256_pub_key);
+        }
+
+        const unsigned char* data() const
+        {
+            return raw_->data;
+        }
+
+        const xtt_ecdsap256_pub_key* get() const
+        {
+            return raw_;
+        }
+
+        std::unique_ptr<longterm_key> clone() const;
+
+        std::vector<unsigned char> serialize() const;
+
+        std::string serialize_to_text() const;
+
+        bool operator==(const longterm_key_view& other) const;
+
+        bool operator!=(const longterm_key_view& other) const;
+
+    private:
+        const xtt_ecdsap256_pub_key* raw_;
+    };
+
+    /*
+     * Longterm public key held by value, with the algorithm fixed at compile time.
+     *
+     * Unlike `longterm_key`, this has no vtable and needs no heap allocation,
+     *  so it is trivially copyable and can be stored contiguously.
+     */
+    template <typename Algorithm>
+    class longterm_key_value {
+    public:
+        using raw_type = typename algorithm_traits<Algorithm>::public_key_type;
+
+        static
+        OPTIONAL_NS::optional<longterm_key_value>
+        deserialize(const unsigned char* serialized, std::size_t serialized_length);
+
+        static
+        OPTIONAL_NS::optional<longterm_key_value>
+        deserialize(const std::vector<unsigned char>& serialized);
+
+        static
+        OPTIONAL_NS::optional<longterm_key_value>
+        deserialize(STRING_VIEW_NS::string_view serialized);
+
+    public:
+        longterm_key_value() = default;
+
+        std::size_t length() const;
+
+        std::unique_ptr<longterm_key> clone() const;
+
+        std::vector<unsigned char> serialize() const;
+
+        std::string serialize_to_text() const;
+
+        const raw_type* get() const;
+        raw_type* get();
+
+        operator longterm_key_view() const;
+
+        bool operator==(const longterm_key_value& other) const;
+
+        bool operator!=(const longterm_key_value& other) const;
+
+    private:
+        raw_type raw_;
+    };
+
+    /*
+     * Longterm private key held by value, with the algorithm fixed at compile time.
+     */
+    template <typename Algorithm>
+    class longterm_private_key_value {
+    public:
+        using raw_type = typename algorithm_traits<Algorithm>::private_key_type;
+
+        static
+        OPTIONAL_NS::optional<longterm_private_key_value>
+        deserialize(const unsigned char* serialized, std::size_t serialized_length);
+
+        static
+        OPTIONAL_NS::optional<longterm_private_key_value>
+        deserialize(const std::vector<unsigned char>& serialized);
+
+        static
+        OPTIONAL_NS::optional<longterm_private_key_value>
+        deserialize(STRING_VIEW_NS::string_view serialized);
+
+    public:
+        longterm_private_key_value() = default;
+
+        std::size_t length() const;
+
+        std::unique_ptr<longterm_private_key> clone() const;
+
+        std::vector<unsigned char> serialize() const;
+
+        std::string serialize_to_text() const;
+
+        const raw_type* get() const;
+        raw_type* get();
+
+        bool operator==(const longterm_private_key_value& other) const;
+
+        bool operator!=(const longterm_private_key_value& other) const;
+
+    private:
+        raw_type raw_;
+    };
+
+    extern template class longterm_key_value<algorithm::ecdsap256>;
+    extern template class longterm_private_key_value<algorithm::ecdsap256>;
+
+    using longterm_key_ecdsap256_value = longterm_key_value<algorithm::ecdsap256>;
+    using longterm_private_key_ecdsap256_value = longterm_private_key_value<algorithm::ecdsap256>;
+
     std::ostream& operator<<(std::ostream& stream, const xtt::longterm_key& key);
 
+    std::ostream& operator<<(std::ostream& stream, const xtt::longterm_key_view& key);
+
 }   // namespace xtt
 
 #endif
@@ -23,10 +23,13 @@
 #include <xtt/crypto_types.h>
 
 #include <xtt/config.hpp>
+#include <xtt/algorithm.hpp>
 
 #include <string>
 #include <vector>
 #include <memory>
+#include OPTIONAL_H
+#include STRING_VIEW_H
 
 namespace xtt { class pseudonym; }
 
@@ -64,7 +67,7 @@ namespace xtt {
 
         static
         std::unique_ptr<pseudonym>
-        deserialize(const std::string& serialized);
+        deserialize(STRING_VIEW_NS::string_view serialized);
 
     public:
         pseudonym_lrsw() = default;
@@ -84,8 +87,108 @@ namespace xtt {
         xtt_daa_pseudonym_lrsw raw_;
     };
 
+    /*
+     * Non-owning reference to the raw bytes of a pseudonym.
+     *
+     * Trivially copyable; the referenced bytes must outlive the view.
+     * Use `clone()` to get an owning copy.
+     */
+    class pseudonym_view {
+    public:
+        pseudonym_view(const xtt_daa_pseudonym_lrsw& raw)
+            : raw_(&raw)
+        {
+        }
+
+        pseudonym_view(const pseudonym& pseud)
+            : raw_(pseud.get())
+        {
+        }
+
+        std::size_t length() const
+        {
+            return sizeof(xtt_daa_pseudonym_lrsw);
+        }
+
+        const unsigned char* data() const
+        {
+            return raw_->data;
+        }
+
+        const xtt_daa_pseudonym_lrsw* get() const
+        {
+            return raw_;
+        }
+
+        std::unique_ptr<pseudonym> clone() const;
+
+        std::vector<unsigned char> serialize() const;
+
+        std::string serialize_to_text() const;
+
+        bool operator==(const pseudonym_view& other) const;
+
+        bool operator!=(const pseudonym_view& other) const;
+
+    private:
+        const xtt_daa_pseudonym_lrsw* raw_;
+    };
+
+    /*
+     * Pseudonym held by value, with the algorithm fixed at compile time.
+     *
+     * Unlike `pseudonym`, this has no vtable and needs no heap allocation,
+     *  so it is trivially copyable and can be stored contiguously.
+     */
+    template <typename Algorithm>
+    class pseudonym_value {
+    public:
+        using raw_type = typename algorithm_traits<Algorithm>::pseudonym_type;
+
+        static
+        OPTIONAL_NS::optional<pseudonym_value>
+        deserialize(const unsigned char* serialized, std::size_t serialized_length);
+
+        static
+        OPTIONAL_NS::optional<pseudonym_value>
+        deserialize(const std::vector<unsigned char>& serialized);
+
+        static
+        OPTIONAL_NS::optional<pseudonym_value>
+        deserialize(STRING_VIEW_NS::string_view serialized);
+
+    public:
+        pseudonym_value() = default;
+
+        std::size_t length() const;
+
+        std::unique_ptr<pseudonym> clone() const;
+
+        std::vector<unsigned char> serialize() const;
+
+        std::string serialize_to_text() const;
+
+        const raw_type* get() const;
+        raw_type* get();
+
+        operator pseudonym_view() const;
+
+        bool operator==(const pseudonym_value& other) const;
+
+        bool operator!=(const pseudonym_value& other) const;
+
+    private:
+        raw_type raw_;
+    };
+
+    extern template class pseudonym_value<algorithm::lrsw>;
+
+    using pseudonym_lrsw_value = pseudonym_value<algorithm::lrsw>;
+
     std::ostream& operator<<(std::ostream& stream, const xtt::pseudonym& pseud);
 
+    std::ostream& operator<<(std::ostream& stream, const xtt::pseudonym_view& pseud);
+
 }   // namespace xtt
 
 #endif
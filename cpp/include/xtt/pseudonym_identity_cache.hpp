@@ -0,0 +1,183 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#ifndef XTT_CPP_PSEUDONYMIDENTITYCACHE_HPP
+#define XTT_CPP_PSEUDONYMIDENTITYCACHE_HPP
+#pragma once
+
+#include <xtt/crypto_types.h>
+
+#include <xtt/config.hpp>
+#include <xtt/identity.hpp>
+#include <xtt/pseudonym.hpp>
+#include <xtt/identity_allocator.hpp>
+
+#include <array>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include OPTIONAL_H
+
+namespace xtt {
+
+    /*
+     * Persistent map from a client's DAA pseudonym to the identity it was assigned.
+     *
+     * Backed by an append-only, memory-mapped log of fixed-width records:
+     *      header:  magic ("XTTPNYM1", 8 bytes) | record_length (4 bytes, big-endian) | reserved (4 bytes)
+     *      record:  flag (1 byte) | pseudonym | identity | checksum (4 bytes, big-endian)
+     *  where flag is `live` for an assignment and `erased` for a tombstone.
+     *  A zero flag marks the end of the log.
+     *
+     * Updates append a record, so the log is compacted (rewritten with only
+     *  the live assignments) once more than half of it is dead.
+     * That compaction runs on a background thread, so `insert` and `erase`
+     *  don't wait on it.
+     *
+     * All member functions are safe to call concurrently.
+     */
+    class pseudonym_identity_cache {
+    public:
+        static constexpr std::size_t pseudonym_length = sizeof(xtt_daa_pseudonym_lrsw);
+        static constexpr std::size_t record_length = 1 + pseudonym_length + sizeof(xtt_identity_type) + 4;
+
+        /*
+         * Open (or create) the log at `path`, and load its contents.
+         *
+         * Returns nullptr if the file can't be opened or isn't a valid log.
+         */
+        static
+        std::unique_ptr<pseudonym_identity_cache>
+        open(const std::string& path);
+
+    public:
+        pseudonym_identity_cache(const pseudonym_identity_cache&) = delete;
+        pseudonym_identity_cache& operator=(const pseudonym_identity_cache&) = delete;
+
+        ~pseudonym_identity_cache();
+
+        OPTIONAL_NS::optional<identity> find(pseudonym_view nym) const;
+
+        /*
+         * Record (or replace) the identity assigned to `nym`.
+         */
+        bool insert(pseudonym_view nym, const identity& id);
+
+        /*
+         * Record `id` for `nym`, unless `nym` already has an identity.
+         *
+         * Returns the identity `nym` now has (the existing one, if any),
+         *  or an empty optional on I/O error.
+         */
+        OPTIONAL_NS::optional<identity> try_insert(pseudonym_view nym, const identity& id);
+
+        /*
+         * Forget the identity assigned to `nym`.
+         *
+         * Returns false if `nym` wasn't present, or on I/O error.
+         */
+        bool erase(pseudonym_view nym);
+
+        std::size_t size() const;
+
+        /*
+         * Rewrite the log so it contains only live assignments.
+         *
+         * A snapshot of the live assignments is written and synced to a new file
+         *  without blocking other calls, which are only held up while
+         *  the records appended meanwhile are copied over and the files are swapped.
+         */
+        bool compact();
+
+        /*
+         * Synchronously write the log out to stable storage.
+         */
+        bool flush();
+
+    private:
+        using key_type = std::array<unsigned char, pseudonym_length>;
+
+        struct key_hash {
+            std::size_t operator()(const key_type& key) const
+            {
+                // Pseudonyms are curve points, so skip the leading point-format byte
+                // and use the (uniformly-distributed) coordinate bytes directly.
+                std::size_t ret;
+                std::memcpy(&ret, key.data() + 1, sizeof(ret));
+                return ret;
+            }
+        };
+
+        pseudonym_identity_cache(std::string path, int fd);
+
+        bool map_file();
+        void unmap_file();
+        bool load();
+
+        // These expect mutex_ to already be held
+        bool append_record(unsigned char flag, const key_type& key, const identity& id);
+        void maybe_compact();
+
+    private:
+        std::string path_;
+        int fd_;
+        unsigned char* map_;
+        std::size_t map_length_;
+        std::size_t tail_;
+        std::size_t dead_records_;
+
+        std::unordered_map<key_type, identity, key_hash> index_;
+        mutable std::mutex mutex_;
+
+        // Held for the whole of a compaction, so only one runs at a time
+        std::mutex compact_mutex_;
+        std::future<void> background_compaction_;
+    };
+
+    /*
+     * Identity allocator that returns the identity previously assigned
+     *  to a pseudonym (if any), and otherwise delegates to `inner`
+     *  and remembers its answer in `cache`.
+     *
+     * Requested identities are only seen by `inner`.
+     * If concurrent handshakes for the same pseudonym both miss the cache,
+     *  only the first identity cached is used, and the others are released to `inner`.
+     * Once cached, an identity stays reserved for its pseudonym,
+     *  so `release` never hands it back to `inner`.
+     */
+    class caching_identity_allocator : public identity_allocator {
+    public:
+        caching_identity_allocator(identity_allocator& inner,
+                                   pseudonym_identity_cache& cache);
+
+        OPTIONAL_NS::optional<identity>
+        allocate(const group_identity& gid,
+                 pseudonym_view nym,
+                 const identity& requested_id) final;
+
+    private:
+        identity_allocator& inner_;
+        pseudonym_identity_cache& cache_;
+    };
+
+}   // namespace xtt
+
+#endif
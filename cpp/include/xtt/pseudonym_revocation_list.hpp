@@ -0,0 +1,93 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#ifndef XTT_CPP_PSEUDONYMREVOCATIONLIST_HPP
+#define XTT_CPP_PSEUDONYMREVOCATIONLIST_HPP
+#pragma once
+
+#include <xtt/pseudonym.hpp>
+
+#include <xtt/config.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace xtt {
+
+    /*
+     * Set of revoked DAA pseudonyms, checked during the handshake.
+     *
+     * Stored as a sorted array of 16-byte BLAKE2b digests of the pseudonyms,
+     *  and searched with a binary search.
+     *
+     * `assign` builds a new array and publishes it with an atomic pointer swap,
+     *  so lookups always see either the old or the new set.
+     *  Lookups take no lock: each only increments and decrements an atomic reader count.
+     *  `assign` waits for lookups that may still be reading the old array before freeing it,
+     *  and concurrent calls to `assign` are serialized.
+     */
+    class pseudonym_revocation_list {
+    public:
+        static constexpr std::size_t digest_length = 16;
+
+        pseudonym_revocation_list();
+
+        explicit pseudonym_revocation_list(const std::vector<pseudonym_lrsw_value>& revoked);
+
+        ~pseudonym_revocation_list();
+
+        pseudonym_revocation_list(const pseudonym_revocation_list&) = delete;
+        pseudonym_revocation_list& operator=(const pseudonym_revocation_list&) = delete;
+
+        /*
+         * Replace the whole set.
+         */
+        void assign(const std::vector<pseudonym_lrsw_value>& revoked);
+
+        bool is_revoked(pseudonym_view nym) const;
+
+        std::size_t size() const;
+
+    private:
+        using digest = std::array<unsigned char, digest_length>;
+
+        static digest make_digest(pseudonym_view nym);
+
+        // Returns the reader slot to pass to `leave`
+        unsigned enter() const;
+        void leave(unsigned slot) const;
+
+        // Returns once no lookup that started before now is still running
+        void wait_for_readers();
+
+        std::atomic<const std::vector<digest>*> digests_;
+
+        // Lookups count themselves in the slot of the current epoch,
+        //  so `wait_for_readers` can wait out each slot in turn while new lookups use the other.
+        mutable std::atomic<unsigned> epoch_;
+        mutable std::atomic<std::size_t> readers_[2];
+
+        std::mutex assign_mutex_;
+    };
+
+}   // namespace xtt
+
+#endif
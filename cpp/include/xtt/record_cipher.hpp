@@ -0,0 +1,138 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#ifndef XTT_CPP_RECORDCIPHER_HPP
+#define XTT_CPP_RECORDCIPHER_HPP
+#pragma once
+
+#include <xtt/types.hpp>
+
+#include <xtt/config.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include OPTIONAL_H
+
+namespace xtt {
+
+    /*
+     * Key material for one direction of a record channel.
+     *
+     * libxtt does not export the traffic secrets it derives during a handshake,
+     *  so these must come from the application.
+     *
+     * Nonces restart from `iv` with every new cipher, so keys MUST NOT be reused
+     *  across connections as they are: either make them unique to each connection,
+     *  or have a fresh random salt mixed into them for each connection
+     *  (see `record_cipher::mix_salt`, which `asio::stream` does for every stream).
+     * The two directions of a channel MUST use different keys.
+     */
+    struct record_keys {
+        std::array<unsigned char, 32> key;
+        std::array<unsigned char, 12> iv;
+    };
+
+    /*
+     * Protects one direction of records with the AEAD named by a suite_spec
+     *  (ChaCha20-Poly1305 or AES-256-GCM).
+     *
+     * The nonce for each record is `iv` XOR a 64-bit sequence number,
+     *  which advances after every successful `seal` or `open`,
+     *  so records must be opened in the order they were sealed.
+     *
+     * Encryption and decryption are done in place.
+     * The key is wiped when the cipher is destroyed.
+     */
+    class record_cipher {
+    public:
+        static constexpr std::size_t tag_length = 16;
+
+        /*
+         * Returns an empty optional if `suite` is unknown,
+         *  or if its AEAD is not supported on this CPU
+         *  (libsodium's AES-256-GCM requires AES-NI).
+         */
+        static
+        OPTIONAL_NS::optional<record_cipher>
+        from_keys(suite_spec suite, const record_keys& keys);
+
+        record_cipher(record_cipher&& other) noexcept;
+        record_cipher& operator=(record_cipher&& other) noexcept;
+
+        record_cipher(const record_cipher&) = delete;
+        record_cipher& operator=(const record_cipher&) = delete;
+
+        ~record_cipher();
+
+        suite_spec get_suite_spec() const;
+
+        std::uint64_t get_sequence_number() const;
+
+        /*
+         * Replace the key and IV with ones derived from them and `salt`,
+         *  and restart the sequence number.
+         *
+         * Both ends of the direction must mix in the same salt.
+         * With a fresh random salt for each connection,
+         *  long-lived keys then never repeat a key and nonce.
+         */
+        void mix_salt(const unsigned char *salt, std::size_t salt_length);
+
+        /*
+         * Whether this cipher and `other` use the same key,
+         *  in which case they must not protect the two directions of one channel.
+         */
+        bool shares_key_with(const record_cipher& other) const;
+
+        /*
+         * Encrypt `length` bytes at `data` in place,
+         *  authenticating them and `ad`, and write the tag to `tag`.
+         */
+        bool seal(unsigned char *data,
+                  std::size_t length,
+                  const unsigned char *ad,
+                  std::size_t ad_length,
+                  unsigned char *tag);
+
+        /*
+         * Verify and decrypt `length` bytes at `data` in place.
+         *
+         * Returns false, without advancing the sequence number,
+         *  if the record fails authentication
+         *  (in which case the contents of `data` are unspecified).
+         */
+        bool open(unsigned char *data,
+                  std::size_t length,
+                  const unsigned char *ad,
+                  std::size_t ad_length,
+                  const unsigned char *tag);
+
+    private:
+        record_cipher(suite_spec suite, const record_keys& keys);
+
+        void make_nonce(unsigned char *nonce) const;
+
+        suite_spec suite_;
+        record_keys keys_;
+        std::uint64_t sequence_number_;
+    };
+
+}   // namespace xtt
+
+#endif
@@ -23,11 +23,14 @@
 #include <xtt/context.h>
 
 #include <xtt/config.hpp>
+#include <xtt/algorithm.hpp>
 
 #include <vector>
 #include <string>
 #include <utility>
 #include <memory>
+#include OPTIONAL_H
+#include STRING_VIEW_H
 
 namespace xtt { class server_certificate_context_ecdsap256; }
 void swap(xtt::server_certificate_context_ecdsap256&, xtt::server_certificate_context_ecdsap256&);
@@ -92,6 +95,13 @@ namespace xtt {
          */
         static
         std::unique_ptr<server_certificate_context>
+        from_certificate_and_key(const unsigned char* certificate,
+                                 std::size_t certificate_length,
+                                 const unsigned char* private_key,
+                                 std::size_t private_key_length);
+
+        static
+        std::unique_ptr<server_certificate_context>
         from_certificate_and_key(const std::vector<unsigned char>& certificate,
                                  const std::vector<unsigned char>& private_key);
 
@@ -102,17 +112,17 @@ namespace xtt {
          */
         static
         std::unique_ptr<server_certificate_context>
-        from_certificate_and_key(const std::string& certificate,
-                                 const std::string& private_key);
+        from_certificate_and_key(STRING_VIEW_NS::string_view certificate,
+                                 STRING_VIEW_NS::string_view private_key);
 
     public:
         server_certificate_context_ecdsap256();
 
-        server_certificate_context_ecdsap256(const server_certificate_context_ecdsap256&);
+        server_certificate_context_ecdsap256(const server_certificate_context_ecdsap256&) noexcept;
 
-        server_certificate_context_ecdsap256(server_certificate_context_ecdsap256&& other);
+        server_certificate_context_ecdsap256(server_certificate_context_ecdsap256&& other) noexcept;
 
-        server_certificate_context_ecdsap256& operator=(server_certificate_context_ecdsap256 other);
+        server_certificate_context_ecdsap256& operator=(server_certificate_context_ecdsap256 other) noexcept;
 
         std::unique_ptr<server_certificate_context> clone() const final;
 
@@ -131,10 +141,106 @@ namespace xtt {
 
         friend void ::swap(server_certificate_context_ecdsap256& first, server_certificate_context_ecdsap256& second);
 
+    private:
+        struct uninitialized {};
+
+        /*
+         * Leave the context for the caller to initialize,
+         *  so the factories run the C initializer only once.
+         */
+        explicit server_certificate_context_ecdsap256(uninitialized) noexcept;
+
+        explicit server_certificate_context_ecdsap256(const xtt_server_certificate_context& certificate_ctx) noexcept;
+
+        template <typename Algorithm>
+        friend class server_certificate_context_value;
+
     private:
         xtt_server_certificate_context certificate_ctx_;
     };
 
+    /*
+     * Server certificate context held by value,
+     *  with the signature algorithm fixed at compile time.
+     *
+     * Unlike `server_certificate_context`, this has no vtable
+     *  and needs no heap allocation.
+     * The underlying context points into itself,
+     *  so copies re-point it, but never allocate or throw.
+     */
+    template <typename Algorithm>
+    class server_certificate_context_value {
+    public:
+        /*
+         * Build from a single byte string,
+         *  in the form (certificate | private_key).
+         */
+        static
+        OPTIONAL_NS::optional<server_certificate_context_value>
+        deserialize(const unsigned char* serialized, std::size_t serialized_length);
+
+        static
+        OPTIONAL_NS::optional<server_certificate_context_value>
+        deserialize(const std::vector<unsigned char>& serialized);
+
+        /*
+         * Build from two separate byte strings,
+         *  one for the certificate and the other for the private_key.
+         */
+        static
+        OPTIONAL_NS::optional<server_certificate_context_value>
+        from_certificate_and_key(const unsigned char* certificate,
+                                 std::size_t certificate_length,
+                                 const unsigned char* private_key,
+                                 std::size_t private_key_length);
+
+        static
+        OPTIONAL_NS::optional<server_certificate_context_value>
+        from_certificate_and_key(const std::vector<unsigned char>& certificate,
+                                 const std::vector<unsigned char>& private_key);
+
+        /*
+         * Build from two separate ASCII-encoded hexadecimal strings,
+         *  one for the certificate and the other for the private_key.
+         */
+        static
+        OPTIONAL_NS::optional<server_certificate_context_value>
+        from_certificate_and_key(STRING_VIEW_NS::string_view certificate,
+                                 STRING_VIEW_NS::string_view private_key);
+
+    public:
+        server_certificate_context_value();
+
+        server_certificate_context_value(const server_certificate_context_value& other) noexcept;
+
+        server_certificate_context_value& operator=(const server_certificate_context_value& other) noexcept;
+
+        std::unique_ptr<server_certificate_context> clone() const;
+
+        std::vector<unsigned char> serialize() const;
+
+        std::vector<unsigned char> get_certificate() const;
+
+        std::vector<unsigned char> get_private_key() const;
+
+        std::string get_certificate_as_text() const;
+
+        std::string get_private_key_as_text() const;
+
+        struct xtt_server_certificate_context* get();
+        const struct xtt_server_certificate_context* get() const;
+
+    private:
+        explicit server_certificate_context_value(const xtt_server_certificate_context& certificate_ctx) noexcept;
+
+    private:
+        xtt_server_certificate_context certificate_ctx_;
+    };
+
+    extern template class server_certificate_context_value<algorithm::ecdsap256>;
+
+    using server_certificate_context_ecdsap256_value = server_certificate_context_value<algorithm::ecdsap256>;
+
 }   // namespace xtt
 
 #endif
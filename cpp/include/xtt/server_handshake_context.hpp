@@ -29,6 +29,7 @@
 #include <xtt/identity.hpp>
 #include <xtt/group_identity.hpp>
 #include <xtt/group_public_key_context.hpp>
+#include <xtt/handshake_result.hpp>
 #include <xtt/types.hpp>
 #include <xtt/server_certificate_context.hpp>
 #include <xtt/server_cookie_context.hpp>
@@ -59,10 +60,39 @@ namespace xtt {
 
         std::unique_ptr<pseudonym> get_clients_pseudonym() const;
 
+        /*
+         * Copy the client's pseudonym into `out`, without allocating.
+         *
+         * Available once the client's group signature has been verified.
+         */
+        bool get_clients_pseudonym(pseudonym_lrsw& out) const;
+
+        /*
+         * As above, for the pseudonym type of the negotiated suite's DAA algorithm.
+         *
+         * Fails if that isn't `Algorithm` (see `suite_traits`).
+         */
+        template <typename Algorithm>
+        bool get_clients_pseudonym(pseudonym_value<Algorithm>& out) const;
+
         std::unique_ptr<longterm_key> get_clients_longterm_key() const;
 
         OPTIONAL_NS::optional<identity> get_clients_identity() const;
 
+        /*
+         * Collect everything learned about the client, in one pass.
+         *
+         * Only available once the handshake has finished.
+         */
+        OPTIONAL_NS::optional<handshake_result> get_handshake_result() const;
+
+        /*
+         * Securely erase the handshake state (ephemeral keys, transcript, ...).
+         *
+         * Afterwards, only destruction is valid.
+         */
+        void wipe();
+
         const struct xtt_server_handshake_context* get() const;
         struct xtt_server_handshake_context* get();
 
@@ -83,7 +113,7 @@ namespace xtt {
                                             const server_certificate_context& certificate_ctx);
 
         return_code verify_groupsignature(io_buffer& io_buf,
-                                          group_public_key_context& group_pub_key_ctx,
+                                          const group_public_key_context& group_pub_key_ctx,
                                           const server_certificate_context& certificate_ctx);
 
         return_code build_idserverfinished(io_buffer& io_buf,
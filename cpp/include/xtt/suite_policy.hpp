@@ -0,0 +1,81 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#ifndef XTT_CPP_SUITEPOLICY_HPP
+#define XTT_CPP_SUITEPOLICY_HPP
+#pragma once
+
+#include <xtt/types.hpp>
+
+#include <xtt/config.hpp>
+
+#include <vector>
+#include OPTIONAL_H
+
+namespace xtt {
+
+    /*
+     * Which suites a server accepts, and in what order it prefers them.
+     *
+     * In XTT the client chooses the suite,
+     *  so a server can only enforce this by rejecting disallowed suites;
+     *  the preference order is for advertising to clients out-of-band
+     *  (e.g. in provisioning configuration), via `choose`.
+     */
+    class suite_policy {
+    public:
+        /*
+         * Allow every known suite, in `all_suites` order.
+         */
+        suite_policy();
+
+        /*
+         * Allow exactly `preference_order`, most preferred first.
+         *
+         * Unknown and duplicate suites are ignored.
+         */
+        explicit suite_policy(const std::vector<suite_spec>& preference_order);
+
+        /*
+         * Prefer the suites that are cheapest on this CPU.
+         *
+         * With AES-NI, AES-256-GCM suites are preferred over ChaCha20-Poly1305.
+         * Without it, AES-256-GCM suites are disallowed,
+         *  since libsodium only implements them using AES-NI.
+         *
+         * Initializes libsodium, if that hasn't been done yet, to detect the CPU's features.
+         */
+        static suite_policy from_cpu_features();
+
+        bool is_allowed(suite_spec suite) const;
+
+        const std::vector<suite_spec>& get_preference_order() const;
+
+        /*
+         * The most preferred of `offered` that is allowed,
+         *  or an empty optional if none are.
+         */
+        OPTIONAL_NS::optional<suite_spec> choose(const std::vector<suite_spec>& offered) const;
+
+    private:
+        std::vector<suite_spec> preference_order_;
+    };
+
+}   // namespace xtt
+
+#endif
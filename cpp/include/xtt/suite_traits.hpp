@@ -0,0 +1,174 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#ifndef XTT_CPP_SUITETRAITS_HPP
+#define XTT_CPP_SUITETRAITS_HPP
+#pragma once
+
+#include <xtt/algorithm.hpp>
+#include <xtt/types.hpp>
+
+#include <xtt/config.hpp>
+
+#include <utility>
+
+namespace xtt {
+
+    /*
+     * Compile-time description of a suite_spec.
+     *
+     * Each specialization names the algorithm tag (see algorithm.hpp)
+     *  used for each primitive of the suite.
+     *
+     * To add a suite, add a specialization here and list it in `all_suites`.
+     */
+    template <suite_spec Suite>
+    struct suite_traits;
+
+    template <suite_spec Suite,
+              typename KeyExchange,
+              typename DAA,
+              typename Signature,
+              typename AEAD,
+              typename Hash>
+    struct basic_suite_traits {
+        static constexpr suite_spec value = Suite;
+
+        using key_exchange = KeyExchange;
+        using daa = DAA;
+        using signature = Signature;
+        using aead = AEAD;
+        using hash = Hash;
+    };
+
+    template <suite_spec Suite,
+              typename KeyExchange,
+              typename DAA,
+              typename Signature,
+              typename AEAD,
+              typename Hash>
+    constexpr suite_spec basic_suite_traits<Suite, KeyExchange, DAA, Signature, AEAD, Hash>::value;
+
+    template <>
+    struct suite_traits<suite_spec::X25519_LRSW_ECDSAP256_CHACHA20POLY1305_SHA512>
+        : basic_suite_traits<suite_spec::X25519_LRSW_ECDSAP256_CHACHA20POLY1305_SHA512,
+                             algorithm::x25519,
+                             algorithm::lrsw,
+                             algorithm::ecdsap256,
+                             algorithm::chacha20poly1305,
+                             algorithm::sha512>
+    {};
+
+    template <>
+    struct suite_traits<suite_spec::X25519_LRSW_ECDSAP256_CHACHA20POLY1305_BLAKE2B>
+        : basic_suite_traits<suite_spec::X25519_LRSW_ECDSAP256_CHACHA20POLY1305_BLAKE2B,
+                             algorithm::x25519,
+                             algorithm::lrsw,
+                             algorithm::ecdsap256,
+                             algorithm::chacha20poly1305,
+                             algorithm::blake2b>
+    {};
+
+    template <>
+    struct suite_traits<suite_spec::X25519_LRSW_ECDSAP256_AES256GCM_SHA512>
+        : basic_suite_traits<suite_spec::X25519_LRSW_ECDSAP256_AES256GCM_SHA512,
+                             algorithm::x25519,
+                             algorithm::lrsw,
+                             algorithm::ecdsap256,
+                             algorithm::aes256gcm,
+                             algorithm::sha512>
+    {};
+
+    template <>
+    struct suite_traits<suite_spec::X25519_LRSW_ECDSAP256_AES256GCM_BLAKE2B>
+        : basic_suite_traits<suite_spec::X25519_LRSW_ECDSAP256_AES256GCM_BLAKE2B,
+                             algorithm::x25519,
+                             algorithm::lrsw,
+                             algorithm::ecdsap256,
+                             algorithm::aes256gcm,
+                             algorithm::blake2b>
+    {};
+
+    template <suite_spec... Suites>
+    struct suite_list {};
+
+    using all_suites = suite_list<suite_spec::X25519_LRSW_ECDSAP256_CHACHA20POLY1305_SHA512,
+                                  suite_spec::X25519_LRSW_ECDSAP256_CHACHA20POLY1305_BLAKE2B,
+                                  suite_spec::X25519_LRSW_ECDSAP256_AES256GCM_SHA512,
+                                  suite_spec::X25519_LRSW_ECDSAP256_AES256GCM_BLAKE2B>;
+
+    namespace detail {
+
+        template <typename Visitor>
+        using visit_result_t = decltype(std::declval<Visitor>()(suite_traits<suite_spec::X25519_LRSW_ECDSAP256_CHACHA20POLY1305_SHA512>()));
+
+        template <typename Visitor>
+        visit_result_t<Visitor> visit_suite(suite_spec, Visitor&&, suite_list<>)
+        {
+            return visit_result_t<Visitor>();
+        }
+
+        template <typename Visitor, suite_spec First, suite_spec... Rest>
+        visit_result_t<Visitor> visit_suite(suite_spec suite, Visitor&& visitor, suite_list<First, Rest...>)
+        {
+            if (First == suite)
+                return std::forward<Visitor>(visitor)(suite_traits<First>());
+
+            return visit_suite(suite, std::forward<Visitor>(visitor), suite_list<Rest...>());
+        }
+
+        template <typename Visitor>
+        void for_each_suite(Visitor&, suite_list<>)
+        {
+        }
+
+        template <typename Visitor, suite_spec First, suite_spec... Rest>
+        void for_each_suite(Visitor& visitor, suite_list<First, Rest...>)
+        {
+            visitor(suite_traits<First>());
+            for_each_suite(visitor, suite_list<Rest...>());
+        }
+
+    }   // namespace detail
+
+    /*
+     * Call `visitor(suite_traits<S>())`, where S is the runtime value `suite`.
+     *
+     * `visitor` is typically a generic lambda, instantiated once per suite.
+     * All instantiations must return the same type.
+     * If `suite` is not a known suite, returns a value-initialized result
+     *  (e.g. an empty optional or nullptr) without calling `visitor`.
+     */
+    template <typename Visitor>
+    detail::visit_result_t<Visitor> visit_suite(suite_spec suite, Visitor&& visitor)
+    {
+        return detail::visit_suite(suite, std::forward<Visitor>(visitor), all_suites());
+    }
+
+    /*
+     * Call `visitor(suite_traits<S>())` for every known suite S.
+     */
+    template <typename Visitor>
+    void for_each_suite(Visitor&& visitor)
+    {
+        detail::for_each_suite(visitor, all_suites());
+    }
+
+}   // namespace xtt
+
+#endif
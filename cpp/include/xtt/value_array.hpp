@@ -0,0 +1,127 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#ifndef XTT_CPP_VALUEARRAY_HPP
+#define XTT_CPP_VALUEARRAY_HPP
+#pragma once
+
+#include <xtt/crypto_types.h>
+
+#include <xtt/config.hpp>
+#include <xtt/longterm_key.hpp>
+#include <xtt/pseudonym.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include OPTIONAL_H
+
+namespace xtt {
+
+    /*
+     * Bulk container of fixed-width values (pseudonyms, longterm keys),
+     *  for holding millions of them without a heap node and vtable each.
+     *
+     * Storage is struct-of-arrays:
+     *  the raw values back to back (the same layout as a serialized batch),
+     *  plus an array of 8-byte fingerprints (each value's last 8 bytes),
+     *  which `find` scans with SIMD before comparing whole values.
+     *
+     * Comparisons are not constant-time: this is for public values.
+     */
+    template <typename Raw, typename View>
+    class value_array {
+    public:
+        static constexpr std::size_t value_length = sizeof(Raw);
+        static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+        /*
+         * Deserialize values stored back to back.
+         *
+         * Returns an empty optional if `serialized_length` isn't a multiple of `value_length`.
+         */
+        static
+        OPTIONAL_NS::optional<value_array>
+        deserialize(const unsigned char* serialized, std::size_t serialized_length);
+
+        static
+        OPTIONAL_NS::optional<value_array>
+        deserialize(const std::vector<unsigned char>& serialized);
+
+    public:
+        value_array() = default;
+
+        void reserve(std::size_t count);
+
+        void push_back(View value);
+
+        std::size_t size() const;
+
+        bool empty() const;
+
+        View operator[](std::size_t index) const;
+
+        /*
+         * The values back to back, as accepted by `deserialize`.
+         */
+        const unsigned char* data() const;
+
+        std::vector<unsigned char> serialize() const;
+
+        /*
+         * Index of the first element equal to `value`, or `npos`.
+         *
+         * Linear in `size()`, but only fingerprints are read for non-matching elements.
+         */
+        std::size_t find(View value) const;
+
+        /*
+         * Sort the elements by their bytes, for `sorted_find`.
+         */
+        void sort();
+
+        /*
+         * Index of an element equal to `value`, or `npos`,
+         *  by binary search.
+         *
+         * The elements must be sorted (see `sort`).
+         */
+        std::size_t sorted_find(View value) const;
+
+    private:
+        static std::uint64_t fingerprint(const unsigned char* value);
+
+        std::vector<Raw> values_;
+        std::vector<std::uint64_t> fingerprints_;
+    };
+
+    template <typename Raw, typename View>
+    constexpr std::size_t value_array<Raw, View>::value_length;
+
+    template <typename Raw, typename View>
+    constexpr std::size_t value_array<Raw, View>::npos;
+
+    extern template class value_array<xtt_daa_pseudonym_lrsw, pseudonym_view>;
+    extern template class value_array<xtt_ecdsap256_pub_key, longterm_key_view>;
+
+    using pseudonym_array = value_array<xtt_daa_pseudonym_lrsw, pseudonym_view>;
+    using longterm_key_array = value_array<xtt_ecdsap256_pub_key, longterm_key_view>;
+
+}   // namespace xtt
+
+#endif
@@ -18,7 +18,14 @@
 
 #include <xtt/crypto.hpp>
 
+#include <sodium.h>
+
 int xtt::initialize_crypto()
 {
     return xtt_crypto_initialize_crypto();
 }
+
+void xtt::secure_zero(void *ptr, std::size_t len)
+{
+    sodium_memzero(ptr, len);
+}
@@ -49,9 +49,14 @@ group_identity::deserialize(const std::vector<unsigned char>& serialized)
 }
 
 OPTIONAL_NS::optional<group_identity>
-group_identity::deserialize(const std::string& serialized)
+group_identity::deserialize(STRING_VIEW_NS::string_view serialized)
 {
-    return deserialize(text_to_binary(serialized));
+    xtt_group_id raw;
+    if (!text_to_binary(serialized, raw.data, sizeof(raw))) {
+        return {};
+    }
+
+    return deserialize(raw.data, sizeof(raw));
 }
 
 const xtt_group_id* group_identity::get() const
@@ -0,0 +1,82 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include <xtt/group_identity_filter.hpp>
+
+#include <sodium.h>
+
+#include <algorithm>
+
+using namespace xtt;
+
+static_assert(crypto_shorthash_KEYBYTES == 16 && crypto_shorthash_BYTES == 8,
+              "SipHash parameters changed");
+
+constexpr std::size_t group_identity_filter::bits_per_entry;
+constexpr std::size_t group_identity_filter::hash_count;
+
+group_identity_filter::group_identity_filter(const std::vector<group_identity>& gids)
+    : key_(),
+      bits_((std::max<std::size_t>(gids.size(), 1) * bits_per_entry + 63) / 64, 0),
+      entries_(gids.size())
+{
+    randombytes_buf(key_.data(), key_.size());
+
+    for (const auto& gid : gids) {
+        for_each_position(gid,
+                          [this](std::size_t pos)
+                          {
+                              bits_[pos / 64] |= std::uint64_t(1) << (pos % 64);
+                          });
+    }
+}
+
+bool group_identity_filter::may_contain(const group_identity& gid) const
+{
+    bool ret = true;
+    for_each_position(gid,
+                      [this, &ret](std::size_t pos)
+                      {
+                          ret = ret && (bits_[pos / 64] & (std::uint64_t(1) << (pos % 64)));
+                      });
+
+    return ret;
+}
+
+std::size_t group_identity_filter::size() const
+{
+    return entries_;
+}
+
+template <typename Visitor>
+void group_identity_filter::for_each_position(const group_identity& gid, Visitor&& visitor) const
+{
+    // Double hashing: position i is h1 + i*h2, from one 64-bit SipHash
+    unsigned char digest[crypto_shorthash_BYTES];
+    crypto_shorthash(digest, gid.get()->data, gid.length(), key_.data());
+
+    std::uint64_t h = 0;
+    for (auto byte : digest)
+        h = (h << 8) | byte;
+
+    std::uint32_t h1 = static_cast<std::uint32_t>(h);
+    std::uint32_t h2 = static_cast<std::uint32_t>(h >> 32) | 1;
+    std::size_t bit_count = bits_.size() * 64;
+    for (std::size_t i = 0; i < hash_count; ++i)
+        visitor((h1 + i * std::uint64_t(h2)) % bit_count);
+}
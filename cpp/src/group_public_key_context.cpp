@@ -22,6 +22,7 @@
 #include <vector>
 #include <algorithm>
 #include <limits>
+#include <type_traits>
 
 using namespace xtt;
 
@@ -34,29 +35,143 @@ std::ostream& xtt::operator<<(std::ostream& stream, const xtt::group_public_key_
     return stream << gpk_ctx.get_gpk_as_text() << " - " << gpk_ctx.get_basename_as_text();
 }
 
-std::unique_ptr<group_public_key_context>
-group_public_key_context_lrsw::deserialize(const unsigned char* serialized, std::size_t serialized_length)
-{
-    size_t gpk_len = sizeof(xtt_daa_group_pub_key_lrsw);
+namespace {
 
-    if (serialized_length < (gpk_len + 1)) {   // ensure at least enough for GPK | basename_len
-        return {};
+    bool split_serialized(const unsigned char* serialized,
+                          std::size_t serialized_length,
+                          const unsigned char** basename,
+                          std::size_t* basename_length)
+    {
+        size_t gpk_len = sizeof(xtt_daa_group_pub_key_lrsw);
+
+        if (serialized_length < (gpk_len + 1)) {   // ensure at least enough for GPK | basename_len
+            return false;
+        }
+
+        size_t basename_len = *(serialized + gpk_len);
+        if (basename_len > MAX_BASENAME_LENGTH) {
+            return false;
+        }
+
+        if (serialized_length < (gpk_len + 1 + basename_len)) {
+            return false;
+        }
+
+        *basename = serialized + gpk_len + 1;
+        *basename_length = basename_len;
+
+        return true;
     }
 
-    const unsigned char* gpk_begin = serialized;
+    bool initialize_lrsw(xtt_group_public_key_context* gpk_ctx,
+                         const unsigned char* gpk,
+                         std::size_t gpk_length,
+                         const unsigned char* basename,
+                         std::size_t basename_length)
+    {
+        if (MAX_BASENAME_LENGTH < basename_length) {
+            return false;
+        }
+
+        if (sizeof(xtt_daa_group_pub_key_lrsw) != gpk_length) {
+            return false;
+        }
+
+        xtt_return_code_type ctor_ret =
+            xtt_initialize_group_public_key_context_lrsw(gpk_ctx,
+                                                         basename,
+                                                         basename_length,
+                                                         reinterpret_cast<const xtt_daa_group_pub_key_lrsw*>(gpk));
+
+        return XTT_RETURN_SUCCESS == ctor_ret;
+    }
 
-    size_t basename_len = *(gpk_begin + gpk_len);
-    if (basename_len > MAX_BASENAME_LENGTH) {
-        return {};
+    bool initialize_lrsw(xtt_group_public_key_context* gpk_ctx,
+                         STRING_VIEW_NS::string_view gpk,
+                         STRING_VIEW_NS::string_view basename)
+    {
+        xtt_daa_group_pub_key_lrsw gpk_bytes;
+        unsigned char basename_bytes[MAX_BASENAME_LENGTH];
+        std::size_t basename_length = basename.length() / 2;
+
+        if (MAX_BASENAME_LENGTH < basename_length) {
+            return false;
+        }
+
+        if (!text_to_binary(gpk, gpk_bytes.data, sizeof(gpk_bytes)) ||
+            !text_to_binary(basename, basename_bytes, basename_length)) {
+            return false;
+        }
+
+        return initialize_lrsw(gpk_ctx,
+                               gpk_bytes.data, sizeof(gpk_bytes),
+                               basename_bytes, basename_length);
+    }
+
+    void initialize_lrsw_dummy(xtt_group_public_key_context* gpk_ctx)
+    {
+        xtt_return_code_type ctor_ret =
+            xtt_initialize_group_public_key_context_lrsw(gpk_ctx,
+                                                         nullptr,
+                                                         0,
+                                                         &group_public_key_lrsw_dummy);
+        (void)ctor_ret;
+        assert(XTT_RETURN_SUCCESS == ctor_ret);
+    }
+
+    std::vector<unsigned char> lrsw_gpk(const xtt_group_public_key_context& gpk_ctx)
+    {
+        size_t gpk_len = sizeof(xtt_daa_group_pub_key_lrsw);
+        return std::vector<unsigned char>(gpk_ctx.gpk.lrsw.data, gpk_ctx.gpk.lrsw.data + gpk_len);
     }
 
-    if (serialized_length < (gpk_len + 1 + basename_len)) {
+    std::vector<unsigned char> basename(const xtt_group_public_key_context& gpk_ctx)
+    {
+        size_t basename_len = std::min<std::size_t>(gpk_ctx.basename_length, MAX_BASENAME_LENGTH);
+        return std::vector<unsigned char>(gpk_ctx.basename, gpk_ctx.basename + basename_len);
+    }
+
+    std::vector<unsigned char> serialize_lrsw(const xtt_group_public_key_context& gpk_ctx)
+    {
+        std::vector<unsigned char> basename_bytes{basename(gpk_ctx)};
+        std::vector<unsigned char> gpk{lrsw_gpk(gpk_ctx)};
+
+        std::vector<unsigned char> ret;
+        ret.reserve(gpk.size() + 1 + basename_bytes.size());  // 1 extra for basename_length
+
+        ret.insert(ret.end(), gpk.begin(), gpk.end());
+
+        assert(basename_bytes.size() < std::numeric_limits<unsigned char>::max());
+        ret.push_back(static_cast<unsigned char>(basename_bytes.size()));
+
+        ret.insert(ret.end(), basename_bytes.begin(), basename_bytes.end());
+
+        return ret;
+    }
+
+    std::string lrsw_gpk_as_text(const xtt_group_public_key_context& gpk_ctx)
+    {
+        return binary_to_text(gpk_ctx.gpk.lrsw.data, sizeof(xtt_daa_group_pub_key_lrsw));
+    }
+
+    std::string basename_as_text(const xtt_group_public_key_context& gpk_ctx)
+    {
+        return binary_to_text(gpk_ctx.basename, std::min<std::size_t>(gpk_ctx.basename_length, MAX_BASENAME_LENGTH));
+    }
+
+}
+
+std::unique_ptr<group_public_key_context>
+group_public_key_context_lrsw::deserialize(const unsigned char* serialized, std::size_t serialized_length)
+{
+    const unsigned char* basename_begin;
+    std::size_t basename_len;
+    if (!split_serialized(serialized, serialized_length, &basename_begin, &basename_len)) {
         return {};
     }
-    const unsigned char* basename_begin = serialized + gpk_len + 1;
 
-    return from_gpk_and_basename(gpk_begin, gpk_len,
-                                 basename_begin,basename_len);
+    return from_gpk_and_basename(serialized, sizeof(xtt_daa_group_pub_key_lrsw),
+                                 basename_begin, basename_len);
 }
 
 std::unique_ptr<group_public_key_context>
@@ -71,28 +186,13 @@ group_public_key_context_lrsw::from_gpk_and_basename(const unsigned char* gpk,
                                                      const unsigned char* basename,
                                                      std::size_t basename_length)
 {
-    if (MAX_BASENAME_LENGTH < basename_length) {
-        return {};
-    }
+    std::unique_ptr<group_public_key_context> ret(new group_public_key_context_lrsw(uninitialized()));
 
-    if (sizeof(xtt_daa_group_pub_key_lrsw) != gpk_length) {
+    if (!initialize_lrsw(ret->get(), gpk, gpk_length, basename, basename_length)) {
         return {};
     }
 
-    auto ret = std::make_unique<group_public_key_context_lrsw>();
-    if (!ret)
-        return {};
-
-    xtt_return_code_type ctor_ret =
-        xtt_initialize_group_public_key_context_lrsw(ret->get(),
-                                                     basename,
-                                                     basename_length,
-                                                     reinterpret_cast<const xtt_daa_group_pub_key_lrsw*>(gpk));
-    if (XTT_RETURN_SUCCESS != ctor_ret) {
-        return {};
-    }
-
-    return std::move(ret);
+    return ret;
 }
 
 std::unique_ptr<group_public_key_context>
@@ -103,22 +203,30 @@ group_public_key_context_lrsw::from_gpk_and_basename(const std::vector<unsigned
 }
 
 std::unique_ptr<group_public_key_context>
-group_public_key_context_lrsw::from_gpk_and_basename(const std::string& gpk,
-                                                     const std::string& basename)
+group_public_key_context_lrsw::from_gpk_and_basename(STRING_VIEW_NS::string_view gpk,
+                                                     STRING_VIEW_NS::string_view basename)
 {
-    return group_public_key_context_lrsw::from_gpk_and_basename(text_to_binary(gpk),
-                                                                text_to_binary(basename));
+    std::unique_ptr<group_public_key_context> ret(new group_public_key_context_lrsw(uninitialized()));
+
+    if (!initialize_lrsw(ret->get(), gpk, basename)) {
+        return {};
+    }
+
+    return ret;
 }
 
 group_public_key_context_lrsw::group_public_key_context_lrsw()
 {
-    xtt_return_code_type ctor_ret =
-        xtt_initialize_group_public_key_context_lrsw(&gpk_ctx_,
-                                                     nullptr,
-                                                     0,
-                                                     &group_public_key_lrsw_dummy);
-    (void)ctor_ret;
-    assert(XTT_RETURN_SUCCESS == ctor_ret);
+    initialize_lrsw_dummy(&gpk_ctx_);
+}
+
+group_public_key_context_lrsw::group_public_key_context_lrsw(uninitialized) noexcept
+{
+}
+
+group_public_key_context_lrsw::group_public_key_context_lrsw(const xtt_group_public_key_context& gpk_ctx) noexcept
+    : gpk_ctx_(gpk_ctx)
+{
 }
 
 struct xtt_group_public_key_context* group_public_key_context_lrsw::get()
@@ -133,45 +241,155 @@ const struct xtt_group_public_key_context* group_public_key_context_lrsw::get()
 
 std::vector<unsigned char> group_public_key_context_lrsw::serialize() const
 {
-    std::vector<unsigned char> basename{get_basename()};
-    std::vector<unsigned char> gpk{get_gpk()};
-
-    std::vector<unsigned char> ret;
-    ret.reserve(gpk.size() + 1 + basename.size());  // 1 extra for basename_length
-
-    ret.insert(ret.end(), gpk.begin(), gpk.end());
-
-    assert(basename.size() < std::numeric_limits<unsigned char>::max());
-    ret.push_back(static_cast<unsigned char>(basename.size()));
-
-    ret.insert(ret.end(), basename.begin(), basename.end());
-
-    return ret;
+    return serialize_lrsw(gpk_ctx_);
 }
 
 std::vector<unsigned char> group_public_key_context_lrsw::get_gpk() const
 {
-    size_t gpk_len = sizeof(xtt_daa_group_pub_key_lrsw);
-    return std::vector<unsigned char>(gpk_ctx_.gpk.lrsw.data, gpk_ctx_.gpk.lrsw.data + gpk_len);
+    return lrsw_gpk(gpk_ctx_);
 }
 
 std::vector<unsigned char> group_public_key_context_lrsw::get_basename() const
 {
-    size_t basename_len = std::min<std::size_t>(gpk_ctx_.basename_length, MAX_BASENAME_LENGTH);
-    return std::vector<unsigned char>(gpk_ctx_.basename, gpk_ctx_.basename + basename_len);
+    return basename(gpk_ctx_);
 }
 
 std::string group_public_key_context_lrsw::get_gpk_as_text() const
 {
-    return binary_to_text(gpk_ctx_.gpk.lrsw.data, sizeof(xtt_daa_group_pub_key_lrsw));
+    return lrsw_gpk_as_text(gpk_ctx_);
 }
 
 std::string group_public_key_context_lrsw::get_basename_as_text() const
 {
-    return binary_to_text(gpk_ctx_.basename, std::min<std::size_t>(gpk_ctx_.basename_length, MAX_BASENAME_LENGTH));
+    return basename_as_text(gpk_ctx_);
 }
 
 std::unique_ptr<group_public_key_context> group_public_key_context_lrsw::clone() const
 {
     return std::make_unique<group_public_key_context_lrsw>(*this);
 }
+
+static_assert(std::is_nothrow_move_constructible<group_public_key_context_lrsw>::value,
+              "group_public_key_context_lrsw must be nothrow-movable");
+
+static_assert(std::is_trivially_copyable<group_public_key_context_lrsw_value>::value,
+              "group_public_key_context_lrsw_value must be trivially copyable");
+
+template <typename Algorithm>
+OPTIONAL_NS::optional<group_public_key_context_value<Algorithm>>
+group_public_key_context_value<Algorithm>::deserialize(const unsigned char* serialized, std::size_t serialized_length)
+{
+    const unsigned char* basename_begin;
+    std::size_t basename_len;
+    if (!split_serialized(serialized, serialized_length, &basename_begin, &basename_len)) {
+        return {};
+    }
+
+    return from_gpk_and_basename(serialized, sizeof(xtt_daa_group_pub_key_lrsw),
+                                 basename_begin, basename_len);
+}
+
+template <typename Algorithm>
+OPTIONAL_NS::optional<group_public_key_context_value<Algorithm>>
+group_public_key_context_value<Algorithm>::deserialize(const std::vector<unsigned char>& serialized)
+{
+    return deserialize(serialized.data(), serialized.size());
+}
+
+template <typename Algorithm>
+OPTIONAL_NS::optional<group_public_key_context_value<Algorithm>>
+group_public_key_context_value<Algorithm>::from_gpk_and_basename(const unsigned char* gpk,
+                                                                 std::size_t gpk_length,
+                                                                 const unsigned char* basename,
+                                                                 std::size_t basename_length)
+{
+    xtt_group_public_key_context gpk_ctx;
+    if (!initialize_lrsw(&gpk_ctx, gpk, gpk_length, basename, basename_length)) {
+        return {};
+    }
+
+    return group_public_key_context_value(gpk_ctx);
+}
+
+template <typename Algorithm>
+OPTIONAL_NS::optional<group_public_key_context_value<Algorithm>>
+group_public_key_context_value<Algorithm>::from_gpk_and_basename(const std::vector<unsigned char>& gpk,
+                                                                 const std::vector<unsigned char>& basename)
+{
+    return from_gpk_and_basename(gpk.data(), gpk.size(), basename.data(), basename.size());
+}
+
+template <typename Algorithm>
+OPTIONAL_NS::optional<group_public_key_context_value<Algorithm>>
+group_public_key_context_value<Algorithm>::from_gpk_and_basename(STRING_VIEW_NS::string_view gpk,
+                                                                 STRING_VIEW_NS::string_view basename)
+{
+    xtt_group_public_key_context gpk_ctx;
+    if (!initialize_lrsw(&gpk_ctx, gpk, basename)) {
+        return {};
+    }
+
+    return group_public_key_context_value(gpk_ctx);
+}
+
+template <typename Algorithm>
+group_public_key_context_value<Algorithm>::group_public_key_context_value()
+{
+    initialize_lrsw_dummy(&gpk_ctx_);
+}
+
+template <typename Algorithm>
+group_public_key_context_value<Algorithm>::group_public_key_context_value(const xtt_group_public_key_context& gpk_ctx) noexcept
+    : gpk_ctx_(gpk_ctx)
+{
+}
+
+template <typename Algorithm>
+std::unique_ptr<group_public_key_context> group_public_key_context_value<Algorithm>::clone() const
+{
+    return std::unique_ptr<group_public_key_context>(new group_public_key_context_lrsw(gpk_ctx_));
+}
+
+template <typename Algorithm>
+std::vector<unsigned char> group_public_key_context_value<Algorithm>::serialize() const
+{
+    return serialize_lrsw(gpk_ctx_);
+}
+
+template <typename Algorithm>
+std::vector<unsigned char> group_public_key_context_value<Algorithm>::get_gpk() const
+{
+    return lrsw_gpk(gpk_ctx_);
+}
+
+template <typename Algorithm>
+std::vector<unsigned char> group_public_key_context_value<Algorithm>::get_basename() const
+{
+    return basename(gpk_ctx_);
+}
+
+template <typename Algorithm>
+std::string group_public_key_context_value<Algorithm>::get_gpk_as_text() const
+{
+    return lrsw_gpk_as_text(gpk_ctx_);
+}
+
+template <typename Algorithm>
+std::string group_public_key_context_value<Algorithm>::get_basename_as_text() const
+{
+    return basename_as_text(gpk_ctx_);
+}
+
+template <typename Algorithm>
+struct xtt_group_public_key_context* group_public_key_context_value<Algorithm>::get()
+{
+    return &gpk_ctx_;
+}
+
+template <typename Algorithm>
+const struct xtt_group_public_key_context* group_public_key_context_value<Algorithm>::get() const
+{
+    return &gpk_ctx_;
+}
+
+template class xtt::group_public_key_context_value<algorithm::lrsw>;
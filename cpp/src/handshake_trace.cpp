@@ -0,0 +1,132 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include <xtt/handshake_trace.hpp>
+
+#include <algorithm>
+#include <iterator>
+
+using namespace xtt;
+
+namespace {
+
+    const unsigned char trace_magic[8] = {'X', 'T', 'T', 'T', 'R', 'C', '0', '1'};
+    constexpr std::size_t record_header_length = 4 + 8 + 2;
+
+    void write_be(unsigned char *out, std::uint64_t value, std::size_t length)
+    {
+        for (std::size_t i = 0; i < length; ++i)
+            out[i] = static_cast<unsigned char>(value >> (8 * (length - 1 - i)));
+    }
+
+    std::uint64_t read_be(const unsigned char *in, std::size_t length)
+    {
+        std::uint64_t ret = 0;
+        for (std::size_t i = 0; i < length; ++i)
+            ret = (ret << 8) | in[i];
+        return ret;
+    }
+
+}
+
+std::unique_ptr<handshake_trace_writer>
+handshake_trace_writer::create(const std::string& path)
+{
+    std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file)
+        return nullptr;
+
+    file.write(reinterpret_cast<const char*>(trace_magic), sizeof(trace_magic));
+    if (!file)
+        return nullptr;
+
+    return std::unique_ptr<handshake_trace_writer>(new handshake_trace_writer(std::move(file)));
+}
+
+handshake_trace_writer::handshake_trace_writer(std::ofstream file)
+    : file_(std::move(file)),
+      start_(std::chrono::steady_clock::now()),
+      next_connection_(0),
+      mutex_()
+{
+}
+
+std::uint32_t handshake_trace_writer::begin_connection()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    return next_connection_++;
+}
+
+void handshake_trace_writer::record(std::uint32_t connection, const unsigned char *data, std::size_t length)
+{
+    auto time_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_).count();
+
+    // Handshake messages are far shorter than this, but don't write a corrupt length
+    length = std::min<std::size_t>(length, UINT16_MAX);
+
+    unsigned char header[record_header_length];
+    write_be(header, connection, 4);
+    write_be(header + 4, static_cast<std::uint64_t>(time_us), 8);
+    write_be(header + 12, length, 2);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    file_.write(reinterpret_cast<const char*>(header), sizeof(header));
+    file_.write(reinterpret_cast<const char*>(data), length);
+}
+
+bool handshake_trace_writer::flush()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    file_.flush();
+
+    return static_cast<bool>(file_);
+}
+
+OPTIONAL_NS::optional<std::vector<handshake_trace_record>>
+xtt::read_handshake_trace(const std::string& path)
+{
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    if (!file)
+        return {};
+
+    std::vector<unsigned char> contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (contents.size() < sizeof(trace_magic) ||
+        !std::equal(std::begin(trace_magic), std::end(trace_magic), contents.begin()))
+        return {};
+
+    std::vector<handshake_trace_record> ret;
+    std::size_t offset = sizeof(trace_magic);
+    while (contents.size() - offset >= record_header_length) {
+        const unsigned char *header = contents.data() + offset;
+        std::size_t length = read_be(header + 12, 2);
+        if (contents.size() - offset - record_header_length < length)
+            break;
+
+        handshake_trace_record record;
+        record.connection = static_cast<std::uint32_t>(read_be(header, 4));
+        record.time_us = read_be(header + 4, 8);
+        record.data.assign(header + record_header_length, header + record_header_length + length);
+        ret.push_back(std::move(record));
+
+        offset += record_header_length + length;
+    }
+
+    return ret;
+}
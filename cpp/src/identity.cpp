@@ -18,9 +18,9 @@
 
 #include <xtt/identity.hpp>
 
-#include <boost/asio.hpp>
-
 #include <algorithm>
+#include <cstring>
+#include <ostream>
 
 #include "internal/text_to_binary.hpp"
 
@@ -30,9 +30,279 @@ using namespace xtt;
 
 const identity identity::null;
 
+constexpr std::size_t identity::max_text_length;
+
+namespace {
+
+    const char hex_digits[] = "0123456789abcdef";
+
+    int hex_value(char c)
+    {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F')
+            return c - 'A' + 10;
+        return -1;
+    }
+
+    char* format_decimal(unsigned char value, char* out)
+    {
+        if (value >= 100)
+            *out++ = '0' + value / 100;
+        if (value >= 10)
+            *out++ = '0' + (value / 10) % 10;
+        *out++ = '0' + value % 10;
+
+        return out;
+    }
+
+    /*
+     * Format as inet_ntop does (and so as boost::asio::ip::address_v6 did):
+     *  lowercase hex, the first longest run of two or more zero words as "::",
+     *  and IPv4-compatible and -mapped addresses with a dotted-quad tail.
+     * `out` must have room for identity::max_text_length chars.
+     */
+    std::size_t format_ipv6(const unsigned char* bytes, char* out)
+    {
+        unsigned words[8];
+        for (int i = 0; i < 8; ++i)
+            words[i] = (bytes[2*i] << 8) | bytes[2*i + 1];
+
+        int best_base = -1, best_length = 0;
+        for (int i = 0; i < 8;) {
+            if (words[i] != 0) {
+                ++i;
+                continue;
+            }
+
+            int base = i;
+            while (i < 8 && words[i] == 0)
+                ++i;
+            if (i - base > best_length) {
+                best_base = base;
+                best_length = i - base;
+            }
+        }
+        if (best_length < 2)
+            best_base = -1;
+
+        char* p = out;
+        for (int i = 0; i < 8; ++i) {
+            if (best_base != -1 && i >= best_base && i < best_base + best_length) {
+                if (i == best_base)
+                    *p++ = ':';
+                continue;
+            }
+
+            if (i != 0)
+                *p++ = ':';
+
+            if (6 == i && 0 == best_base &&
+                (6 == best_length ||
+                 (7 == best_length && 0x0001 != words[7]) ||
+                 (5 == best_length && 0xffff == words[5]))) {
+                for (int j = 12; j < 16; ++j) {
+                    if (j != 12)
+                        *p++ = '.';
+                    p = format_decimal(bytes[j], p);
+                }
+                return p - out;
+            }
+
+            bool leading = true;
+            for (int shift = 12; shift >= 0; shift -= 4) {
+                unsigned digit = (words[i] >> shift) & 0xf;
+                if (leading && 0 == digit && 0 != shift)
+                    continue;
+                leading = false;
+                *p++ = hex_digits[digit];
+            }
+        }
+
+        if (best_base != -1 && 8 == best_base + best_length)
+            *p++ = ':';
+
+        return p - out;
+    }
+
+    // Dotted-quad, as inet_pton accepts it: four decimal octets, without leading zeros.
+    bool parse_ipv4(const char* p, const char* end, unsigned char* out)
+    {
+        int octets = 0;
+        bool saw_digit = false;
+        unsigned value = 0;
+
+        for (; p != end; ++p) {
+            if (*p >= '0' && *p <= '9') {
+                if (saw_digit && 0 == value)
+                    return false;
+                value = value * 10 + (*p - '0');
+                if (value > 255)
+                    return false;
+                saw_digit = true;
+            } else if ('.' == *p && saw_digit && octets < 3) {
+                out[octets++] = static_cast<unsigned char>(value);
+                saw_digit = false;
+                value = 0;
+            } else {
+                return false;
+            }
+        }
+
+        if (!saw_digit || 3 != octets)
+            return false;
+
+        out[octets] = static_cast<unsigned char>(value);
+
+        return true;
+    }
+
+    // Parse as inet_pton does.
+    bool parse_ipv6(STRING_VIEW_NS::string_view text, unsigned char* out)
+    {
+        unsigned char bytes[16] = {0};
+        unsigned char* tp = bytes;
+        unsigned char* const endp = bytes + sizeof(bytes);
+        unsigned char* colonp = nullptr;
+
+        const char* p = text.data();
+        const char* const end = p + text.size();
+
+        // A leading ':' must be the start of a "::"
+        if (p != end && ':' == *p) {
+            if (++p == end || ':' != *p)
+                return false;
+        }
+
+        const char* group_begin = p;
+        bool saw_digit = false;
+        int digits = 0;
+        unsigned value = 0;
+
+        while (p != end) {
+            char c = *p++;
+
+            int digit = hex_value(c);
+            if (digit >= 0) {
+                if (++digits > 4)
+                    return false;
+                value = (value << 4) | digit;
+                saw_digit = true;
+                continue;
+            }
+
+            if (':' == c) {
+                group_begin = p;
+                if (!saw_digit) {
+                    if (colonp)
+                        return false;
+                    colonp = tp;
+                    continue;
+                }
+                if (p == end || tp + 2 > endp)
+                    return false;
+
+                *tp++ = static_cast<unsigned char>(value >> 8);
+                *tp++ = static_cast<unsigned char>(value);
+                saw_digit = false;
+                digits = 0;
+                value = 0;
+                continue;
+            }
+
+            if ('.' == c && tp + 4 <= endp && parse_ipv4(group_begin, end, tp)) {
+                tp += 4;
+                saw_digit = false;
+                break;
+            }
+
+            return false;
+        }
+
+        if (saw_digit) {
+            if (tp + 2 > endp)
+                return false;
+
+            *tp++ = static_cast<unsigned char>(value >> 8);
+            *tp++ = static_cast<unsigned char>(value);
+        }
+
+        if (colonp) {
+            // "::" stands for at least one zero word
+            if (tp == endp)
+                return false;
+
+            std::size_t tail = tp - colonp;
+            std::memmove(endp - tail, colonp, tail);
+            std::fill(colonp, endp - tail, 0);
+            tp = endp;
+        }
+
+        if (tp != endp)
+            return false;
+
+        std::copy(bytes, bytes + sizeof(bytes), out);
+
+        return true;
+    }
+
+}
+
 std::ostream& xtt::operator<<(std::ostream& stream, const xtt::identity& id)
 {
-    return stream << id.serialize_to_text();
+    char as_text[identity::max_text_length];
+    std::size_t length = id.serialize_to_text(as_text, sizeof(as_text));
+
+    return stream.write(as_text, length);
+}
+
+std::size_t xtt::format_identities(const identity* identities,
+                                   std::size_t count,
+                                   char* out,
+                                   std::size_t out_length,
+                                   char separator)
+{
+    char* p = out;
+    char* const end = out + out_length;
+
+    for (std::size_t i = 0; i < count; ++i) {
+        std::size_t room = end - p;
+
+        // Format in place, unless this might be the last one that fits
+        std::size_t length = room > identity::max_text_length
+                           ? format_ipv6(identities[i].get()->data, p)
+                           : identities[i].serialize_to_text(p, room);
+        if (0 == length || length == room)
+            return 0;
+
+        p += length;
+        *p++ = separator;
+    }
+
+    return p - out;
+}
+
+std::size_t xtt::parse_identities(const STRING_VIEW_NS::string_view* texts,
+                                  std::size_t count,
+                                  identity* identities,
+                                  bool* malformed)
+{
+    std::size_t malformed_count = 0;
+
+    for (std::size_t i = 0; i < count; ++i) {
+        bool ok = parse_ipv6(texts[i], identities[i].get()->data);
+        if (!ok) {
+            identities[i] = identity::null;
+            ++malformed_count;
+        }
+
+        if (malformed)
+            malformed[i] = !ok;
+    }
+
+    return malformed_count;
 }
 
 OPTIONAL_NS::optional<identity>
@@ -55,13 +325,14 @@ identity::deserialize(const std::vector<unsigned char>& serialized)
 }
 
 OPTIONAL_NS::optional<identity>
-identity::deserialize(const std::string& serialized_as_text)
+identity::deserialize(STRING_VIEW_NS::string_view serialized_as_text)
 {
-    using boost::asio::ip::make_address_v6;
-
-    auto as_bytes = make_address_v6(serialized_as_text).to_bytes();
+    identity ret;
+    if (!parse_ipv6(serialized_as_text, ret.raw_.data)) {
+        return {};
+    }
 
-    return identity::deserialize(as_bytes.data(), as_bytes.size());
+    return ret;
 }
 
 identity::identity()
@@ -81,16 +352,22 @@ std::vector<unsigned char> identity::serialize() const
 
 std::string identity::serialize_to_text() const
 {
-    using boost::asio::ip::address_v6;
-    using boost::asio::ip::make_address_v6;
+    char as_text[max_text_length];
+    std::size_t length = format_ipv6(raw_.data, as_text);
+
+    return std::string(as_text, length);
+}
 
-    address_v6::bytes_type as_bytes;
+std::size_t identity::serialize_to_text(char* out, std::size_t out_length) const
+{
+    char as_text[max_text_length];
+    std::size_t length = format_ipv6(raw_.data, as_text);
+    if (length > out_length)
+        return 0;
 
-    auto beg = raw_.data;
-    auto end = raw_.data + sizeof(xtt_identity_type);
-    std::copy(beg, end, as_bytes.begin());
+    std::copy(as_text, as_text + length, out);
 
-    return make_address_v6(as_bytes).to_string();
+    return length;
 }
 
 bool identity::is_null() const
@@ -0,0 +1,201 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include <xtt/identity_allocator.hpp>
+
+#include <sodium.h>
+
+#include <algorithm>
+#include <chrono>
+
+using namespace xtt;
+
+static_assert(sizeof(xtt_identity_type) <= crypto_hash_sha256_BYTES,
+              "SHA-256 digest is too short to fill an identity");
+
+void identity_allocator::release(const identity&)
+{
+}
+
+hash_identity_allocator::hash_identity_allocator(bool honor_requested_id)
+    : honor_requested_id_(honor_requested_id)
+{
+}
+
+OPTIONAL_NS::optional<identity>
+hash_identity_allocator::allocate(const group_identity& gid,
+                                  pseudonym_view nym,
+                                  const identity& requested_id)
+{
+    if (honor_requested_id_ && !requested_id.is_null()) {
+        return requested_id;
+    }
+
+    unsigned char digest[crypto_hash_sha256_BYTES];
+    crypto_hash_sha256_state h;
+    crypto_hash_sha256_init(&h);
+    crypto_hash_sha256_update(&h, gid.get()->data, gid.length());
+    crypto_hash_sha256_update(&h, nym.get()->data, nym.length());
+    crypto_hash_sha256_final(&h, digest);
+
+    identity ret;
+    std::copy(digest, digest + sizeof(xtt_identity_type), ret.get()->data);
+
+    return ret;
+}
+
+std::unique_ptr<sequential_identity_allocator>
+sequential_identity_allocator::create(const identity& prefix,
+                                      std::uint64_t block_size,
+                                      block_source lease_block,
+                                      std::chrono::milliseconds lease_wait)
+{
+    std::unique_ptr<sequential_identity_allocator> ret(new sequential_identity_allocator(prefix,
+                                                                                         block_size,
+                                                                                         std::move(lease_block),
+                                                                                         lease_wait));
+
+    auto block_start = ret->lease_block_(ret->block_size_);
+    if (!block_start) {
+        return nullptr;
+    }
+
+    ret->next_ = *block_start;
+    ret->end_ = *block_start + ret->block_size_;
+
+    return ret;
+}
+
+sequential_identity_allocator::sequential_identity_allocator(const identity& prefix,
+                                                             std::uint64_t block_size,
+                                                             block_source lease_block,
+                                                             std::chrono::milliseconds lease_wait)
+    : prefix_(prefix),
+      block_size_(std::max<std::uint64_t>(block_size, 1)),
+      lease_block_(std::move(lease_block)),
+      lease_wait_(lease_wait),
+      mutex_(),
+      next_(0),
+      end_(0),
+      prefetch_()
+{
+}
+
+OPTIONAL_NS::optional<identity>
+sequential_identity_allocator::allocate(const group_identity&,
+                                        pseudonym_view,
+                                        const identity&)
+{
+    std::uint64_t counter;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if (next_ == end_) {
+            // Normally already in flight; if a lease failed, retry it
+            start_prefetch();
+            if (!take_prefetched_block(lease_wait_)) {
+                return {};
+            }
+        }
+
+        counter = next_++;
+
+        if (end_ - next_ <= block_size_ / 2) {
+            start_prefetch();
+        }
+    }
+
+    identity ret(prefix_);
+    unsigned char* counter_out = ret.get()->data + sizeof(xtt_identity_type) - sizeof(counter);
+    for (std::size_t i = 0; i < sizeof(counter); ++i) {
+        counter_out[i] = static_cast<unsigned char>(counter >> (8 * (sizeof(counter) - 1 - i)));
+    }
+
+    return ret;
+}
+
+bool sequential_identity_allocator::take_prefetched_block(std::chrono::milliseconds wait)
+{
+    if (!prefetch_.valid() ||
+        std::future_status::ready != prefetch_.wait_for(wait)) {
+        return false;
+    }
+
+    auto block_start = prefetch_.get();
+    if (!block_start) {
+        return false;
+    }
+
+    next_ = *block_start;
+    end_ = *block_start + block_size_;
+
+    return true;
+}
+
+void sequential_identity_allocator::start_prefetch()
+{
+    if (prefetch_.valid()) {
+        return;
+    }
+
+    prefetch_ = std::async(std::launch::async, lease_block_, block_size_);
+}
+
+pooled_identity_allocator::pooled_identity_allocator(std::vector<identity> pool)
+    : mutex_(),
+      free_(std::move(pool)),
+      leased_()
+{
+    leased_.reserve(free_.size());
+}
+
+OPTIONAL_NS::optional<identity>
+pooled_identity_allocator::allocate(const group_identity&,
+                                    pseudonym_view,
+                                    const identity&)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (free_.empty()) {
+        return {};
+    }
+
+    identity ret = free_.back();
+    free_.pop_back();
+    leased_.insert(ret);
+
+    return ret;
+}
+
+void pooled_identity_allocator::release(const identity& id)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (0 == leased_.erase(id)) {
+        return;
+    }
+
+    free_.push_back(id);
+}
+
+std::size_t pooled_identity_allocator::available() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    return free_.size();
+}
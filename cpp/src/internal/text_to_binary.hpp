@@ -27,6 +27,7 @@
 #include <sstream>
 #include <iomanip>
 #include OPTIONAL_H
+#include STRING_VIEW_H
 
 inline
 OPTIONAL_NS::optional<unsigned char> ascii_to_byte(const char value);
@@ -42,23 +43,43 @@ std::string binary_to_text(const unsigned char *binary, uint16_t size) {
     return ss.str();
 }
 
+/*
+ * Decode `text` into exactly `binary_length` bytes at `binary`,
+ * without allocating.
+ *
+ * Returns false if `text` isn't `2*binary_length` hexadecimal digits,
+ * in which case the contents of `binary` are unspecified.
+ */
 inline
-std::vector<unsigned char> text_to_binary(const std::string& text)
+bool text_to_binary(STRING_VIEW_NS::string_view text, unsigned char *binary, std::size_t binary_length)
 {
-    if (0 != text.length() % 2) {
-        return {};
+    if (text.length() != 2*binary_length) {
+        return false;
     }
-    std::size_t size = text.size() / 2;
 
-    std::vector<unsigned char> ret(size);
-    for (std::size_t i=0; i < size; ++i) {
+    for (std::size_t i=0; i < binary_length; ++i) {
         auto maybe_upper = ascii_to_byte(text[2*i]);
         auto maybe_lower = ascii_to_byte(text[2*i+1]);
         if (!maybe_upper || !maybe_lower) {
-            return {};
+            return false;
         }
 
-        ret[i] = *maybe_upper*16 + *maybe_lower;
+        binary[i] = *maybe_upper*16 + *maybe_lower;
+    }
+
+    return true;
+}
+
+inline
+std::vector<unsigned char> text_to_binary(STRING_VIEW_NS::string_view text)
+{
+    if (0 != text.length() % 2) {
+        return {};
+    }
+
+    std::vector<unsigned char> ret(text.size() / 2);
+    if (!text_to_binary(text, ret.data(), ret.size())) {
+        return {};
     }
 
     return ret;
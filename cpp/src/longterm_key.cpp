@@ -22,6 +22,8 @@
 
 #include <xtt/crypto_wrapper.h>
 
+#include <type_traits>
+
 using namespace xtt;
 
 std::ostream& xtt::operator<<(std::ostream& stream, const xtt::longterm_key& key)
@@ -29,6 +31,11 @@ std::ostream& xtt::operator<<(std::ostream& stream, const xtt::longterm_key& key
     return stream << key.serialize_to_text();
 }
 
+std::ostream& xtt::operator<<(std::ostream& stream, const xtt::longterm_key_view& key)
+{
+    return stream << key.serialize_to_text();
+}
+
 std::unique_ptr<longterm_key>
 longterm_key_ecdsap256::deserialize(const unsigned char* serialized, std::size_t serialized_length)
 {
@@ -51,9 +58,14 @@ longterm_key_ecdsap256::deserialize(const std::vector<unsigned char>& serialized
 }
 
 std::unique_ptr<longterm_key>
-longterm_key_ecdsap256::deserialize(const std::string& serialized)
+longterm_key_ecdsap256::deserialize(STRING_VIEW_NS::string_view serialized)
 {
-    return longterm_key_ecdsap256::deserialize(text_to_binary(serialized));
+    xtt_ecdsap256_pub_key raw;
+    if (!text_to_binary(serialized, raw.data, sizeof(raw))) {
+        return {};
+    }
+
+    return longterm_key_ecdsap256::deserialize(raw.data, sizeof(raw));
 }
 
 std::size_t longterm_key_ecdsap256::length() const
@@ -124,9 +136,14 @@ longterm_private_key_ecdsap256::deserialize(const std::vector<unsigned char>& se
 }
 
 std::unique_ptr<longterm_private_key>
-longterm_private_key_ecdsap256::deserialize(const std::string& serialized)
+longterm_private_key_ecdsap256::deserialize(STRING_VIEW_NS::string_view serialized)
 {
-    return longterm_private_key_ecdsap256::deserialize(text_to_binary(serialized));
+    xtt_ecdsap256_priv_key raw;
+    if (!text_to_binary(serialized, raw.data, sizeof(raw))) {
+        return {};
+    }
+
+    return longterm_private_key_ecdsap256::deserialize(raw.data, sizeof(raw));
 }
 
 std::size_t longterm_private_key_ecdsap256::length() const
@@ -173,3 +190,210 @@ bool longterm_private_key::operator!=(const longterm_private_key& other) const
 {
     return !(*this == other);
 }
+
+std::unique_ptr<longterm_key> longterm_key_view::clone() const
+{
+    return longterm_key_ecdsap256::deserialize(data(), length());
+}
+
+std::vector<unsigned char> longterm_key_view::serialize() const
+{
+    return std::vector<unsigned char>(data(), data()+length());
+}
+
+std::string longterm_key_view::serialize_to_text() const
+{
+    return binary_to_text(data(), length());
+}
+
+bool longterm_key_view::operator==(const longterm_key_view& other) const
+{
+    return 0 == xtt_crypto_memcmp(data(),
+                                  other.data(),
+                                  length());
+}
+
+bool longterm_key_view::operator!=(const longterm_key_view& other) const
+{
+    return !(*this == other);
+}
+
+static_assert(std::is_trivially_copyable<longterm_key_ecdsap256_value>::value,
+              "longterm_key_ecdsap256_value must be trivially copyable");
+static_assert(std::is_trivially_copyable<longterm_private_key_ecdsap256_value>::value,
+              "longterm_private_key_ecdsap256_value must be trivially copyable");
+
+template <typename Algorithm>
+OPTIONAL_NS::optional<longterm_key_value<Algorithm>>
+longterm_key_value<Algorithm>::deserialize(const unsigned char* serialized, std::size_t serialized_length)
+{
+    if (sizeof(raw_type) != serialized_length) {
+        return {};
+    }
+
+    longterm_key_value ret;
+    ret.raw_ = *reinterpret_cast<const raw_type*>(serialized);
+
+    return ret;
+}
+
+template <typename Algorithm>
+OPTIONAL_NS::optional<longterm_key_value<Algorithm>>
+longterm_key_value<Algorithm>::deserialize(const std::vector<unsigned char>& serialized)
+{
+    return deserialize(serialized.data(), serialized.size());
+}
+
+template <typename Algorithm>
+OPTIONAL_NS::optional<longterm_key_value<Algorithm>>
+longterm_key_value<Algorithm>::deserialize(STRING_VIEW_NS::string_view serialized)
+{
+    raw_type raw;
+    if (!text_to_binary(serialized, raw.data, sizeof(raw))) {
+        return {};
+    }
+
+    return deserialize(raw.data, sizeof(raw));
+}
+
+template <typename Algorithm>
+std::size_t longterm_key_value<Algorithm>::length() const
+{
+    return sizeof(raw_type);
+}
+
+template <typename Algorithm>
+std::unique_ptr<longterm_key> longterm_key_value<Algorithm>::clone() const
+{
+    return longterm_key_view(*this).clone();
+}
+
+template <typename Algorithm>
+std::vector<unsigned char> longterm_key_value<Algorithm>::serialize() const
+{
+    return std::vector<unsigned char>(raw_.data, raw_.data+sizeof(raw_type));
+}
+
+template <typename Algorithm>
+std::string longterm_key_value<Algorithm>::serialize_to_text() const
+{
+    return binary_to_text(raw_.data, sizeof(raw_type));
+}
+
+template <typename Algorithm>
+const typename longterm_key_value<Algorithm>::raw_type* longterm_key_value<Algorithm>::get() const
+{
+    return &raw_;
+}
+
+template <typename Algorithm>
+typename longterm_key_value<Algorithm>::raw_type* longterm_key_value<Algorithm>::get()
+{
+    return &raw_;
+}
+
+template <typename Algorithm>
+longterm_key_value<Algorithm>::operator longterm_key_view() const
+{
+    return longterm_key_view(raw_);
+}
+
+template <typename Algorithm>
+bool longterm_key_value<Algorithm>::operator==(const longterm_key_value& other) const
+{
+    return 0 == xtt_crypto_memcmp(raw_.data,
+                                  other.raw_.data,
+                                  sizeof(raw_type));
+}
+
+template <typename Algorithm>
+bool longterm_key_value<Algorithm>::operator!=(const longterm_key_value& other) const
+{
+    return !(*this == other);
+}
+
+template <typename Algorithm>
+OPTIONAL_NS::optional<longterm_private_key_value<Algorithm>>
+longterm_private_key_value<Algorithm>::deserialize(const unsigned char* serialized, std::size_t serialized_length)
+{
+    if (sizeof(raw_type) != serialized_length) {
+        return {};
+    }
+
+    longterm_private_key_value ret;
+    ret.raw_ = *reinterpret_cast<const raw_type*>(serialized);
+
+    return ret;
+}
+
+template <typename Algorithm>
+OPTIONAL_NS::optional<longterm_private_key_value<Algorithm>>
+longterm_private_key_value<Algorithm>::deserialize(const std::vector<unsigned char>& serialized)
+{
+    return deserialize(serialized.data(), serialized.size());
+}
+
+template <typename Algorithm>
+OPTIONAL_NS::optional<longterm_private_key_value<Algorithm>>
+longterm_private_key_value<Algorithm>::deserialize(STRING_VIEW_NS::string_view serialized)
+{
+    raw_type raw;
+    if (!text_to_binary(serialized, raw.data, sizeof(raw))) {
+        return {};
+    }
+
+    return deserialize(raw.data, sizeof(raw));
+}
+
+template <typename Algorithm>
+std::size_t longterm_private_key_value<Algorithm>::length() const
+{
+    return sizeof(raw_type);
+}
+
+template <typename Algorithm>
+std::unique_ptr<longterm_private_key> longterm_private_key_value<Algorithm>::clone() const
+{
+    return longterm_private_key_ecdsap256::deserialize(raw_.data, sizeof(raw_type));
+}
+
+template <typename Algorithm>
+std::vector<unsigned char> longterm_private_key_value<Algorithm>::serialize() const
+{
+    return std::vector<unsigned char>(raw_.data, raw_.data+sizeof(raw_type));
+}
+
+template <typename Algorithm>
+std::string longterm_private_key_value<Algorithm>::serialize_to_text() const
+{
+    return binary_to_text(raw_.data, sizeof(raw_type));
+}
+
+template <typename Algorithm>
+const typename longterm_private_key_value<Algorithm>::raw_type* longterm_private_key_value<Algorithm>::get() const
+{
+    return &raw_;
+}
+
+template <typename Algorithm>
+typename longterm_private_key_value<Algorithm>::raw_type* longterm_private_key_value<Algorithm>::get()
+{
+    return &raw_;
+}
+
+template <typename Algorithm>
+bool longterm_private_key_value<Algorithm>::operator==(const longterm_private_key_value& other) const
+{
+    return 0 == xtt_crypto_memcmp(raw_.data,
+                                  other.raw_.data,
+                                  sizeof(raw_type));
+}
+
+template <typename Algorithm>
+bool longterm_private_key_value<Algorithm>::operator!=(const longterm_private_key_value& other) const
+{
+    return !(*this == other);
+}
+
+template class xtt::longterm_key_value<algorithm::ecdsap256>;
+template class xtt::longterm_private_key_value<algorithm::ecdsap256>;
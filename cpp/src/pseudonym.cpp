@@ -23,6 +23,7 @@
 #include <xtt/crypto_wrapper.h>
 
 #include <ostream>
+#include <type_traits>
 
 using namespace xtt;
 
@@ -31,6 +32,11 @@ std::ostream& xtt::operator<<(std::ostream& stream, const xtt::pseudonym& pseud)
     return stream << pseud.serialize_to_text();
 }
 
+std::ostream& xtt::operator<<(std::ostream& stream, const xtt::pseudonym_view& pseud)
+{
+    return stream << pseud.serialize_to_text();
+}
+
 std::unique_ptr<pseudonym>
 pseudonym_lrsw::deserialize(const unsigned char* serialized, std::size_t serialized_length)
 {
@@ -54,9 +60,14 @@ pseudonym_lrsw::deserialize(const std::vector<unsigned char>& serialized)
 }
 
 std::unique_ptr<pseudonym>
-pseudonym_lrsw::deserialize(const std::string& serialized)
+pseudonym_lrsw::deserialize(STRING_VIEW_NS::string_view serialized)
 {
-    return pseudonym_lrsw::deserialize(text_to_binary(serialized));
+    xtt_daa_pseudonym_lrsw raw;
+    if (!text_to_binary(serialized, raw.data, sizeof(raw))) {
+        return {};
+    }
+
+    return pseudonym_lrsw::deserialize(raw.data, sizeof(raw));
 }
 
 std::size_t pseudonym_lrsw::length() const
@@ -104,3 +115,123 @@ bool pseudonym::operator!=(const pseudonym& other) const
     return !(*this == other);
 }
 
+std::unique_ptr<pseudonym> pseudonym_view::clone() const
+{
+    return pseudonym_lrsw::deserialize(data(), length());
+}
+
+std::vector<unsigned char> pseudonym_view::serialize() const
+{
+    return std::vector<unsigned char>(data(), data()+length());
+}
+
+std::string pseudonym_view::serialize_to_text() const
+{
+    return binary_to_text(data(), length());
+}
+
+bool pseudonym_view::operator==(const pseudonym_view& other) const
+{
+    return 0 == xtt_crypto_memcmp(data(),
+                                  other.data(),
+                                  length());
+}
+
+bool pseudonym_view::operator!=(const pseudonym_view& other) const
+{
+    return !(*this == other);
+}
+
+static_assert(std::is_trivially_copyable<pseudonym_lrsw_value>::value,
+              "pseudonym_lrsw_value must be trivially copyable");
+
+template <typename Algorithm>
+OPTIONAL_NS::optional<pseudonym_value<Algorithm>>
+pseudonym_value<Algorithm>::deserialize(const unsigned char* serialized, std::size_t serialized_length)
+{
+    if (sizeof(raw_type) != serialized_length) {
+        return {};
+    }
+
+    pseudonym_value ret;
+    ret.raw_ = *reinterpret_cast<const raw_type*>(serialized);
+
+    return ret;
+}
+
+template <typename Algorithm>
+OPTIONAL_NS::optional<pseudonym_value<Algorithm>>
+pseudonym_value<Algorithm>::deserialize(const std::vector<unsigned char>& serialized)
+{
+    return deserialize(serialized.data(), serialized.size());
+}
+
+template <typename Algorithm>
+OPTIONAL_NS::optional<pseudonym_value<Algorithm>>
+pseudonym_value<Algorithm>::deserialize(STRING_VIEW_NS::string_view serialized)
+{
+    raw_type raw;
+    if (!text_to_binary(serialized, raw.data, sizeof(raw))) {
+        return {};
+    }
+
+    return deserialize(raw.data, sizeof(raw));
+}
+
+template <typename Algorithm>
+std::size_t pseudonym_value<Algorithm>::length() const
+{
+    return sizeof(raw_type);
+}
+
+template <typename Algorithm>
+std::unique_ptr<pseudonym> pseudonym_value<Algorithm>::clone() const
+{
+    return pseudonym_view(*this).clone();
+}
+
+template <typename Algorithm>
+std::vector<unsigned char> pseudonym_value<Algorithm>::serialize() const
+{
+    return std::vector<unsigned char>(raw_.data, raw_.data+sizeof(raw_type));
+}
+
+template <typename Algorithm>
+std::string pseudonym_value<Algorithm>::serialize_to_text() const
+{
+    return binary_to_text(raw_.data, sizeof(raw_type));
+}
+
+template <typename Algorithm>
+const typename pseudonym_value<Algorithm>::raw_type* pseudonym_value<Algorithm>::get() const
+{
+    return &raw_;
+}
+
+template <typename Algorithm>
+typename pseudonym_value<Algorithm>::raw_type* pseudonym_value<Algorithm>::get()
+{
+    return &raw_;
+}
+
+template <typename Algorithm>
+pseudonym_value<Algorithm>::operator pseudonym_view() const
+{
+    return pseudonym_view(raw_);
+}
+
+template <typename Algorithm>
+bool pseudonym_value<Algorithm>::operator==(const pseudonym_value& other) const
+{
+    return 0 == xtt_crypto_memcmp(raw_.data,
+                                  other.raw_.data,
+                                  sizeof(raw_type));
+}
+
+template <typename Algorithm>
+bool pseudonym_value<Algorithm>::operator!=(const pseudonym_value& other) const
+{
+    return !(*this == other);
+}
+
+template class xtt::pseudonym_value<algorithm::lrsw>;
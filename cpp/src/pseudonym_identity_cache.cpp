@@ -0,0 +1,544 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include <xtt/pseudonym_identity_cache.hpp>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+using namespace xtt;
+
+constexpr std::size_t pseudonym_identity_cache::pseudonym_length;
+constexpr std::size_t pseudonym_identity_cache::record_length;
+
+namespace {
+
+    const unsigned char log_magic[8] = {'X', 'T', 'T', 'P', 'N', 'Y', 'M', '1'};
+    constexpr std::size_t header_length = 16;
+
+    constexpr unsigned char record_end = 0x00;
+    constexpr unsigned char record_live = 0xA5;
+    constexpr unsigned char record_erased = 0x5A;
+
+    constexpr std::size_t initial_record_capacity = 1024;
+    constexpr std::size_t min_dead_records_to_compact = 1024;
+
+    constexpr std::size_t checksum_offset = pseudonym_identity_cache::record_length - 4;
+
+    void write_be32(unsigned char* out, std::uint32_t value)
+    {
+        out[0] = static_cast<unsigned char>(value >> 24);
+        out[1] = static_cast<unsigned char>(value >> 16);
+        out[2] = static_cast<unsigned char>(value >> 8);
+        out[3] = static_cast<unsigned char>(value);
+    }
+
+    std::uint32_t read_be32(const unsigned char* in)
+    {
+        return (static_cast<std::uint32_t>(in[0]) << 24)
+            | (static_cast<std::uint32_t>(in[1]) << 16)
+            | (static_cast<std::uint32_t>(in[2]) << 8)
+            | static_cast<std::uint32_t>(in[3]);
+    }
+
+    // FNV-1a, only used to detect a record torn by a crash mid-append
+    std::uint32_t record_checksum(const unsigned char* record)
+    {
+        std::uint32_t hash = 2166136261u;
+        for (std::size_t i = 0; i < checksum_offset; ++i) {
+            hash ^= record[i];
+            hash *= 16777619u;
+        }
+
+        return hash;
+    }
+
+    void encode_record(unsigned char* out,
+                       unsigned char flag,
+                       const unsigned char* pseudonym,
+                       const identity& id)
+    {
+        out[0] = flag;
+        std::copy(pseudonym, pseudonym + pseudonym_identity_cache::pseudonym_length, out + 1);
+        std::copy(id.get()->data,
+                  id.get()->data + sizeof(xtt_identity_type),
+                  out + 1 + pseudonym_identity_cache::pseudonym_length);
+        write_be32(out + checksum_offset, record_checksum(out));
+    }
+
+    void encode_header(unsigned char* out)
+    {
+        std::copy(log_magic, log_magic + sizeof(log_magic), out);
+        write_be32(out + sizeof(log_magic), pseudonym_identity_cache::record_length);
+        write_be32(out + sizeof(log_magic) + 4, 0);
+    }
+
+    bool write_all(int fd, const unsigned char* buf, std::size_t len)
+    {
+        while (len > 0) {
+            ssize_t written = ::write(fd, buf, len);
+            if (written <= 0)
+                return false;
+
+            buf += written;
+            len -= written;
+        }
+
+        return true;
+    }
+
+    // Make a rename of `path` durable
+    bool fsync_parent_directory(const std::string& path)
+    {
+        std::string::size_type slash = path.rfind('/');
+        std::string directory = std::string::npos == slash ? std::string(".")
+                              : 0 == slash                 ? std::string("/")
+                              : path.substr(0, slash);
+
+        int dir_fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (dir_fd < 0) {
+            return false;
+        }
+
+        bool ret = 0 == ::fsync(dir_fd);
+        ::close(dir_fd);
+
+        return ret;
+    }
+
+}   // namespace
+
+std::unique_ptr<pseudonym_identity_cache>
+pseudonym_identity_cache::open(const std::string& path)
+{
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        return {};
+    }
+
+    std::unique_ptr<pseudonym_identity_cache> ret(new pseudonym_identity_cache(path, fd));
+    if (!ret->map_file() || !ret->load()) {
+        return {};
+    }
+
+    return ret;
+}
+
+pseudonym_identity_cache::pseudonym_identity_cache(std::string path, int fd)
+    : path_(std::move(path)),
+      fd_(fd),
+      map_(nullptr),
+      map_length_(0),
+      tail_(header_length),
+      dead_records_(0),
+      index_(),
+      mutex_(),
+      compact_mutex_(),
+      background_compaction_()
+{
+}
+
+pseudonym_identity_cache::~pseudonym_identity_cache()
+{
+    if (background_compaction_.valid())
+        background_compaction_.wait();
+
+    unmap_file();
+
+    if (fd_ >= 0)
+        ::close(fd_);
+}
+
+bool pseudonym_identity_cache::map_file()
+{
+    struct stat st;
+    if (0 != ::fstat(fd_, &st)) {
+        return false;
+    }
+
+    std::size_t file_length = static_cast<std::size_t>(st.st_size);
+    if (0 == file_length) {
+        unsigned char header[header_length];
+        encode_header(header);
+        if (!write_all(fd_, header, sizeof(header))) {
+            return false;
+        }
+
+        file_length = header_length + initial_record_capacity * record_length;
+        if (0 != ::ftruncate(fd_, file_length)) {
+            return false;
+        }
+    } else if (file_length < header_length) {
+        return false;
+    }
+
+    void* mapped = ::mmap(nullptr, file_length, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (MAP_FAILED == mapped) {
+        return false;
+    }
+
+    map_ = static_cast<unsigned char*>(mapped);
+    map_length_ = file_length;
+
+    return true;
+}
+
+void pseudonym_identity_cache::unmap_file()
+{
+    if (map_) {
+        ::munmap(map_, map_length_);
+        map_ = nullptr;
+        map_length_ = 0;
+    }
+}
+
+bool pseudonym_identity_cache::load()
+{
+    if (!std::equal(log_magic, log_magic + sizeof(log_magic), map_) ||
+        record_length != read_be32(map_ + sizeof(log_magic)))
+    {
+        return false;
+    }
+
+    index_.clear();
+    dead_records_ = 0;
+
+    std::size_t offset = header_length;
+    for (; offset + record_length <= map_length_; offset += record_length) {
+        const unsigned char* record = map_ + offset;
+        if (record_end == record[0] ||
+            record_checksum(record) != read_be32(record + checksum_offset))
+        {
+            break;
+        }
+
+        key_type key;
+        std::copy(record + 1, record + 1 + pseudonym_length, key.begin());
+
+        if (record_live == record[0]) {
+            auto id = identity::deserialize(record + 1 + pseudonym_length, sizeof(xtt_identity_type));
+            auto inserted = index_.emplace(key, *id);
+            if (!inserted.second) {
+                inserted.first->second = *id;
+                ++dead_records_;
+            }
+        } else if (record_erased == record[0]) {
+            if (index_.erase(key) > 0) {
+                ++dead_records_;
+            }
+            ++dead_records_;
+        } else {
+            break;
+        }
+    }
+
+    tail_ = offset;
+
+    return true;
+}
+
+bool pseudonym_identity_cache::append_record(unsigned char flag, const key_type& key, const identity& id)
+{
+    if (!map_) {
+        return false;
+    }
+
+    if (tail_ + record_length > map_length_) {
+        std::size_t new_length = header_length + std::max(2 * (map_length_ - header_length),
+                                                          initial_record_capacity * record_length);
+        if (0 != ::ftruncate(fd_, new_length)) {
+            return false;
+        }
+
+        unmap_file();
+        if (!map_file()) {
+            return false;
+        }
+    }
+
+    unsigned char record[record_length];
+    encode_record(record, flag, key.data(), id);
+
+    // Write the flag last, so a partially-written record still reads as the end of the log
+    std::copy(record + 1, record + record_length, map_ + tail_ + 1);
+    map_[tail_] = flag;
+
+    tail_ += record_length;
+
+    return true;
+}
+
+OPTIONAL_NS::optional<identity> pseudonym_identity_cache::find(pseudonym_view nym) const
+{
+    if (pseudonym_length != nym.length()) {
+        return {};
+    }
+
+    key_type key;
+    std::copy(nym.get()->data, nym.get()->data + pseudonym_length, key.begin());
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = index_.find(key);
+    if (index_.end() == it) {
+        return {};
+    }
+
+    return it->second;
+}
+
+bool pseudonym_identity_cache::insert(pseudonym_view nym, const identity& id)
+{
+    if (pseudonym_length != nym.length()) {
+        return false;
+    }
+
+    key_type key;
+    std::copy(nym.get()->data, nym.get()->data + pseudonym_length, key.begin());
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = index_.find(key);
+    if (index_.end() != it && it->second == id) {
+        return true;
+    }
+
+    if (!append_record(record_live, key, id)) {
+        return false;
+    }
+
+    if (index_.end() != it) {
+        it->second = id;
+        ++dead_records_;
+    } else {
+        index_.emplace(key, id);
+    }
+
+    maybe_compact();
+
+    return true;
+}
+
+OPTIONAL_NS::optional<identity>
+pseudonym_identity_cache::try_insert(pseudonym_view nym, const identity& id)
+{
+    if (pseudonym_length != nym.length()) {
+        return {};
+    }
+
+    key_type key;
+    std::copy(nym.get()->data, nym.get()->data + pseudonym_length, key.begin());
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = index_.find(key);
+    if (index_.end() != it) {
+        return it->second;
+    }
+
+    if (!append_record(record_live, key, id)) {
+        return {};
+    }
+
+    index_.emplace(key, id);
+
+    maybe_compact();
+
+    return id;
+}
+
+bool pseudonym_identity_cache::erase(pseudonym_view nym)
+{
+    if (pseudonym_length != nym.length()) {
+        return false;
+    }
+
+    key_type key;
+    std::copy(nym.get()->data, nym.get()->data + pseudonym_length, key.begin());
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = index_.find(key);
+    if (index_.end() == it) {
+        return false;
+    }
+
+    if (!append_record(record_erased, key, identity::null)) {
+        return false;
+    }
+
+    index_.erase(it);
+    dead_records_ += 2;     // the assignment and its tombstone
+
+    maybe_compact();
+
+    return true;
+}
+
+std::size_t pseudonym_identity_cache::size() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    return index_.size();
+}
+
+bool pseudonym_identity_cache::compact()
+{
+    std::lock_guard<std::mutex> compact_lock(compact_mutex_);
+
+    std::vector<unsigned char> contents;
+    std::size_t snapshot_tail;
+    std::size_t snapshot_dead_records;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        contents.resize(header_length + index_.size() * record_length);
+        encode_header(contents.data());
+        unsigned char* record = contents.data() + header_length;
+        for (const auto& entry : index_) {
+            encode_record(record, record_live, entry.first.data(), entry.second);
+            record += record_length;
+        }
+
+        snapshot_tail = tail_;
+        snapshot_dead_records = dead_records_;
+    }
+
+    std::size_t live_records = (contents.size() - header_length) / record_length;
+    std::size_t compact_length = header_length
+                               + std::max(initial_record_capacity, 2 * live_records) * record_length;
+
+    std::string compact_path = path_ + ".compact";
+    int compact_fd = ::open(compact_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (compact_fd < 0) {
+        return false;
+    }
+
+    void* compact_map = MAP_FAILED;
+    if (write_all(compact_fd, contents.data(), contents.size()) &&
+        0 == ::ftruncate(compact_fd, compact_length) &&
+        0 == ::fsync(compact_fd))
+    {
+        compact_map = ::mmap(nullptr, compact_length, PROT_READ | PROT_WRITE, MAP_SHARED, compact_fd, 0);
+    }
+
+    if (MAP_FAILED == compact_map) {
+        ::close(compact_fd);
+        ::unlink(compact_path.c_str());
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        // Carry over whatever was appended while the snapshot was being written.
+        // Like any other append, these only reach the disk on `flush`.
+        std::size_t appended_length = tail_ - snapshot_tail;
+        bool swapped = false;
+        if (map_ && contents.size() + appended_length <= compact_length) {
+            std::copy(map_ + snapshot_tail,
+                      map_ + tail_,
+                      static_cast<unsigned char*>(compact_map) + contents.size());
+            swapped = 0 == ::rename(compact_path.c_str(), path_.c_str());
+        }
+
+        if (!swapped) {
+            // The old log is untouched
+            ::munmap(compact_map, compact_length);
+            ::close(compact_fd);
+            ::unlink(compact_path.c_str());
+            return false;
+        }
+
+        unmap_file();
+        ::close(fd_);
+        fd_ = compact_fd;
+        map_ = static_cast<unsigned char*>(compact_map);
+        map_length_ = compact_length;
+
+        tail_ = contents.size() + appended_length;
+        dead_records_ -= snapshot_dead_records;
+    }
+
+    return fsync_parent_directory(path_);
+}
+
+bool pseudonym_identity_cache::flush()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    return 0 == ::msync(map_, map_length_, MS_SYNC);
+}
+
+void pseudonym_identity_cache::maybe_compact()
+{
+    if (dead_records_ < min_dead_records_to_compact || dead_records_ < index_.size()) {
+        return;
+    }
+
+    if (background_compaction_.valid() &&
+        std::future_status::ready != background_compaction_.wait_for(std::chrono::seconds(0))) {
+        return;
+    }
+
+    // On failure the old log is still intact, so just try again next time
+    background_compaction_ = std::async(std::launch::async,
+                                        [this]()
+                                        {
+                                            (void)compact();
+                                        });
+}
+
+caching_identity_allocator::caching_identity_allocator(identity_allocator& inner,
+                                                       pseudonym_identity_cache& cache)
+    : inner_(inner),
+      cache_(cache)
+{
+}
+
+OPTIONAL_NS::optional<identity>
+caching_identity_allocator::allocate(const group_identity& gid,
+                                     pseudonym_view nym,
+                                     const identity& requested_id)
+{
+    auto cached_id = cache_.find(nym);
+    if (cached_id) {
+        return cached_id;
+    }
+
+    auto assigned_id = inner_.allocate(gid, nym, requested_id);
+    if (!assigned_id) {
+        return {};
+    }
+
+    // Another handshake for this pseudonym may have got there first
+    auto cached_now = cache_.try_insert(nym, *assigned_id);
+    if (cached_now && *cached_now != *assigned_id) {
+        inner_.release(*assigned_id);
+        return cached_now;
+    }
+
+    return assigned_id;
+}
@@ -0,0 +1,117 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include <xtt/pseudonym_revocation_list.hpp>
+
+#include <sodium.h>
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+
+using namespace xtt;
+
+constexpr std::size_t pseudonym_revocation_list::digest_length;
+
+pseudonym_revocation_list::pseudonym_revocation_list()
+    : digests_(new std::vector<digest>()),
+      epoch_(0),
+      readers_{{0}, {0}},
+      assign_mutex_()
+{
+}
+
+pseudonym_revocation_list::pseudonym_revocation_list(const std::vector<pseudonym_lrsw_value>& revoked)
+    : pseudonym_revocation_list()
+{
+    assign(revoked);
+}
+
+pseudonym_revocation_list::~pseudonym_revocation_list()
+{
+    delete digests_.load();
+}
+
+void pseudonym_revocation_list::assign(const std::vector<pseudonym_lrsw_value>& revoked)
+{
+    auto digests = std::make_unique<std::vector<digest>>();
+    digests->reserve(revoked.size());
+    for (const auto& nym : revoked)
+        digests->push_back(make_digest(nym));
+
+    std::sort(digests->begin(), digests->end());
+    digests->erase(std::unique(digests->begin(), digests->end()), digests->end());
+
+    std::lock_guard<std::mutex> lock(assign_mutex_);
+
+    std::unique_ptr<const std::vector<digest>> old(digests_.exchange(digests.release()));
+    wait_for_readers();
+}
+
+bool pseudonym_revocation_list::is_revoked(pseudonym_view nym) const
+{
+    digest nym_digest = make_digest(nym);
+
+    unsigned slot = enter();
+    const std::vector<digest>& digests = *digests_.load();
+    bool ret = std::binary_search(digests.begin(), digests.end(), nym_digest);
+    leave(slot);
+
+    return ret;
+}
+
+std::size_t pseudonym_revocation_list::size() const
+{
+    unsigned slot = enter();
+    std::size_t ret = digests_.load()->size();
+    leave(slot);
+
+    return ret;
+}
+
+unsigned pseudonym_revocation_list::enter() const
+{
+    unsigned slot = epoch_.load() & 1;
+    readers_[slot].fetch_add(1);
+
+    return slot;
+}
+
+void pseudonym_revocation_list::leave(unsigned slot) const
+{
+    readers_[slot].fetch_sub(1);
+}
+
+void pseudonym_revocation_list::wait_for_readers()
+{
+    // A lookup counted in a slot after that slot was seen empty
+    //  loaded `digests_` after the swap, so two flips cover every earlier lookup.
+    for (int i = 0; i < 2; ++i) {
+        unsigned slot = epoch_.fetch_add(1) & 1;
+        while (0 != readers_[slot].load())
+            std::this_thread::yield();
+    }
+}
+
+pseudonym_revocation_list::digest pseudonym_revocation_list::make_digest(pseudonym_view nym)
+{
+    digest ret;
+    crypto_generichash_blake2b(ret.data(), ret.size(), nym.data(), nym.length(), nullptr, 0);
+
+    return ret;
+}
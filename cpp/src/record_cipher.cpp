@@ -0,0 +1,255 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include <xtt/record_cipher.hpp>
+#include <xtt/crypto.hpp>
+#include <xtt/suite_traits.hpp>
+
+#include <sodium.h>
+
+#include <algorithm>
+
+using namespace xtt;
+
+static_assert(crypto_aead_chacha20poly1305_ietf_KEYBYTES == sizeof(record_keys::key) &&
+              crypto_aead_chacha20poly1305_ietf_NPUBBYTES == sizeof(record_keys::iv) &&
+              crypto_aead_chacha20poly1305_ietf_ABYTES == record_cipher::tag_length,
+              "record_keys don't fit ChaCha20-Poly1305");
+
+static_assert(crypto_aead_aes256gcm_KEYBYTES == sizeof(record_keys::key) &&
+              crypto_aead_aes256gcm_NPUBBYTES == sizeof(record_keys::iv) &&
+              crypto_aead_aes256gcm_ABYTES == record_cipher::tag_length,
+              "record_keys don't fit AES-256-GCM");
+
+constexpr std::size_t record_cipher::tag_length;
+
+namespace {
+
+    bool is_available(algorithm::chacha20poly1305)
+    {
+        return true;
+    }
+
+    bool is_available(algorithm::aes256gcm)
+    {
+        // The CPU features are only detected by sodium_init (which may be called repeatedly)
+        return sodium_init() >= 0 && 1 == crypto_aead_aes256gcm_is_available();
+    }
+
+    bool seal_with(algorithm::chacha20poly1305,
+                   unsigned char *data, std::size_t length,
+                   const unsigned char *ad, std::size_t ad_length,
+                   unsigned char *tag,
+                   const unsigned char *nonce,
+                   const unsigned char *key)
+    {
+        return 0 == crypto_aead_chacha20poly1305_ietf_encrypt_detached(data, tag, nullptr,
+                                                                        data, length,
+                                                                        ad, ad_length,
+                                                                        nullptr, nonce, key);
+    }
+
+    bool seal_with(algorithm::aes256gcm,
+                   unsigned char *data, std::size_t length,
+                   const unsigned char *ad, std::size_t ad_length,
+                   unsigned char *tag,
+                   const unsigned char *nonce,
+                   const unsigned char *key)
+    {
+        return 0 == crypto_aead_aes256gcm_encrypt_detached(data, tag, nullptr,
+                                                           data, length,
+                                                           ad, ad_length,
+                                                           nullptr, nonce, key);
+    }
+
+    bool open_with(algorithm::chacha20poly1305,
+                   unsigned char *data, std::size_t length,
+                   const unsigned char *ad, std::size_t ad_length,
+                   const unsigned char *tag,
+                   const unsigned char *nonce,
+                   const unsigned char *key)
+    {
+        return 0 == crypto_aead_chacha20poly1305_ietf_decrypt_detached(data, nullptr,
+                                                                        data, length,
+                                                                        tag,
+                                                                        ad, ad_length,
+                                                                        nonce, key);
+    }
+
+    bool open_with(algorithm::aes256gcm,
+                   unsigned char *data, std::size_t length,
+                   const unsigned char *ad, std::size_t ad_length,
+                   const unsigned char *tag,
+                   const unsigned char *nonce,
+                   const unsigned char *key)
+    {
+        return 0 == crypto_aead_aes256gcm_decrypt_detached(data, nullptr,
+                                                           data, length,
+                                                           tag,
+                                                           ad, ad_length,
+                                                           nonce, key);
+    }
+
+}
+
+OPTIONAL_NS::optional<record_cipher>
+record_cipher::from_keys(suite_spec suite, const record_keys& keys)
+{
+    bool available = visit_suite(suite,
+                                 [](auto traits)
+                                 {
+                                     return is_available(typename decltype(traits)::aead());
+                                 });
+    if (!available)
+        return {};
+
+    return record_cipher(suite, keys);
+}
+
+record_cipher::record_cipher(suite_spec suite, const record_keys& keys)
+    : suite_(suite),
+      keys_(keys),
+      sequence_number_(0)
+{
+}
+
+record_cipher::record_cipher(record_cipher&& other) noexcept
+    : suite_(other.suite_),
+      keys_(other.keys_),
+      sequence_number_(other.sequence_number_)
+{
+    secure_zero(&other.keys_, sizeof(other.keys_));
+}
+
+record_cipher& record_cipher::operator=(record_cipher&& other) noexcept
+{
+    if (this != &other) {
+        suite_ = other.suite_;
+        keys_ = other.keys_;
+        sequence_number_ = other.sequence_number_;
+        secure_zero(&other.keys_, sizeof(other.keys_));
+    }
+
+    return *this;
+}
+
+record_cipher::~record_cipher()
+{
+    secure_zero(&keys_, sizeof(keys_));
+}
+
+suite_spec record_cipher::get_suite_spec() const
+{
+    return suite_;
+}
+
+std::uint64_t record_cipher::get_sequence_number() const
+{
+    return sequence_number_;
+}
+
+void record_cipher::mix_salt(const unsigned char *salt, std::size_t salt_length)
+{
+    static_assert(sizeof(record_keys::key) + sizeof(record_keys::iv) <= crypto_generichash_BYTES_MAX,
+                  "BLAKE2b output is too short for record_keys");
+
+    // BLAKE2b, keyed with the current key, over the current IV and the salt
+    unsigned char derived[sizeof(record_keys::key) + sizeof(record_keys::iv)];
+    crypto_generichash_state h;
+    crypto_generichash_init(&h, keys_.key.data(), keys_.key.size(), sizeof(derived));
+    crypto_generichash_update(&h, keys_.iv.data(), keys_.iv.size());
+    crypto_generichash_update(&h, salt, salt_length);
+    crypto_generichash_final(&h, derived, sizeof(derived));
+
+    std::copy(derived, derived + keys_.key.size(), keys_.key.begin());
+    std::copy(derived + keys_.key.size(), derived + sizeof(derived), keys_.iv.begin());
+    secure_zero(derived, sizeof(derived));
+    secure_zero(&h, sizeof(h));
+
+    sequence_number_ = 0;
+}
+
+bool record_cipher::shares_key_with(const record_cipher& other) const
+{
+    return 0 == sodium_memcmp(keys_.key.data(), other.keys_.key.data(), keys_.key.size());
+}
+
+bool record_cipher::seal(unsigned char *data,
+                         std::size_t length,
+                         const unsigned char *ad,
+                         std::size_t ad_length,
+                         unsigned char *tag)
+{
+    unsigned char nonce[sizeof(record_keys::iv)];
+    make_nonce(nonce);
+
+    bool sealed = visit_suite(suite_,
+                              [&](auto traits)
+                              {
+                                  return seal_with(typename decltype(traits)::aead(),
+                                                   data, length,
+                                                   ad, ad_length,
+                                                   tag,
+                                                   nonce,
+                                                   keys_.key.data());
+                              });
+    if (!sealed)
+        return false;
+
+    ++sequence_number_;
+
+    return true;
+}
+
+bool record_cipher::open(unsigned char *data,
+                         std::size_t length,
+                         const unsigned char *ad,
+                         std::size_t ad_length,
+                         const unsigned char *tag)
+{
+    unsigned char nonce[sizeof(record_keys::iv)];
+    make_nonce(nonce);
+
+    bool opened = visit_suite(suite_,
+                              [&](auto traits)
+                              {
+                                  return open_with(typename decltype(traits)::aead(),
+                                                   data, length,
+                                                   ad, ad_length,
+                                                   tag,
+                                                   nonce,
+                                                   keys_.key.data());
+                              });
+    if (!opened)
+        return false;
+
+    ++sequence_number_;
+
+    return true;
+}
+
+void record_cipher::make_nonce(unsigned char *nonce) const
+{
+    // The sequence number is XOR-ed, big-endian, into the last 8 bytes of the IV
+    constexpr std::size_t offset = sizeof(record_keys::iv) - sizeof(sequence_number_);
+    for (std::size_t i = 0; i < sizeof(record_keys::iv); ++i) {
+        nonce[i] = keys_.iv[i];
+        if (i >= offset)
+            nonce[i] ^= static_cast<unsigned char>(sequence_number_ >> (8 * (sizeof(record_keys::iv) - 1 - i)));
+    }
+}
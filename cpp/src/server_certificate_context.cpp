@@ -21,12 +21,72 @@
 #include "internal/text_to_binary.hpp"
 
 #include <cassert>
+#include <type_traits>
 
 using namespace xtt;
 
 const unsigned char server_certificate_ecdsap256_dummy[XTT_SERVER_CERTIFICATE_ECDSAP256_LENGTH] = {0};
 const xtt_ecdsap256_priv_key server_privatekey_ecdsap256_dummy = {{0}};
 
+namespace {
+
+    bool initialize_ecdsap256(xtt_server_certificate_context* certificate_ctx,
+                              const unsigned char* certificate,
+                              std::size_t certificate_length,
+                              const unsigned char* private_key,
+                              std::size_t private_key_length)
+    {
+        if (XTT_SERVER_CERTIFICATE_ECDSAP256_LENGTH != certificate_length ||
+            sizeof(xtt_ecdsap256_priv_key) != private_key_length)
+        {
+            return false;
+        }
+
+        xtt_return_code_type ctor_ret =
+            xtt_initialize_server_certificate_context_ecdsap256(certificate_ctx,
+                                                              certificate,
+                                                              reinterpret_cast<const xtt_ecdsap256_priv_key*>(private_key));
+
+        return XTT_RETURN_SUCCESS == ctor_ret;
+    }
+
+    bool initialize_ecdsap256(xtt_server_certificate_context* certificate_ctx,
+                              STRING_VIEW_NS::string_view certificate,
+                              STRING_VIEW_NS::string_view private_key)
+    {
+        unsigned char certificate_bytes[XTT_SERVER_CERTIFICATE_ECDSAP256_LENGTH];
+        xtt_ecdsap256_priv_key private_key_bytes;
+
+        if (!text_to_binary(certificate, certificate_bytes, sizeof(certificate_bytes)) ||
+            !text_to_binary(private_key, private_key_bytes.data, sizeof(private_key_bytes))) {
+            return false;
+        }
+
+        return initialize_ecdsap256(certificate_ctx,
+                                    certificate_bytes, sizeof(certificate_bytes),
+                                    private_key_bytes.data, sizeof(private_key_bytes));
+    }
+
+    void initialize_ecdsap256_dummy(xtt_server_certificate_context* certificate_ctx)
+    {
+        xtt_return_code_type ctor_ret =
+            xtt_initialize_server_certificate_context_ecdsap256(certificate_ctx,
+                                                              server_certificate_ecdsap256_dummy,
+                                                              &server_privatekey_ecdsap256_dummy);
+        (void)ctor_ret;
+        assert(XTT_RETURN_SUCCESS == ctor_ret);
+    }
+
+    void copy_context(xtt_server_certificate_context* to, const xtt_server_certificate_context& from)
+    {
+        *to = from;
+
+        // Internal buffer pointers must be explicitly reset
+        to->serialized_certificate = (struct xtt_server_certificate_raw_type*)to->serialized_certificate_raw;
+    }
+
+}
+
 std::unique_ptr<server_certificate_context>
 server_certificate_context_ecdsap256::deserialize(const unsigned char* serialized, std::size_t serialized_length)
 {
@@ -37,12 +97,8 @@ server_certificate_context_ecdsap256::deserialize(const unsigned char* serialize
         return {};
     }
 
-    const unsigned char* cert_begin = serialized;
-
-    const unsigned char* key_begin = serialized + cert_len;
-
-    return from_certificate_and_key(std::vector<unsigned char>(cert_begin, cert_begin + cert_len),
-                                    std::vector<unsigned char>(key_begin, key_begin + key_len));
+    return from_certificate_and_key(serialized, cert_len,
+                                    serialized + cert_len, key_len);
 }
 
 std::unique_ptr<server_certificate_context>
@@ -52,62 +108,69 @@ server_certificate_context_ecdsap256::deserialize(const std::vector<unsigned cha
 }
 
 std::unique_ptr<server_certificate_context>
-server_certificate_context_ecdsap256::from_certificate_and_key(const std::vector<unsigned char>& certificate,
-                                                             const std::vector<unsigned char>& private_key)
+server_certificate_context_ecdsap256::from_certificate_and_key(const unsigned char* certificate,
+                                                             std::size_t certificate_length,
+                                                             const unsigned char* private_key,
+                                                             std::size_t private_key_length)
 {
-    if (XTT_SERVER_CERTIFICATE_ECDSAP256_LENGTH != certificate.size() ||
-        sizeof(xtt_ecdsap256_priv_key) != private_key.size())
-    {
+    std::unique_ptr<server_certificate_context> ret(new server_certificate_context_ecdsap256(uninitialized()));
+
+    if (!initialize_ecdsap256(ret->get(),
+                              certificate, certificate_length,
+                              private_key, private_key_length)) {
         return {};
     }
 
-    auto ret = std::make_unique<server_certificate_context_ecdsap256>();
-    if (!ret)
-        return {};
+    return ret;
+}
+
+std::unique_ptr<server_certificate_context>
+server_certificate_context_ecdsap256::from_certificate_and_key(const std::vector<unsigned char>& certificate,
+                                                             const std::vector<unsigned char>& private_key)
+{
+    return from_certificate_and_key(certificate.data(), certificate.size(),
+                                    private_key.data(), private_key.size());
+}
 
-    xtt_return_code_type ctor_ret =
-        xtt_initialize_server_certificate_context_ecdsap256(ret->get(),
-                                                          certificate.data(),
-                                                          reinterpret_cast<const xtt_ecdsap256_priv_key*>(private_key.data()));
-    if (XTT_RETURN_SUCCESS != ctor_ret) {
+std::unique_ptr<server_certificate_context>
+server_certificate_context_ecdsap256::from_certificate_and_key(STRING_VIEW_NS::string_view certificate,
+                                                             STRING_VIEW_NS::string_view private_key)
+{
+    std::unique_ptr<server_certificate_context> ret(new server_certificate_context_ecdsap256(uninitialized()));
+
+    if (!initialize_ecdsap256(ret->get(), certificate, private_key)) {
         return {};
     }
 
-    return std::move(ret);
+    return ret;
 }
 
-std::unique_ptr<server_certificate_context>
-server_certificate_context_ecdsap256::from_certificate_and_key(const std::string& certificate,
-                                                             const std::string& private_key)
+server_certificate_context_ecdsap256::server_certificate_context_ecdsap256()
 {
-    return server_certificate_context_ecdsap256::from_certificate_and_key(text_to_binary(certificate),
-                                                                        text_to_binary(private_key));
+    initialize_ecdsap256_dummy(&certificate_ctx_);
 }
 
-server_certificate_context_ecdsap256::server_certificate_context_ecdsap256()
+server_certificate_context_ecdsap256::server_certificate_context_ecdsap256(uninitialized) noexcept
 {
-    xtt_return_code_type ctor_ret =
-        xtt_initialize_server_certificate_context_ecdsap256(&certificate_ctx_,
-                                                          server_certificate_ecdsap256_dummy,
-                                                          &server_privatekey_ecdsap256_dummy);
-    (void)ctor_ret;
-    assert(XTT_RETURN_SUCCESS == ctor_ret);
 }
 
-server_certificate_context_ecdsap256::server_certificate_context_ecdsap256(const server_certificate_context_ecdsap256& other)
-    : certificate_ctx_(other.certificate_ctx_)
+server_certificate_context_ecdsap256::server_certificate_context_ecdsap256(const xtt_server_certificate_context& certificate_ctx) noexcept
 {
-    // Internal buffer pointers must be explicitly reset
-    certificate_ctx_.serialized_certificate = (struct xtt_server_certificate_raw_type*)certificate_ctx_.serialized_certificate_raw;
+    copy_context(&certificate_ctx_, certificate_ctx);
 }
 
-server_certificate_context_ecdsap256::server_certificate_context_ecdsap256(server_certificate_context_ecdsap256&& other)
-    : server_certificate_context_ecdsap256()
+server_certificate_context_ecdsap256::server_certificate_context_ecdsap256(const server_certificate_context_ecdsap256& other) noexcept
+    : server_certificate_context_ecdsap256(other.certificate_ctx_)
+{
+}
+
+// The context owns no resources, so moving is copying
+server_certificate_context_ecdsap256::server_certificate_context_ecdsap256(server_certificate_context_ecdsap256&& other) noexcept
+    : server_certificate_context_ecdsap256(other.certificate_ctx_)
 {
-    swap(*this, other);
 }
 
-server_certificate_context_ecdsap256& server_certificate_context_ecdsap256::operator=(server_certificate_context_ecdsap256 other)
+server_certificate_context_ecdsap256& server_certificate_context_ecdsap256::operator=(server_certificate_context_ecdsap256 other) noexcept
 {
     swap(*this, other);
 
@@ -184,3 +247,158 @@ void swap(server_certificate_context_ecdsap256& first, server_certificate_contex
     first.certificate_ctx_.serialized_certificate = (struct xtt_server_certificate_raw_type*)first.certificate_ctx_.serialized_certificate_raw;
     second.certificate_ctx_.serialized_certificate = (struct xtt_server_certificate_raw_type*)second.certificate_ctx_.serialized_certificate_raw;
 }
+
+static_assert(std::is_nothrow_move_constructible<server_certificate_context_ecdsap256>::value,
+              "server_certificate_context_ecdsap256 must be nothrow-movable");
+
+static_assert(std::is_nothrow_move_constructible<server_certificate_context_ecdsap256_value>::value,
+              "server_certificate_context_ecdsap256_value must be nothrow-movable");
+
+template <typename Algorithm>
+OPTIONAL_NS::optional<server_certificate_context_value<Algorithm>>
+server_certificate_context_value<Algorithm>::deserialize(const unsigned char* serialized, std::size_t serialized_length)
+{
+    size_t cert_len = XTT_SERVER_CERTIFICATE_ECDSAP256_LENGTH;
+    size_t key_len = sizeof(xtt_ecdsap256_priv_key);
+
+    if (serialized_length < (cert_len + key_len)) {
+        return {};
+    }
+
+    return from_certificate_and_key(serialized, cert_len,
+                                    serialized + cert_len, key_len);
+}
+
+template <typename Algorithm>
+OPTIONAL_NS::optional<server_certificate_context_value<Algorithm>>
+server_certificate_context_value<Algorithm>::deserialize(const std::vector<unsigned char>& serialized)
+{
+    return deserialize(serialized.data(), serialized.size());
+}
+
+template <typename Algorithm>
+OPTIONAL_NS::optional<server_certificate_context_value<Algorithm>>
+server_certificate_context_value<Algorithm>::from_certificate_and_key(const unsigned char* certificate,
+                                                                      std::size_t certificate_length,
+                                                                      const unsigned char* private_key,
+                                                                      std::size_t private_key_length)
+{
+    xtt_server_certificate_context certificate_ctx;
+    if (!initialize_ecdsap256(&certificate_ctx,
+                              certificate, certificate_length,
+                              private_key, private_key_length)) {
+        return {};
+    }
+
+    return server_certificate_context_value(certificate_ctx);
+}
+
+template <typename Algorithm>
+OPTIONAL_NS::optional<server_certificate_context_value<Algorithm>>
+server_certificate_context_value<Algorithm>::from_certificate_and_key(const std::vector<unsigned char>& certificate,
+                                                                      const std::vector<unsigned char>& private_key)
+{
+    return from_certificate_and_key(certificate.data(), certificate.size(),
+                                    private_key.data(), private_key.size());
+}
+
+template <typename Algorithm>
+OPTIONAL_NS::optional<server_certificate_context_value<Algorithm>>
+server_certificate_context_value<Algorithm>::from_certificate_and_key(STRING_VIEW_NS::string_view certificate,
+                                                                      STRING_VIEW_NS::string_view private_key)
+{
+    xtt_server_certificate_context certificate_ctx;
+    if (!initialize_ecdsap256(&certificate_ctx, certificate, private_key)) {
+        return {};
+    }
+
+    return server_certificate_context_value(certificate_ctx);
+}
+
+template <typename Algorithm>
+server_certificate_context_value<Algorithm>::server_certificate_context_value()
+{
+    initialize_ecdsap256_dummy(&certificate_ctx_);
+}
+
+template <typename Algorithm>
+server_certificate_context_value<Algorithm>::server_certificate_context_value(const xtt_server_certificate_context& certificate_ctx) noexcept
+{
+    copy_context(&certificate_ctx_, certificate_ctx);
+}
+
+template <typename Algorithm>
+server_certificate_context_value<Algorithm>::server_certificate_context_value(const server_certificate_context_value& other) noexcept
+{
+    copy_context(&certificate_ctx_, other.certificate_ctx_);
+}
+
+template <typename Algorithm>
+server_certificate_context_value<Algorithm>&
+server_certificate_context_value<Algorithm>::operator=(const server_certificate_context_value& other) noexcept
+{
+    copy_context(&certificate_ctx_, other.certificate_ctx_);
+
+    return *this;
+}
+
+template <typename Algorithm>
+std::unique_ptr<server_certificate_context> server_certificate_context_value<Algorithm>::clone() const
+{
+    return std::unique_ptr<server_certificate_context>(new server_certificate_context_ecdsap256(certificate_ctx_));
+}
+
+template <typename Algorithm>
+std::vector<unsigned char> server_certificate_context_value<Algorithm>::serialize() const
+{
+    std::vector<unsigned char> ret{get_certificate()};
+    std::vector<unsigned char> priv_key{get_private_key()};
+
+    ret.insert(ret.end(), priv_key.begin(), priv_key.end());
+
+    return ret;
+}
+
+template <typename Algorithm>
+std::vector<unsigned char> server_certificate_context_value<Algorithm>::get_certificate() const
+{
+    size_t cert_len = XTT_SERVER_CERTIFICATE_ECDSAP256_LENGTH;
+
+    return std::vector<unsigned char>(certificate_ctx_.serialized_certificate_raw,
+                                      certificate_ctx_.serialized_certificate_raw + cert_len);
+}
+
+template <typename Algorithm>
+std::vector<unsigned char> server_certificate_context_value<Algorithm>::get_private_key() const
+{
+    size_t key_len = sizeof(xtt_ecdsap256_priv_key);
+
+    return std::vector<unsigned char>(certificate_ctx_.private_key.ecdsap256.data,
+                                      certificate_ctx_.private_key.ecdsap256.data + key_len);
+}
+
+template <typename Algorithm>
+std::string server_certificate_context_value<Algorithm>::get_certificate_as_text() const
+{
+    return binary_to_text(certificate_ctx_.serialized_certificate_raw, XTT_SERVER_CERTIFICATE_ECDSAP256_LENGTH);
+}
+
+template <typename Algorithm>
+std::string server_certificate_context_value<Algorithm>::get_private_key_as_text() const
+{
+    return binary_to_text(certificate_ctx_.private_key.ecdsap256.data, sizeof(xtt_ecdsap256_priv_key));
+}
+
+template <typename Algorithm>
+struct xtt_server_certificate_context* server_certificate_context_value<Algorithm>::get()
+{
+    return &certificate_ctx_;
+}
+
+template <typename Algorithm>
+const struct xtt_server_certificate_context* server_certificate_context_value<Algorithm>::get() const
+{
+    return &certificate_ctx_;
+}
+
+template class xtt::server_certificate_context_value<algorithm::ecdsap256>;
@@ -17,11 +17,30 @@
  *****************************************************************************/
 
 #include <xtt/server_handshake_context.hpp>
+#include <xtt/crypto.hpp>
+#include <xtt/suite_traits.hpp>
 
 #include <stdexcept>
+#include <type_traits>
 
 using namespace xtt;
 
+namespace {
+
+    xtt_return_code_type get_clients_pseudonym_raw(xtt_daa_pseudonym_lrsw* out,
+                                                   const struct xtt_server_handshake_context* ctx)
+    {
+        return xtt_get_clients_pseudonym_lrsw(out, ctx);
+    }
+
+    xtt_return_code_type get_clients_longterm_key_raw(xtt_ecdsap256_pub_key* out,
+                                                      const struct xtt_server_handshake_context* ctx)
+    {
+        return xtt_get_clients_longterm_key_ecdsap256(out, ctx);
+    }
+
+}
+
 server_handshake_context::server_handshake_context(unsigned char *in_buffer,
                                                    uint16_t in_buffer_size,
                                                    unsigned char *out_buffer,
@@ -67,46 +86,58 @@ std::unique_ptr<pseudonym> server_handshake_context::get_clients_pseudonym() con
     if (!suite_spec_opt)
         return {};
 
-    switch (*suite_spec_opt) {
-        case suite_spec::X25519_LRSW_ECDSAP256_CHACHA20POLY1305_SHA512:
-        case suite_spec::X25519_LRSW_ECDSAP256_CHACHA20POLY1305_BLAKE2B:
-        case suite_spec::X25519_LRSW_ECDSAP256_AES256GCM_SHA512:
-        case suite_spec::X25519_LRSW_ECDSAP256_AES256GCM_BLAKE2B:
-            {
-                auto ret = std::make_unique<pseudonym_lrsw>();
-                if (XTT_RETURN_SUCCESS != xtt_get_clients_pseudonym_lrsw(ret->get(), &handshake_ctx_)) {
-                    return {};
-                }
-
-                return std::move(ret);
-            }
-        default:
-            return {};
-    }
+    return visit_suite(*suite_spec_opt,
+                       [this](auto traits) -> std::unique_ptr<pseudonym>
+                       {
+                           pseudonym_value<typename decltype(traits)::daa> ret;
+                           if (XTT_RETURN_SUCCESS != get_clients_pseudonym_raw(ret.get(), &handshake_ctx_)) {
+                               return {};
+                           }
+
+                           return ret.clone();
+                       });
+}
+
+bool server_handshake_context::get_clients_pseudonym(pseudonym_lrsw& out) const
+{
+    return XTT_RETURN_SUCCESS == xtt_get_clients_pseudonym_lrsw(out.get(), &handshake_ctx_);
+}
+
+template <typename Algorithm>
+bool server_handshake_context::get_clients_pseudonym(pseudonym_value<Algorithm>& out) const
+{
+    auto suite_spec_opt = get_suite_spec();
+    if (!suite_spec_opt)
+        return false;
+
+    return visit_suite(*suite_spec_opt,
+                       [this, &out](auto traits) -> bool
+                       {
+                           if (!std::is_same<typename decltype(traits)::daa, Algorithm>::value)
+                               return false;
+
+                           return XTT_RETURN_SUCCESS == get_clients_pseudonym_raw(out.get(), &handshake_ctx_);
+                       });
 }
 
+template bool server_handshake_context::get_clients_pseudonym(pseudonym_value<algorithm::lrsw>&) const;
+
 std::unique_ptr<longterm_key> server_handshake_context::get_clients_longterm_key() const
 {
     auto suite_spec_opt = get_suite_spec();
     if (!suite_spec_opt)
         return {};
 
-    switch (*suite_spec_opt) {
-        case suite_spec::X25519_LRSW_ECDSAP256_CHACHA20POLY1305_SHA512:
-        case suite_spec::X25519_LRSW_ECDSAP256_CHACHA20POLY1305_BLAKE2B:
-        case suite_spec::X25519_LRSW_ECDSAP256_AES256GCM_SHA512:
-        case suite_spec::X25519_LRSW_ECDSAP256_AES256GCM_BLAKE2B:
-            {
-                auto ret = std::make_unique<longterm_key_ecdsap256>();
-                if (XTT_RETURN_SUCCESS != xtt_get_clients_longterm_key_ecdsap256(ret->get(), &handshake_ctx_)) {
-                    return {};
-                }
-
-                return std::move(ret);
-            }
-        default:
-            return {};
-    }
+    return visit_suite(*suite_spec_opt,
+                       [this](auto traits) -> std::unique_ptr<longterm_key>
+                       {
+                           longterm_key_value<typename decltype(traits)::signature> ret;
+                           if (XTT_RETURN_SUCCESS != get_clients_longterm_key_raw(ret.get(), &handshake_ctx_)) {
+                               return {};
+                           }
+
+                           return ret.clone();
+                       });
 }
 
 OPTIONAL_NS::optional<identity> server_handshake_context::get_clients_identity() const
@@ -119,6 +150,44 @@ OPTIONAL_NS::optional<identity> server_handshake_context::get_clients_identity()
     return identity::deserialize(std::vector<unsigned char>(assigned_identity.data, assigned_identity.data + sizeof(xtt_identity_type)));
 }
 
+OPTIONAL_NS::optional<handshake_result> server_handshake_context::get_handshake_result() const
+{
+    auto suite_spec_opt = get_suite_spec();
+    if (!suite_spec_opt)
+        return {};
+
+    handshake_result ret;
+    ret.suite = *suite_spec_opt;
+
+    if (XTT_RETURN_SUCCESS != xtt_get_clients_identity(ret.clients_identity.get(), &handshake_ctx_))
+        return {};
+
+    return visit_suite(*suite_spec_opt,
+                       [this, &ret](auto traits) -> OPTIONAL_NS::optional<handshake_result>
+                       {
+                           using traits_type = decltype(traits);
+                           static_assert(std::is_same<typename algorithm_traits<typename traits_type::daa>::pseudonym_type,
+                                                      decltype(ret.clients_pseudonym_raw)>::value,
+                                         "handshake_result cannot hold this suite's pseudonym");
+                           static_assert(std::is_same<typename algorithm_traits<typename traits_type::signature>::public_key_type,
+                                                      decltype(ret.clients_longterm_key_raw)>::value,
+                                         "handshake_result cannot hold this suite's longterm key");
+
+                           if (XTT_RETURN_SUCCESS != get_clients_pseudonym_raw(&ret.clients_pseudonym_raw, &handshake_ctx_))
+                               return {};
+
+                           if (XTT_RETURN_SUCCESS != get_clients_longterm_key_raw(&ret.clients_longterm_key_raw, &handshake_ctx_))
+                               return {};
+
+                           return ret;
+                       });
+}
+
+void server_handshake_context::wipe()
+{
+    secure_zero(&handshake_ctx_, sizeof(handshake_ctx_));
+}
+
 const struct xtt_server_handshake_context* server_handshake_context::get() const
 {
     return &handshake_ctx_;
@@ -179,14 +248,15 @@ return_code server_handshake_context::preparse_idclientattest(io_buffer& io_buf,
 }
 
 return_code server_handshake_context::verify_groupsignature(io_buffer& io_buf,
-                                                            group_public_key_context& group_pub_key_ctx,
+                                                            const group_public_key_context& group_pub_key_ctx,
                                                             const server_certificate_context& certificate_ctx)
 {
-xtt_return_code_type ret = xtt_handshake_server_verify_groupsignature(&io_buf.len,
-                                                                      &io_buf.ptr,
-                                                                      group_pub_key_ctx.get(),
-                                                                      certificate_ctx.get(),
-                                                                      &handshake_ctx_);
+    // libxtt only reads the GPK, but doesn't take it as const
+    xtt_return_code_type ret = xtt_handshake_server_verify_groupsignature(&io_buf.len,
+                                                                          &io_buf.ptr,
+                                                                          const_cast<xtt_group_public_key_context*>(group_pub_key_ctx.get()),
+                                                                          certificate_ctx.get(),
+                                                                          &handshake_ctx_);
     return static_cast<return_code>(ret);
 }
 
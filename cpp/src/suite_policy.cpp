@@ -0,0 +1,100 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include <xtt/suite_policy.hpp>
+#include <xtt/suite_traits.hpp>
+
+#include <sodium.h>
+
+#include <algorithm>
+#include <type_traits>
+
+using namespace xtt;
+
+namespace {
+
+    bool is_known(suite_spec suite)
+    {
+        return visit_suite(suite, [](auto) { return true; });
+    }
+
+    std::vector<suite_spec> known_suites()
+    {
+        std::vector<suite_spec> ret;
+        for_each_suite([&ret](auto traits) { ret.push_back(traits.value); });
+        return ret;
+    }
+
+}
+
+suite_policy::suite_policy()
+    : preference_order_(known_suites())
+{
+}
+
+suite_policy::suite_policy(const std::vector<suite_spec>& preference_order)
+    : preference_order_()
+{
+    for (auto suite : preference_order) {
+        if (is_known(suite) && !is_allowed(suite))
+            preference_order_.push_back(suite);
+    }
+}
+
+suite_policy suite_policy::from_cpu_features()
+{
+    // The CPU features are only detected by sodium_init (which may be called repeatedly)
+    bool have_aesni = (sodium_init() >= 0 && 1 == crypto_aead_aes256gcm_is_available());
+
+    std::vector<suite_spec> aes;
+    std::vector<suite_spec> chacha;
+    for_each_suite([&](auto traits)
+                   {
+                       using aead = typename decltype(traits)::aead;
+                       if (std::is_same<aead, algorithm::aes256gcm>::value)
+                           aes.push_back(traits.value);
+                       else
+                           chacha.push_back(traits.value);
+                   });
+
+    if (!have_aesni)
+        return suite_policy(chacha);
+
+    aes.insert(aes.end(), chacha.begin(), chacha.end());
+    return suite_policy(aes);
+}
+
+bool suite_policy::is_allowed(suite_spec suite) const
+{
+    return preference_order_.end() != std::find(preference_order_.begin(), preference_order_.end(), suite);
+}
+
+const std::vector<suite_spec>& suite_policy::get_preference_order() const
+{
+    return preference_order_;
+}
+
+OPTIONAL_NS::optional<suite_spec> suite_policy::choose(const std::vector<suite_spec>& offered) const
+{
+    for (auto suite : preference_order_) {
+        if (offered.end() != std::find(offered.begin(), offered.end(), suite))
+            return suite;
+    }
+
+    return {};
+}
@@ -0,0 +1,210 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include <xtt/value_array.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace xtt;
+
+namespace {
+
+    /*
+     * Index of the first of `fingerprints[from, count)` equal to `needle`, or `count`.
+     */
+    std::size_t scan_fingerprints(const std::uint64_t* fingerprints,
+                                  std::size_t count,
+                                  std::size_t from,
+                                  std::uint64_t needle)
+    {
+        std::size_t i = from;
+
+#if defined(__SSE2__)
+        // Four fingerprints per iteration; SSE2 has no 64-bit compare,
+        // so a lane matches when both of its 32-bit halves do.
+        const __m128i needles = _mm_set1_epi64x(static_cast<long long>(needle));
+        for (; i + 4 <= count; i += 4) {
+            int low = _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(fingerprints + i)),
+                                                        needles));
+            int high = _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(fingerprints + i + 2)),
+                                                         needles));
+            if (0 == (low | high))
+                continue;
+
+            if (0x00FF == (low & 0x00FF))
+                return i;
+            if (0xFF00 == (low & 0xFF00))
+                return i + 1;
+            if (0x00FF == (high & 0x00FF))
+                return i + 2;
+            if (0xFF00 == (high & 0xFF00))
+                return i + 3;
+        }
+#endif
+
+        for (; i < count; ++i) {
+            if (fingerprints[i] == needle)
+                return i;
+        }
+
+        return count;
+    }
+
+}
+
+template <typename Raw, typename View>
+OPTIONAL_NS::optional<value_array<Raw, View>>
+value_array<Raw, View>::deserialize(const unsigned char* serialized, std::size_t serialized_length)
+{
+    if (0 != serialized_length % value_length)
+        return {};
+
+    value_array ret;
+    std::size_t count = serialized_length / value_length;
+    ret.values_.resize(count);
+    std::memcpy(ret.values_.data(), serialized, serialized_length);
+
+    ret.fingerprints_.reserve(count);
+    for (const auto& value : ret.values_)
+        ret.fingerprints_.push_back(fingerprint(value.data));
+
+    return ret;
+}
+
+template <typename Raw, typename View>
+OPTIONAL_NS::optional<value_array<Raw, View>>
+value_array<Raw, View>::deserialize(const std::vector<unsigned char>& serialized)
+{
+    return deserialize(serialized.data(), serialized.size());
+}
+
+template <typename Raw, typename View>
+void value_array<Raw, View>::reserve(std::size_t count)
+{
+    values_.reserve(count);
+    fingerprints_.reserve(count);
+}
+
+template <typename Raw, typename View>
+void value_array<Raw, View>::push_back(View value)
+{
+    values_.push_back(*value.get());
+    fingerprints_.push_back(fingerprint(value.data()));
+}
+
+template <typename Raw, typename View>
+std::size_t value_array<Raw, View>::size() const
+{
+    return values_.size();
+}
+
+template <typename Raw, typename View>
+bool value_array<Raw, View>::empty() const
+{
+    return values_.empty();
+}
+
+template <typename Raw, typename View>
+View value_array<Raw, View>::operator[](std::size_t index) const
+{
+    return View(values_[index]);
+}
+
+template <typename Raw, typename View>
+const unsigned char* value_array<Raw, View>::data() const
+{
+    return reinterpret_cast<const unsigned char*>(values_.data());
+}
+
+template <typename Raw, typename View>
+std::vector<unsigned char> value_array<Raw, View>::serialize() const
+{
+    return std::vector<unsigned char>(data(), data() + values_.size() * value_length);
+}
+
+template <typename Raw, typename View>
+std::size_t value_array<Raw, View>::find(View value) const
+{
+    std::uint64_t needle = fingerprint(value.data());
+
+    std::size_t i = 0;
+    while ((i = scan_fingerprints(fingerprints_.data(), fingerprints_.size(), i, needle)) < fingerprints_.size()) {
+        if (0 == std::memcmp(values_[i].data, value.data(), value_length))
+            return i;
+        ++i;
+    }
+
+    return npos;
+}
+
+template <typename Raw, typename View>
+void value_array<Raw, View>::sort()
+{
+    std::vector<std::size_t> order(values_.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(),
+              [this](std::size_t lhs, std::size_t rhs)
+              {
+                  return std::memcmp(values_[lhs].data, values_[rhs].data, value_length) < 0;
+              });
+
+    std::vector<Raw> values;
+    std::vector<std::uint64_t> fingerprints;
+    values.reserve(values_.size());
+    fingerprints.reserve(fingerprints_.size());
+    for (std::size_t i : order) {
+        values.push_back(values_[i]);
+        fingerprints.push_back(fingerprints_[i]);
+    }
+
+    values_ = std::move(values);
+    fingerprints_ = std::move(fingerprints);
+}
+
+template <typename Raw, typename View>
+std::size_t value_array<Raw, View>::sorted_find(View value) const
+{
+    auto it = std::lower_bound(values_.begin(), values_.end(), value,
+                               [](const Raw& element, View target)
+                               {
+                                   return std::memcmp(element.data, target.data(), value_length) < 0;
+                               });
+    if (values_.end() == it || 0 != std::memcmp(it->data, value.data(), value_length))
+        return npos;
+
+    return static_cast<std::size_t>(it - values_.begin());
+}
+
+template <typename Raw, typename View>
+std::uint64_t value_array<Raw, View>::fingerprint(const unsigned char* value)
+{
+    // The last bytes, as the first byte of an encoded curve point is mostly constant
+    std::uint64_t ret;
+    std::memcpy(&ret, value + value_length - sizeof(ret), sizeof(ret));
+
+    return ret;
+}
+
+template class xtt::value_array<xtt_daa_pseudonym_lrsw, pseudonym_view>;
+template class xtt::value_array<xtt_ecdsap256_pub_key, longterm_key_view>;
@@ -22,41 +22,124 @@
 
 #include <boost/asio.hpp>
 
+#include <csignal>
+#include <cstdio>
 #include <cstdlib>
 
+#include <chrono>
 #include <iostream>
 #include <fstream>
 #include <memory>
+#include <string>
 
 const char *daa_gpk_file = "daa_gpk.bin";
 const char *basename_file = "basename.bin";
 const char *server_certificate_file = "server_certificate.bin";
 const char *server_privatekey_file = "server_privatekey.bin";
 
+// Returns nullptr on error
+std::shared_ptr<const xtt::asio::server_configuration> load_configuration();
+
 class xtt_server {
 public:
     xtt_server(boost::asio::io_context& io_context,
-               short port,
-               const std::vector<unsigned char>& certificate,
-               const std::vector<unsigned char>& private_key,
-               xtt::server_cookie_context& cookie_ctx,
-               std::unordered_map<xtt::group_identity, std::unique_ptr<xtt::group_public_key_context>>& gpk_map)
-        : acceptor_(io_context, boost::asio::ip::tcp::endpoint(boost::asio::ip::tcp::v4(), port)),
-          certificate_(certificate),
-          private_key_(private_key),
+               boost::asio::ip::tcp::acceptor acceptor,
+               std::shared_ptr<const xtt::asio::server_configuration> config,
+               xtt::server_cookie_context& cookie_ctx)
+        : acceptor_(std::move(acceptor)),
+          handoff_acceptor_(io_context),
+          config_store_(std::move(config)),
+          reload_signals_(io_context, SIGHUP),
+          reload_pool_(1),
           cookie_ctx_(cookie_ctx),
-          gpk_map_(gpk_map),
-          xtt_contexts_(),
+          id_allocator_(),
+          connections_(io_context.get_executor()),
           io_context_(io_context)
     {
+        wait_for_reload();
+
         do_accept();
     }
 
+    /*
+     * Listen on the Unix socket `path` for a successor process.
+     * When one connects, give it our listening socket,
+     *  stop accepting, and finish the handshakes in progress.
+     */
+    void listen_for_successor(const std::string& path)
+    {
+        std::remove(path.c_str());
+        boost::asio::local::stream_protocol::endpoint endpoint(path);
+        boost::system::error_code ec;
+        handoff_acceptor_.open(endpoint.protocol(), ec);
+        if (!ec)
+            handoff_acceptor_.bind(endpoint, ec);
+        if (!ec)
+            handoff_acceptor_.listen(boost::asio::socket_base::max_listen_connections, ec);
+        if (ec) {
+            std::cerr << "Error listening on '" << path << "' for a successor: " << ec.message() << "\n";
+            return;
+        }
+
+        handoff_acceptor_.async_accept([this](boost::system::error_code ec, boost::asio::local::stream_protocol::socket successor)
+                                       {
+                                           if (ec)
+                                               return;
+
+                                           xtt::asio::send_listeners(successor, {acceptor_.native_handle()}, ec);
+                                           if (ec) {
+                                               std::cerr << "Error handing off listener: " << ec.message() << "\n";
+                                               return;
+                                           }
+
+                                           // The successor accepts from the same listen queue from now on
+                                           std::cout << "Handed off listener, draining " << connections_.size() << " handshakes\n";
+                                           handoff_acceptor_.close();
+                                           acceptor_.close();
+                                           reload_signals_.cancel();
+                                           connections_.async_drain(std::chrono::seconds(10),
+                                                                    [](const boost::system::error_code& ec)
+                                                                    {
+                                                                        std::cout << "Drained: " << (ec ? ec.message() : "all handshakes finished") << std::endl;
+                                                                    });
+                                       });
+    }
+
 private:
+    void wait_for_reload()
+    {
+        reload_signals_.async_wait([this](const boost::system::error_code& ec, int)
+                                   {
+                                       if (ec)
+                                           return;
+
+                                       // Reading and parsing the files happens off the I/O thread;
+                                       // handshakes already running keep the snapshot they started with.
+                                       boost::asio::post(reload_pool_,
+                                                         [this]()
+                                                         {
+                                                             auto config = load_configuration();
+                                                             if (!config) {
+                                                                 std::cerr << "Error reloading configuration, keeping the previous one\n";
+                                                                 return;
+                                                             }
+
+                                                             config_store_.publish(std::move(config));
+                                                             std::cout << "Reloaded configuration\n";
+                                                         });
+
+                                       this->wait_for_reload();
+                                   });
+    }
+
     void do_accept()
     {
         acceptor_.async_accept([this](boost::system::error_code ec, boost::asio::ip::tcp::socket socket)
                                {
+                                   // Closed by a handoff
+                                   if (!acceptor_.is_open())
+                                       return;
+
                                    if (!ec) {
                                        run_handshake(std::move(socket));
                                    }
@@ -67,112 +150,54 @@ private:
 
     void run_handshake(boost::asio::ip::tcp::socket socket)
     {
-        xtt_contexts_.emplace_back(std::move(socket), cookie_ctx_);
-        xtt::asio::server_context& xtt_context = xtt_contexts_.back();
-
-        boost::system::error_code cert_ec;
-        xtt_context.load_certificate(certificate_, private_key_, cert_ec);
-        if (cert_ec) {
-            std::cerr << "Error deserializing certificate\n";
-            return;
-        }
-
-        xtt_context.async_handle_connect([this](xtt::group_identity claimed_gid,
-                                                xtt::identity requested_client_id,
-                                                auto&& continuation)
-                                         {
-                                            (void)requested_client_id;
-
-                                             this->async_lookup_gpk(claimed_gid, continuation);
-                                         },
-                                         [this, &xtt_context](xtt::group_identity claimed_gid,
-                                                              xtt::identity requested_client_id,
-                                                              auto&& continuation)
-                                         {
-                                             this->async_assign_id(claimed_gid, requested_client_id, xtt_context, continuation);
-                                         },
-                                         [this, &xtt_context](const boost::system::error_code& ec)
-                                         {
-                                             this->handle_handshake(ec, xtt_context);
-                                         });
+        xtt::asio::server_context& xtt_context = connections_.create(std::move(socket), cookie_ctx_);
+
+        // This handshake uses the configuration current now, even if it's reloaded meanwhile
+        auto config = config_store_.load();
+        config->apply_to(xtt_context);
+
+        connections_.async_handle_connect(xtt_context,
+                                          [this, config](xtt::group_identity claimed_gid,
+                                                 xtt::identity requested_client_id,
+                                                 auto&& continuation)
+                                          {
+                                             (void)requested_client_id;
+
+                                              this->async_lookup_gpk(*config, claimed_gid, continuation);
+                                          },
+                                          // If the client sent xtt_null_client_id assign them id = SHA-256(GID || pseudonym) (truncated to first 16bytes)
+                                          // Otherwise, just echo back what they requested.
+                                          xtt::asio::make_assign_id_callback(id_allocator_, xtt_context),
+                                          xtt::asio::release_identity_on_failure(id_allocator_,
+                                                                                 xtt_context,
+                                                                                 [this, &xtt_context](const boost::system::error_code& ec)
+                                                                                 {
+                                                                                     this->handle_handshake(ec, xtt_context);
+                                                                                 }));
     }
 
     template <typename AsyncContinuation>
     void
-    async_lookup_gpk(const xtt::group_identity& claimed_gid, AsyncContinuation continuation)
+    async_lookup_gpk(const xtt::asio::server_configuration& config,
+                     const xtt::group_identity& claimed_gid,
+                     AsyncContinuation continuation)
     {
-        auto gpk_it = gpk_map_.find(claimed_gid);
-        if (gpk_map_.end() == gpk_it) {
+        std::shared_ptr<const xtt::group_public_key_context> gpk = config.find_gpk(claimed_gid);
+        if (!gpk) {
             std::cerr << "Error: claimed group ID '" << claimed_gid << "' doesn't match any known\n";
             boost::asio::post(io_context_,
                               [continuation]()
                               {
                                   continuation(xtt::asio::get_unknown_gid_ec(),
-                                               std::unique_ptr<xtt::group_public_key_context>());
-                              });
-            return;
-        }
-
-        boost::asio::post(io_context_,
-                          [continuation, gpk_it]()
-                          {
-                              continuation(boost::system::error_code(), gpk_it->second->clone());
-                          });
-    }
-
-    template <typename AsyncContinuation>
-    void
-    async_assign_id(const xtt::group_identity& claimed_gid,
-                    const xtt::identity requested_client_id,
-                    xtt::asio::server_context& xtt_context,
-                    AsyncContinuation continuation)
-    {
-        auto clients_pseudonym = xtt_context.get_clients_pseudonym();
-        if (!clients_pseudonym) {
-            std::cerr << "Unable to get client's pseudonym, while assigning an ID\n";
-            boost::asio::post(io_context_,
-                              [continuation]()
-                              {
-                                  continuation(xtt::asio::get_bad_id_ec(),
-                                               xtt::identity());
+                                               std::shared_ptr<const xtt::group_public_key_context>());
                               });
             return;
         }
 
-        xtt::identity assigned_id;
-        // If the client sent xtt_null_client_id assign them id = SHA-256(GID || pseudonym) (truncated to first 16bytes)
-        // Otherwise, just echo back what they requested.
-        if (requested_client_id.is_null()) {
-            std::vector<unsigned char> new_id_serialized(crypto_hash_sha256_BYTES);
-            crypto_hash_sha256_state h;
-            crypto_hash_sha256_init(&h);
-            std::vector<unsigned char> gid_serial = claimed_gid.serialize();
-            crypto_hash_sha256_update(&h, gid_serial.data(), gid_serial.size());
-            std::vector<unsigned char> pseudonym_serial = clients_pseudonym->serialize();
-            crypto_hash_sha256_update(&h, pseudonym_serial.data(), pseudonym_serial.size());
-            crypto_hash_sha256_final(&h, new_id_serialized.data());
-            new_id_serialized.resize(sizeof(xtt_identity_type));
-            auto new_id = xtt::identity::deserialize(new_id_serialized);
-            if (!new_id) {
-                std::cerr << "Error creating new identity\n";
-                boost::asio::post(io_context_,
-                                  [continuation]()
-                                  {
-                                      continuation(xtt::asio::get_bad_id_ec(),
-                                                   xtt::identity());
-                                  });
-                return;
-            }
-
-            assigned_id = *new_id;
-        } else {
-            assigned_id = requested_client_id;
-        }
-
         boost::asio::post(io_context_,
-                          [continuation, assigned_id]()
+                          [continuation, gpk]()
                           {
-                              continuation(boost::system::error_code(), assigned_id);
+                              continuation(boost::system::error_code(), gpk);
                           });
     }
 
@@ -182,92 +207,113 @@ private:
         if (!ec) {
             std::cout << "Successfully finished handshake:\n";
 
-            auto clients_pseudonym = xtt_context.get_clients_pseudonym();
-            if (!clients_pseudonym) {
-                std::cerr << "Error retrieving client's pseudonym!";
-                return;
-            }
-            std::cout << "\tClient's pseudonym:       " << *clients_pseudonym << "\n";
-
-            auto clients_id = xtt_context.get_clients_identity();
-            if (!clients_id) {
-                std::cerr << "Error retrieving client's assigned id!";
-                return;
-            }
-            std::cout << "\tWe assigned the identity: " << *clients_id << "\n";
-
-            auto clients_longterm_key = xtt_context.get_clients_longterm_key();
-            if (!clients_longterm_key) {
-                std::cerr << "Error retrieving client's longterm public key!";
+            // Keep only the compact result; the rest of the handshake state is wiped
+            auto result = xtt_context.finish();
+            if (!result) {
+                std::cerr << "Error retrieving client's handshake results!";
                 return;
             }
-            std::cout << "\tClient has longterm key:  " << *clients_longterm_key << "\n";
+            std::cout << "\tClient's pseudonym:       " << result->clients_pseudonym() << "\n";
+            std::cout << "\tWe assigned the identity: " << result->clients_identity << "\n";
+            std::cout << "\tClient has longterm key:  " << result->clients_longterm_key() << "\n";
         } else {
             std::cout << "Error during handshake: " << ec << std::endl;
         }
 
-        xtt_context.lowest_layer().close(); // we should also remove xtt_context from our vector
+        // connections_ frees xtt_context, closing its socket, once we return
     }
 
 private:
     boost::asio::ip::tcp::acceptor acceptor_;
+    boost::asio::local::stream_protocol::acceptor handoff_acceptor_;
 
-    std::vector<unsigned char> certificate_;
-    std::vector<unsigned char> private_key_;
+    // Certificates, GPKs and suite policy, reloaded on SIGHUP
+    xtt::asio::server_configuration_store config_store_;
+    boost::asio::signal_set reload_signals_;
+    boost::asio::thread_pool reload_pool_;
 
     xtt::server_cookie_context& cookie_ctx_;
-    std::unordered_map<xtt::group_identity, std::unique_ptr<xtt::group_public_key_context>>& gpk_map_;
 
-    std::vector<xtt::asio::server_context> xtt_contexts_;
+    xtt::hash_identity_allocator id_allocator_;
+
+    xtt::asio::connection_manager connections_;
 
     boost::asio::io_context& io_context_;
 };
 
-void parse_cmd_args(int argc, char *argv[], short *port);
+void parse_cmd_args(int argc, char *argv[], short *port, std::string *handoff_path);
 
-int initialize(std::vector<unsigned char>& certificate,
-               std::vector<unsigned char>& private_key,
-               std::unordered_map<xtt::group_identity, std::unique_ptr<xtt::group_public_key_context>>& gpk_map);
+boost::asio::ip::tcp::acceptor make_acceptor(boost::asio::io_context& io_context,
+                                             short port,
+                                             const std::string& handoff_path);
 
 int main(int argc, char *argv[])
 {
     // 1) Parse args
     short server_port;
-    parse_cmd_args(argc, argv, &server_port);
+    std::string handoff_path;
+    parse_cmd_args(argc, argv, &server_port, &handoff_path);
+
+    if (0 != xtt::initialize_crypto()) {
+        std::cerr << "Error initializing cryptography library\n";
+        return 1;
+    }
 
     // 2) Setup necessary XTT information (used by all handshakes)
-    std::vector<unsigned char> certificate;
-    std::vector<unsigned char> private_key;
     xtt::server_cookie_context cookie_ctx;
-    std::unordered_map<xtt::group_identity, std::unique_ptr<xtt::group_public_key_context>> gpk_map;
-    int ret;
-    ret = initialize(certificate, private_key, gpk_map);
-    if (0 != ret) {
+    auto config = load_configuration();
+    if (!config) {
         std::cerr << "Error initializing persistent XTT contexts\n";
         return 1;
     }
 
     // 3) Start server
+    //    (only now taking over from a running predecessor, if any, so it keeps serving while we start up)
     boost::asio::io_context io_context;
-    xtt_server serv{io_context, server_port, certificate, private_key, cookie_ctx, gpk_map};
+    xtt_server serv{io_context, make_acceptor(io_context, server_port, handoff_path), std::move(config), cookie_ctx};
+    if (!handoff_path.empty())
+        serv.listen_for_successor(handoff_path);
 
     // 4) Run event loop
+    //    (returns once a successor has taken over and our handshakes have drained)
     io_context.run();
 }
 
-void parse_cmd_args(int argc, char *argv[], short *port)
+void parse_cmd_args(int argc, char *argv[], short *port, std::string *handoff_path)
 {
-    if (2 != argc) {
-        std::cerr<< "usage: " << argv[0] << " <server port>\n";
+    if (2 != argc && 3 != argc) {
+        std::cerr<< "usage: " << argv[0] << " <server port> [<handoff socket path>]\n";
         exit(1);
     }
 
     *port = std::atoi(argv[1]);
+    if (3 == argc)
+        *handoff_path = argv[2];
+}
+
+boost::asio::ip::tcp::acceptor make_acceptor(boost::asio::io_context& io_context,
+                                             short port,
+                                             const std::string& handoff_path)
+{
+    // Take over the listening socket of a server already running, if there is one
+    if (!handoff_path.empty()) {
+        boost::asio::local::stream_protocol::socket predecessor(io_context);
+        boost::system::error_code ec;
+        predecessor.connect(boost::asio::local::stream_protocol::endpoint(handoff_path), ec);
+        if (!ec) {
+            auto listeners = xtt::asio::receive_listeners(predecessor, ec);
+            if (!ec) {
+                std::cout << "Took over listener from predecessor\n";
+                return boost::asio::ip::tcp::acceptor(io_context, boost::asio::ip::tcp::v4(), listeners.front());
+            }
+            std::cerr << "Error receiving listener from predecessor: " << ec.message() << "\n";
+        }
+    }
+
+    return boost::asio::ip::tcp::acceptor(io_context, boost::asio::ip::tcp::endpoint(boost::asio::ip::tcp::v4(), port));
 }
 
-int initialize(std::vector<unsigned char>& certificate,
-               std::vector<unsigned char>& private_key,
-               std::unordered_map<xtt::group_identity, std::unique_ptr<xtt::group_public_key_context>>& gpk_map)
+std::shared_ptr<const xtt::asio::server_configuration> load_configuration()
 {
     // 1) Read DAA GPK from file.
     std::ifstream gpk_file(daa_gpk_file, std::ios::in | std::ios::binary);
@@ -281,7 +327,7 @@ int initialize(std::vector<unsigned char>& certificate,
     auto gpk = xtt::group_public_key_context_lrsw::from_gpk_and_basename(serialized_gpk, basename);
     if (!gpk) {
         std::cerr << "Error deserializing GPK and basename\n";
-        return -1;
+        return nullptr;
     }
     std::cout << "Using group public key context: " << *gpk << std::endl;
 
@@ -295,20 +341,33 @@ int initialize(std::vector<unsigned char>& certificate,
     auto gid = xtt::group_identity::deserialize(raw_gid);
     if (!gid) {
         std::cerr << "Error computing GID from GPK\n";
-        return -1;
+        return nullptr;
     }
     std::cout << "\twith GID: " << *gid << std::endl;
 
     // 4ii) Insert gpk into map
+    xtt::asio::group_public_key_map gpk_map;
     gpk_map[*gid] = std::move(gpk);
 
     // 5) Read in my certificate from file
     std::ifstream cert_file(server_certificate_file, std::ios::in | std::ios::binary);
-    certificate.assign((std::istreambuf_iterator<char>(cert_file)), std::istreambuf_iterator<char>());
+    std::vector<unsigned char> certificate((std::istreambuf_iterator<char>(cert_file)), std::istreambuf_iterator<char>());
 
     // 6) Read in my private key from file
     std::ifstream privkey_file(server_privatekey_file, std::ios::in | std::ios::binary);
-    private_key.assign((std::istreambuf_iterator<char>(privkey_file)), std::istreambuf_iterator<char>());
+    std::vector<unsigned char> private_key((std::istreambuf_iterator<char>(privkey_file)), std::istreambuf_iterator<char>());
+
+    // 7) Parse the certificate once, and share it between all connections
+    boost::system::error_code cert_ec;
+    auto certificates = xtt::asio::make_server_certificate_map(certificate, private_key, cert_ec);
+    if (cert_ec) {
+        std::cerr << "Error deserializing certificate\n";
+        return nullptr;
+    }
 
-    return 0;
+    // 8) Prefer the suites this CPU is fastest at
+    //    (unknown GIDs are rejected without a GPK lookup, by a filter built from gpk_map)
+    return xtt::asio::server_configuration::create(std::move(certificates),
+                                                   std::move(gpk_map),
+                                                   std::make_shared<const xtt::suite_policy>(xtt::suite_policy::from_cpu_features()));
 }
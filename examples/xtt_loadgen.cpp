@@ -0,0 +1,521 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+/*
+ * Open-loop load generator for XTT servers.
+ *
+ * Handshakes are started at exponentially-distributed intervals (a Poisson process)
+ *  at the requested rate, regardless of how quickly the server responds.
+ *  Arrivals beyond the in-flight cap wait for a free slot.
+ *
+ * Latencies are reported two ways:
+ *  - from when each handshake actually started, and
+ *  - from when it was scheduled to start,
+ *    which also counts the time it waited behind the in-flight cap
+ *    (correcting for coordinated omission).
+ *
+ * The client's DAA credentials and the server's root certificate are read
+ *  from the working directory (see xtt's examples/data/client).
+ */
+
+#include <xtt.hpp>
+#include <xtt.h>
+
+#include <sodium.h>
+
+#include <boost/asio.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    const char *daa_gpk_file = "daa_gpk.bin";
+    const char *basename_file = "basename.bin";
+    const char *daa_cred_file = "daa_cred.bin";
+    const char *daa_secretkey_file = "daa_secretkey.bin";
+    const char *root_id_file = "root_id.bin";
+    const char *root_pubkey_file = "root_pub.bin";
+
+    using clock_type = std::chrono::steady_clock;
+    using boost::asio::ip::tcp;
+
+    struct options {
+        std::string host;
+        std::string port;
+        double rate = 100;
+        double duration_s = 10;
+        unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+        std::size_t max_inflight = 1000;
+        std::vector<xtt_suite_spec> suites = {XTT_X25519_LRSW_ECDSAP256_CHACHA20POLY1305_SHA512};
+        std::vector<double> suite_weights = {1};
+    };
+
+    struct client_credentials {
+        xtt_group_id gid;
+        xtt_daa_priv_key_lrsw priv_key;
+        xtt_daa_credential_lrsw cred;
+        std::vector<unsigned char> basename;
+        xtt_certificate_root_id root_id;
+        xtt_ecdsap256_pub_key root_pubkey;
+    };
+
+    struct results {
+        std::vector<double> service_ms;      // from actual start
+        std::vector<double> corrected_ms;    // from scheduled start
+        std::map<std::string, std::size_t> outcomes;
+    };
+
+    struct session {
+        session(boost::asio::io_context& io_context,
+                clock_type::time_point intended_start)
+            : socket(io_context),
+              in_buffer(),
+              out_buffer(),
+              ctx(),
+              io_len(0),
+              io_ptr(nullptr),
+              intended(intended_start),
+              started(clock_type::now())
+        {
+        }
+
+        tcp::socket socket;
+        std::array<unsigned char, MAX_HANDSHAKE_SERVER_MESSAGE_LENGTH> in_buffer;
+        std::array<unsigned char, MAX_HANDSHAKE_CLIENT_MESSAGE_LENGTH> out_buffer;
+        xtt_client_handshake_context ctx;
+        uint16_t io_len;
+        unsigned char *io_ptr;
+
+        clock_type::time_point intended;
+        clock_type::time_point started;
+    };
+
+    /*
+     * One thread's share of the load, on its own io_context.
+     */
+    class worker {
+    public:
+        worker(const options& opts,
+               const client_credentials& creds,
+               const tcp::endpoint& server,
+               std::uint64_t seed)
+            : io_context_(),
+              arrival_timer_(io_context_),
+              server_(server),
+              creds_(creds),
+              group_ctx_(),
+              root_ctx_(),
+              suites_(opts.suites),
+              rng_(seed),
+              interarrival_(opts.rate / opts.threads),
+              suite_choice_(opts.suite_weights.begin(), opts.suite_weights.end()),
+              max_inflight_(std::max<std::size_t>(1, opts.max_inflight / opts.threads)),
+              inflight_(0),
+              backlog_(),
+              next_arrival_(),
+              end_(),
+              results_()
+        {
+            // Credentials are read-only during a handshake, so sessions on this thread share them
+            xtt_group_id gid = creds_.gid;
+            xtt_daa_priv_key_lrsw priv_key = creds_.priv_key;
+            xtt_daa_credential_lrsw cred = creds_.cred;
+            xtt_initialize_client_group_context_lrsw(&group_ctx_, &gid, &priv_key, &cred,
+                                                     creds_.basename.data(), static_cast<uint16_t>(creds_.basename.size()));
+
+            xtt_certificate_root_id root_id = creds_.root_id;
+            xtt_ecdsap256_pub_key root_pubkey = creds_.root_pubkey;
+            xtt_initialize_server_root_certificate_context_ecdsap256(&root_ctx_, &root_id, &root_pubkey);
+        }
+
+        void run(clock_type::time_point start, clock_type::time_point end)
+        {
+            next_arrival_ = start;
+            end_ = end;
+            schedule_next_arrival();
+
+            // Returns once arrivals have stopped and every handshake has finished
+            io_context_.run();
+        }
+
+        results& get_results()
+        {
+            return results_;
+        }
+
+    private:
+        void schedule_next_arrival()
+        {
+            next_arrival_ += std::chrono::duration_cast<clock_type::duration>(std::chrono::duration<double>(interarrival_(rng_)));
+            if (next_arrival_ >= end_)
+                return;
+
+            arrival_timer_.expires_at(next_arrival_);
+            arrival_timer_.async_wait([this](const boost::system::error_code& ec)
+                                      {
+                                          if (ec)
+                                              return;
+
+                                          // Open loop: the arrival is due whether or not there's room for it
+                                          if (inflight_ < max_inflight_)
+                                              this->start(next_arrival_);
+                                          else
+                                              backlog_.push_back(next_arrival_);
+
+                                          this->schedule_next_arrival();
+                                      });
+        }
+
+        void start(clock_type::time_point intended)
+        {
+            ++inflight_;
+
+            auto s = std::make_shared<session>(io_context_, intended);
+            xtt_suite_spec suite = suites_[suite_choice_(rng_)];
+            xtt_return_code_type rc = xtt_initialize_client_handshake_context(&s->ctx,
+                                                                              s->in_buffer.data(), static_cast<uint16_t>(s->in_buffer.size()),
+                                                                              s->out_buffer.data(), static_cast<uint16_t>(s->out_buffer.size()),
+                                                                              XTT_VERSION_ONE,
+                                                                              suite);
+            if (XTT_RETURN_SUCCESS != rc) {
+                finish(*s, xtt_strerror(rc));
+                return;
+            }
+
+            s->socket.async_connect(server_,
+                                    [this, s](const boost::system::error_code& ec)
+                                    {
+                                        if (ec) {
+                                            this->finish(*s, ec.message());
+                                            return;
+                                        }
+
+                                        boost::system::error_code ignored;
+                                        s->socket.set_option(tcp::no_delay(true), ignored);
+
+                                        this->run_state_machine(s, xtt_handshake_client_start(&s->io_len, &s->io_ptr, &s->ctx));
+                                    });
+        }
+
+        void run_state_machine(const std::shared_ptr<session>& s, xtt_return_code_type rc)
+        {
+            switch (rc) {
+                case XTT_RETURN_WANT_WRITE:
+                    boost::asio::async_write(s->socket,
+                                             boost::asio::buffer(s->io_ptr, s->io_len),
+                                             [this, s](const boost::system::error_code& ec, std::size_t bytes_written)
+                                             {
+                                                 if (ec) {
+                                                     this->finish(*s, ec.message());
+                                                     return;
+                                                 }
+
+                                                 this->run_state_machine(s, xtt_handshake_client_handle_io(static_cast<uint16_t>(bytes_written), 0,
+                                                                                                           &s->io_len, &s->io_ptr, &s->ctx));
+                                             });
+                    break;
+                case XTT_RETURN_WANT_READ:
+                    boost::asio::async_read(s->socket,
+                                            boost::asio::buffer(s->io_ptr, s->io_len),
+                                            [this, s](const boost::system::error_code& ec, std::size_t bytes_read)
+                                            {
+                                                if (ec) {
+                                                    this->finish(*s, ec.message());
+                                                    return;
+                                                }
+
+                                                this->run_state_machine(s, xtt_handshake_client_handle_io(0, static_cast<uint16_t>(bytes_read),
+                                                                                                          &s->io_len, &s->io_ptr, &s->ctx));
+                                            });
+                    break;
+                case XTT_RETURN_WANT_PREPARSESERVERATTEST:
+                    {
+                        xtt_certificate_root_id claimed_root;
+                        rc = xtt_handshake_client_preparse_serverattest(&claimed_root, &s->io_len, &s->io_ptr, &s->ctx);
+                        if (XTT_RETURN_WANT_BUILDIDCLIENTATTEST == rc &&
+                            0 != std::memcmp(claimed_root.data, creds_.root_id.data, sizeof(claimed_root.data)))
+                            rc = XTT_RETURN_UNKNOWN_CERTIFICATE;
+                        run_state_machine(s, rc);
+                    }
+                    break;
+                case XTT_RETURN_WANT_BUILDIDCLIENTATTEST:
+                    run_state_machine(s, xtt_handshake_client_build_idclientattest(&s->io_len, &s->io_ptr,
+                                                                                   &root_ctx_,
+                                                                                   &xtt_null_identity,
+                                                                                   &group_ctx_,
+                                                                                   &s->ctx));
+                    break;
+                case XTT_RETURN_WANT_PARSEIDSERVERFINISHED:
+                    run_state_machine(s, xtt_handshake_client_parse_idserverfinished(&s->io_len, &s->io_ptr, &s->ctx));
+                    break;
+                case XTT_RETURN_HANDSHAKE_FINISHED:
+                    finish(*s, "success");
+                    break;
+                case XTT_RETURN_RECEIVED_ERROR_MSG:
+                    finish(*s, xtt_strerror(rc));
+                    break;
+                default:
+                    // Let the server know, then give up on this handshake
+                    finish(*s, xtt_strerror(rc));
+                    (void)xtt_handshake_client_build_error_msg(&s->io_len, &s->io_ptr, &s->ctx);
+                    boost::asio::async_write(s->socket,
+                                             boost::asio::buffer(s->io_ptr, s->io_len),
+                                             [s](const boost::system::error_code&, std::size_t) {});
+                    break;
+            }
+        }
+
+        void finish(session& s, const std::string& outcome)
+        {
+            auto now = clock_type::now();
+            ++results_.outcomes[outcome];
+            if ("success" == outcome) {
+                results_.service_ms.push_back(std::chrono::duration<double, std::milli>(now - s.started).count());
+                results_.corrected_ms.push_back(std::chrono::duration<double, std::milli>(now - s.intended).count());
+            }
+
+            --inflight_;
+            if (!backlog_.empty()) {
+                auto intended = backlog_.front();
+                backlog_.pop_front();
+                start(intended);
+            }
+        }
+
+    private:
+        boost::asio::io_context io_context_;
+        boost::asio::steady_timer arrival_timer_;
+        tcp::endpoint server_;
+
+        const client_credentials& creds_;
+        xtt_client_group_context group_ctx_;
+        xtt_server_root_certificate_context root_ctx_;
+
+        std::vector<xtt_suite_spec> suites_;
+        std::mt19937_64 rng_;
+        std::exponential_distribution<double> interarrival_;
+        std::discrete_distribution<std::size_t> suite_choice_;
+
+        std::size_t max_inflight_;
+        std::size_t inflight_;
+        std::deque<clock_type::time_point> backlog_;
+        clock_type::time_point next_arrival_;
+        clock_type::time_point end_;
+
+        results results_;
+    };
+
+    void usage(const char *program);
+
+    bool parse_cmd_args(int argc, char *argv[], options& opts);
+
+    int initialize(client_credentials& creds);
+
+    double percentile(const std::vector<double>& sorted, double p);
+
+}
+
+int main(int argc, char *argv[])
+{
+    options opts;
+    if (!parse_cmd_args(argc, argv, opts)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (0 != xtt::initialize_crypto()) {
+        std::cerr << "Error initializing cryptography library\n";
+        return 1;
+    }
+
+    client_credentials creds;
+    if (0 != initialize(creds))
+        return 1;
+
+    boost::asio::io_context resolver_context;
+    tcp::resolver resolver(resolver_context);
+    boost::system::error_code resolve_ec;
+    auto endpoints = resolver.resolve(opts.host, opts.port, resolve_ec);
+    if (resolve_ec || endpoints.empty()) {
+        std::cerr << "Error resolving '" << opts.host << ":" << opts.port << "'\n";
+        return 1;
+    }
+    tcp::endpoint server = endpoints.begin()->endpoint();
+
+    std::random_device seed_source;
+    std::vector<std::unique_ptr<worker>> workers;
+    for (unsigned i = 0; i < opts.threads; ++i)
+        workers.push_back(std::make_unique<worker>(opts, creds, server, seed_source()));
+
+    auto start = clock_type::now();
+    auto end = start + std::chrono::duration_cast<clock_type::duration>(std::chrono::duration<double>(opts.duration_s));
+    std::vector<std::thread> threads;
+    for (auto& w : workers)
+        threads.emplace_back([&w, start, end]() { w->run(start, end); });
+    for (auto& t : threads)
+        t.join();
+    double elapsed_s = std::chrono::duration<double>(clock_type::now() - start).count();
+
+    results all;
+    for (auto& w : workers) {
+        results& r = w->get_results();
+        all.service_ms.insert(all.service_ms.end(), r.service_ms.begin(), r.service_ms.end());
+        all.corrected_ms.insert(all.corrected_ms.end(), r.corrected_ms.begin(), r.corrected_ms.end());
+        for (const auto& outcome : r.outcomes)
+            all.outcomes[outcome.first] += outcome.second;
+    }
+    std::sort(all.service_ms.begin(), all.service_ms.end());
+    std::sort(all.corrected_ms.begin(), all.corrected_ms.end());
+
+    std::size_t attempted = 0;
+    for (const auto& outcome : all.outcomes)
+        attempted += outcome.second;
+
+    std::cout << "Offered " << opts.rate << " handshakes/s for " << opts.duration_s << " s"
+              << " on " << opts.threads << " threads (at most " << opts.max_inflight << " in flight)\n";
+    std::cout << "\tattempted:              " << attempted << "\n";
+    std::cout << "\tthroughput (success/s): " << (elapsed_s > 0 ? all.service_ms.size() / elapsed_s : 0) << "\n";
+    std::cout << "\tlatency (ms)            p50 / p99 / p99.9\n";
+    std::cout << "\t  from start:           " << percentile(all.service_ms, 0.50)
+              << " / " << percentile(all.service_ms, 0.99)
+              << " / " << percentile(all.service_ms, 0.999) << "\n";
+    std::cout << "\t  from schedule:        " << percentile(all.corrected_ms, 0.50)
+              << " / " << percentile(all.corrected_ms, 0.99)
+              << " / " << percentile(all.corrected_ms, 0.999) << "\n";
+    for (const auto& outcome : all.outcomes)
+        std::cout << "\t" << outcome.first << ": " << outcome.second << "\n";
+}
+
+namespace {
+
+    void usage(const char *program)
+    {
+        std::cerr << "usage: " << program << " <server host> <server port>"
+                  << " [--rate <handshakes/s>] [--duration <s>] [--threads <n>] [--max-inflight <n>]"
+                  << " [--suites <suite>[:<weight>],...]\n"
+                  << "\twhere <suite> is the numeric suite_spec (1-4)\n";
+    }
+
+    bool parse_suites(const std::string& arg, options& opts)
+    {
+        opts.suites.clear();
+        opts.suite_weights.clear();
+
+        std::istringstream list(arg);
+        std::string entry;
+        while (std::getline(list, entry, ',')) {
+            auto colon = entry.find(':');
+            int suite = std::atoi(entry.substr(0, colon).c_str());
+            double weight = (std::string::npos == colon) ? 1 : std::atof(entry.substr(colon + 1).c_str());
+            if (suite < XTT_X25519_LRSW_ECDSAP256_CHACHA20POLY1305_SHA512 ||
+                suite > XTT_X25519_LRSW_ECDSAP256_AES256GCM_BLAKE2B ||
+                weight <= 0)
+                return false;
+
+            opts.suites.push_back(static_cast<xtt_suite_spec>(suite));
+            opts.suite_weights.push_back(weight);
+        }
+
+        return !opts.suites.empty();
+    }
+
+    bool parse_cmd_args(int argc, char *argv[], options& opts)
+    {
+        if (argc < 3 || 0 != (argc - 3) % 2)
+            return false;
+
+        opts.host = argv[1];
+        opts.port = argv[2];
+
+        for (int i = 3; i + 1 < argc; i += 2) {
+            std::string flag = argv[i];
+            const char *value = argv[i + 1];
+            if ("--rate" == flag)
+                opts.rate = std::atof(value);
+            else if ("--duration" == flag)
+                opts.duration_s = std::atof(value);
+            else if ("--threads" == flag)
+                opts.threads = static_cast<unsigned>(std::atoi(value));
+            else if ("--max-inflight" == flag)
+                opts.max_inflight = static_cast<std::size_t>(std::atol(value));
+            else if ("--suites" == flag) {
+                if (!parse_suites(value, opts))
+                    return false;
+            } else
+                return false;
+        }
+
+        return opts.rate > 0 && opts.duration_s > 0 && opts.threads > 0 && opts.max_inflight > 0;
+    }
+
+    template <typename T>
+    bool read_exactly(const char *file_name, T& out)
+    {
+        std::ifstream file(file_name, std::ios::in | std::ios::binary);
+        std::vector<unsigned char> contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (contents.size() != sizeof(out.data)) {
+            std::cerr << "Error reading '" << file_name << "'\n";
+            return false;
+        }
+
+        std::copy(contents.begin(), contents.end(), out.data);
+        return true;
+    }
+
+    int initialize(client_credentials& creds)
+    {
+        xtt_daa_group_pub_key_lrsw gpk;
+        if (!read_exactly(daa_gpk_file, gpk) ||
+            !read_exactly(daa_cred_file, creds.cred) ||
+            !read_exactly(daa_secretkey_file, creds.priv_key) ||
+            !read_exactly(root_id_file, creds.root_id) ||
+            !read_exactly(root_pubkey_file, creds.root_pubkey))
+            return -1;
+
+        std::ifstream bsn_file(basename_file, std::ios::in | std::ios::binary);
+        creds.basename.assign((std::istreambuf_iterator<char>(bsn_file)), std::istreambuf_iterator<char>());
+
+        // GID = SHA-256(GPK), as in the example server
+        crypto_hash_sha256(creds.gid.data, gpk.data, sizeof(gpk.data));
+
+        return 0;
+    }
+
+    double percentile(const std::vector<double>& sorted, double p)
+    {
+        if (sorted.empty())
+            return 0;
+
+        return sorted[static_cast<std::size_t>(p * (sorted.size() - 1))];
+    }
+
+}
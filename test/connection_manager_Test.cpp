@@ -0,0 +1,260 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include "test-utils.h"
+
+#include <xtt.hpp>
+#include <xtt/asio.hpp>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+
+using manager_type = xtt::asio::basic_connection_manager<xtt::asio::memory_stream>;
+
+void finished_handshakes_are_removed();
+void slots_are_reused();
+void close_all_closes_streams();
+void close_all_while_handshakes_finish();
+void drain_when_empty();
+void drain_waits_for_handshakes();
+
+int main()
+{
+    xtt::initialize_crypto();
+
+    finished_handshakes_are_removed();
+    slots_are_reused();
+    close_all_closes_streams();
+    close_all_while_handshakes_finish();
+    drain_when_empty();
+    drain_waits_for_handshakes();
+}
+
+void finished_handshakes_are_removed()
+{
+    std::cout << "Starting connection_manager_Test::finished_handshakes_are_removed...\n";
+
+    boost::asio::io_context io_ctx;
+    xtt::server_cookie_context cookie_ctx;
+    manager_type manager(io_ctx.get_executor(), 4);
+
+    // Not a valid ClientInit, so every handshake fails
+    std::vector<unsigned char> garbage(64, 0xFF);
+    std::vector<xtt::asio::memory_stream> clients;
+    std::size_t handlers_called = 0;
+    for (int i = 0; i < 10; ++i) {
+        auto ends = xtt::asio::memory_stream::make_pair(io_ctx.get_executor());
+        boost::asio::async_write(ends.second, boost::asio::buffer(garbage), [](auto&&, auto&&){});
+        clients.push_back(std::move(ends.second));
+
+        auto& ctx = manager.create(std::move(ends.first), cookie_ctx);
+        manager.async_handle_connect(ctx,
+                                     [](auto&&, auto&&, auto&&) { TEST_ASSERT(false); },
+                                     [](auto&&, auto&&, auto&&) { TEST_ASSERT(false); },
+                                     [&](const boost::system::error_code& ec)
+                                     {
+                                         TEST_ASSERT(ec);
+                                         ++handlers_called;
+                                     });
+    }
+    TEST_ASSERT(10 == manager.size());
+    TEST_ASSERT(12 == manager.capacity());
+
+    io_ctx.run();
+
+    TEST_ASSERT(10 == handlers_called);
+    TEST_ASSERT(0 == manager.size());
+    TEST_ASSERT(12 == manager.capacity());
+}
+
+void slots_are_reused()
+{
+    std::cout << "Starting connection_manager_Test::slots_are_reused...\n";
+
+    boost::asio::io_context io_ctx;
+    xtt::server_cookie_context cookie_ctx;
+    manager_type manager(io_ctx.get_executor(), 4);
+
+    std::vector<xtt::asio::basic_server_context<xtt::asio::memory_stream>*> contexts;
+    for (int i = 0; i < 3; ++i) {
+        auto ends = xtt::asio::memory_stream::make_pair(io_ctx.get_executor());
+        contexts.push_back(&manager.create(std::move(ends.first), cookie_ctx));
+    }
+    TEST_ASSERT(3 == manager.size());
+    TEST_ASSERT(4 == manager.capacity());
+
+    manager.remove(*contexts[1]);
+    TEST_ASSERT(2 == manager.size());
+
+    // The freed slot is used again, without growing the pool
+    auto ends = xtt::asio::memory_stream::make_pair(io_ctx.get_executor());
+    auto& recreated = manager.create(std::move(ends.first), cookie_ctx);
+    TEST_ASSERT(&recreated == contexts[1]);
+    TEST_ASSERT(3 == manager.size());
+    TEST_ASSERT(4 == manager.capacity());
+
+    for (int i = 0; i < 2; ++i) {
+        auto more = xtt::asio::memory_stream::make_pair(io_ctx.get_executor());
+        manager.create(std::move(more.first), cookie_ctx);
+    }
+    TEST_ASSERT(5 == manager.size());
+    TEST_ASSERT(8 == manager.capacity());
+
+    manager.remove(*contexts[0]);
+    manager.remove(*contexts[2]);
+    TEST_ASSERT(3 == manager.size());
+}
+
+void close_all_closes_streams()
+{
+    std::cout << "Starting connection_manager_Test::close_all_closes_streams...\n";
+
+    boost::asio::io_context io_ctx;
+    xtt::server_cookie_context cookie_ctx;
+    manager_type manager(io_ctx.get_executor());
+
+    std::vector<xtt::asio::memory_stream> clients;
+    std::size_t eofs = 0;
+    unsigned char byte;
+    for (int i = 0; i < 3; ++i) {
+        auto ends = xtt::asio::memory_stream::make_pair(io_ctx.get_executor());
+        clients.push_back(std::move(ends.second));
+        manager.create(std::move(ends.first), cookie_ctx);
+    }
+    for (auto& client : clients) {
+        boost::asio::async_read(client,
+                                boost::asio::buffer(&byte, 1),
+                                [&](const boost::system::error_code& ec, std::size_t)
+                                {
+                                    if (boost::asio::error::eof == ec)
+                                        ++eofs;
+                                });
+    }
+
+    manager.close_all();
+    io_ctx.run();
+
+    TEST_ASSERT(3 == eofs);
+}
+
+void close_all_while_handshakes_finish()
+{
+    std::cout << "Starting connection_manager_Test::close_all_while_handshakes_finish...\n";
+
+    boost::asio::io_context io_ctx;
+    xtt::server_cookie_context cookie_ctx;
+    manager_type manager(io_ctx.get_executor(), 4);
+
+    // Each handshake fails while the close of its stream is still queued on its strand
+    std::vector<unsigned char> garbage(64, 0xFF);
+    std::vector<xtt::asio::memory_stream> clients;
+    std::size_t handlers_called = 0;
+    for (int i = 0; i < 10; ++i) {
+        auto ends = xtt::asio::memory_stream::make_pair(io_ctx.get_executor());
+        boost::asio::async_write(ends.second, boost::asio::buffer(garbage), [](auto&&, auto&&){});
+        clients.push_back(std::move(ends.second));
+
+        auto& ctx = manager.create(std::move(ends.first), cookie_ctx);
+        manager.async_handle_connect(ctx,
+                                     [](auto&&, auto&&, auto&&) { TEST_ASSERT(false); },
+                                     [](auto&&, auto&&, auto&&) { TEST_ASSERT(false); },
+                                     [&](const boost::system::error_code& ec)
+                                     {
+                                         TEST_ASSERT(ec);
+                                         ++handlers_called;
+                                     });
+    }
+    manager.close_all();
+
+    io_ctx.run();
+
+    TEST_ASSERT(10 == handlers_called);
+    TEST_ASSERT(0 == manager.size());
+
+    // Every slot was returned to the pool
+    clients.clear();
+    for (int i = 0; i < 12; ++i) {
+        auto ends = xtt::asio::memory_stream::make_pair(io_ctx.get_executor());
+        manager.create(std::move(ends.first), cookie_ctx);
+    }
+    TEST_ASSERT(12 == manager.capacity());
+}
+
+void drain_when_empty()
+{
+    std::cout << "Starting connection_manager_Test::drain_when_empty...\n";
+
+    boost::asio::io_context io_ctx;
+    manager_type manager(io_ctx.get_executor());
+
+    bool drained = false;
+    manager.async_drain(std::chrono::seconds(10),
+                        [&](const boost::system::error_code& ec)
+                        {
+                            TEST_ASSERT(!ec);
+                            drained = true;
+                        });
+
+    io_ctx.run();
+
+    TEST_ASSERT(drained);
+}
+
+void drain_waits_for_handshakes()
+{
+    std::cout << "Starting connection_manager_Test::drain_waits_for_handshakes...\n";
+
+    boost::asio::io_context io_ctx;
+    xtt::server_cookie_context cookie_ctx;
+    manager_type manager(io_ctx.get_executor());
+
+    // The clients never send anything, so the handshakes only end by failing or being aborted
+    std::vector<xtt::asio::memory_stream> clients;
+    std::size_t handlers_called = 0;
+    for (int i = 0; i < 3; ++i) {
+        auto ends = xtt::asio::memory_stream::make_pair(io_ctx.get_executor());
+        clients.push_back(std::move(ends.second));
+
+        auto& ctx = manager.create(std::move(ends.first), cookie_ctx);
+        manager.async_handle_connect(ctx,
+                                     [](auto&&, auto&&, auto&&) { TEST_ASSERT(false); },
+                                     [](auto&&, auto&&, auto&&) { TEST_ASSERT(false); },
+                                     [&](const boost::system::error_code&)
+                                     {
+                                         ++handlers_called;
+                                     });
+    }
+
+    bool drained = false;
+    manager.async_drain(std::chrono::milliseconds(50),
+                        [&](const boost::system::error_code&)
+                        {
+                            TEST_ASSERT(3 == handlers_called);
+                            TEST_ASSERT(0 == manager.size());
+                            drained = true;
+                        });
+
+    io_ctx.run();
+
+    TEST_ASSERT(drained);
+}
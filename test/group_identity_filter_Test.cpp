@@ -0,0 +1,94 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include <iostream>
+#include <vector>
+
+#include "test-utils.h"
+
+#include <xtt.hpp>
+
+#include <sodium.h>
+
+void contains_all_inserted();
+void rejects_most_unknown();
+void empty_filter_rejects_all();
+
+xtt::group_identity random_gid();
+
+int main()
+{
+    xtt::initialize_crypto();
+
+    contains_all_inserted();
+    rejects_most_unknown();
+    empty_filter_rejects_all();
+}
+
+xtt::group_identity random_gid()
+{
+    xtt::group_identity gid;
+    randombytes_buf(gid.get()->data, gid.length());
+    return gid;
+}
+
+void contains_all_inserted()
+{
+    std::cout << "Starting group_identity_filter_Test::contains_all_inserted...\n";
+
+    std::vector<xtt::group_identity> gids;
+    for (int i = 0; i < 1000; ++i)
+        gids.push_back(random_gid());
+
+    xtt::group_identity_filter filter(gids);
+    TEST_ASSERT(1000 == filter.size());
+
+    for (const auto& gid : gids)
+        TEST_ASSERT(filter.may_contain(gid));
+}
+
+void rejects_most_unknown()
+{
+    std::cout << "Starting group_identity_filter_Test::rejects_most_unknown...\n";
+
+    std::vector<xtt::group_identity> gids;
+    for (int i = 0; i < 100; ++i)
+        gids.push_back(random_gid());
+
+    xtt::group_identity_filter filter(gids);
+
+    int false_positives = 0;
+    for (int i = 0; i < 10000; ++i) {
+        if (filter.may_contain(random_gid()))
+            ++false_positives;
+    }
+
+    // Expected rate is about 1%
+    TEST_ASSERT(false_positives < 500);
+}
+
+void empty_filter_rejects_all()
+{
+    std::cout << "Starting group_identity_filter_Test::empty_filter_rejects_all...\n";
+
+    xtt::group_identity_filter filter(std::vector<xtt::group_identity>{});
+    TEST_ASSERT(0 == filter.size());
+
+    for (int i = 0; i < 100; ++i)
+        TEST_ASSERT(!filter.may_contain(random_gid()));
+}
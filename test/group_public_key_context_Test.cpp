@@ -34,8 +34,10 @@ void lrsw_deserialize_bin_together();
 void lrsw_deserialize_bins_together_agree();
 void lrsw_deserialize_bin_separate();
 void lrsw_deserialize_text();
+void lrsw_deserialize_text_view();
 void lrsw_deserialize_basename_too_long();
 void lrsw_deserialize_basename_bad_length();
+void lrsw_value();
 
 int main()
 {
@@ -46,8 +48,10 @@ int main()
     lrsw_deserialize_bins_together_agree();
     lrsw_deserialize_bin_separate();
     lrsw_deserialize_text();
+    lrsw_deserialize_text_view();
     lrsw_deserialize_basename_too_long();
     lrsw_deserialize_basename_bad_length();
+    lrsw_value();
 }
 
 void lrsw_clone()
@@ -189,6 +193,37 @@ void lrsw_deserialize_text()
         << "which creates a group public key context as: '" << *maybe_ctx << std::endl;
 }
 
+void lrsw_deserialize_text_view()
+{
+    std::cout << "Starting group_public_key_context_Test::lrsw_deserialize_text_view...\n";
+
+    std::vector<unsigned char> gpk_as_bytes(sizeof(xtt_daa_group_pub_key_lrsw));
+    xtt_crypto_get_random(gpk_as_bytes.data(), gpk_as_bytes.size());
+    auto gpk_ctx = xtt::group_public_key_context_lrsw::from_gpk_and_basename(gpk_as_bytes,
+            std::vector<unsigned char>{0xDE, 0xAD, 0xBE, 0xEF});
+    TEST_ASSERT(gpk_ctx);
+
+    // Both parts, from a single buffer
+    std::string buffer = gpk_ctx->get_gpk_as_text() + " DEADBEEF";
+    STRING_VIEW_NS::string_view as_view(buffer);
+    auto gpk_as_text = as_view.substr(0, 2*sizeof(xtt_daa_group_pub_key_lrsw));
+    auto basename_as_text = as_view.substr(2*sizeof(xtt_daa_group_pub_key_lrsw) + 1);
+
+    auto maybe_ctx = xtt::group_public_key_context_lrsw::from_gpk_and_basename(gpk_as_text, basename_as_text);
+    TEST_ASSERT(maybe_ctx);
+    TEST_ASSERT(gpk_as_bytes == maybe_ctx->get_gpk());
+    TEST_ASSERT("DEADBEEF" == maybe_ctx->get_basename_as_text());
+
+    auto maybe_value = xtt::group_public_key_context_lrsw_value::from_gpk_and_basename(gpk_as_text, basename_as_text);
+    TEST_ASSERT(maybe_value);
+    TEST_ASSERT(gpk_as_bytes == maybe_value->get_gpk());
+
+    // Odd-length and over-long basenames
+    TEST_ASSERT(!xtt::group_public_key_context_lrsw::from_gpk_and_basename(gpk_as_text, basename_as_text.substr(1)));
+    std::string too_long(2*(MAX_BASENAME_LENGTH+1), 'A');
+    TEST_ASSERT(!xtt::group_public_key_context_lrsw::from_gpk_and_basename(gpk_as_text, too_long));
+}
+
 void lrsw_deserialize_basename_too_long()
 {
     std::cout << "Starting group_public_key_context_Test::lrsw_deserialize_basename_too_long...\n";
@@ -220,3 +255,35 @@ void lrsw_deserialize_basename_bad_length()
     auto maybe_ctx = xtt::group_public_key_context_lrsw::deserialize(all_together);
     TEST_ASSERT(!maybe_ctx);
 }
+
+void lrsw_value()
+{
+    std::cout << "Starting group_public_key_context_Test::lrsw_value...\n";
+
+    std::vector<unsigned char> basename_as_bytes(23);
+    xtt_crypto_get_random(basename_as_bytes.data(), basename_as_bytes.size());
+
+    std::vector<unsigned char> gpk_as_bytes(sizeof(xtt_daa_group_pub_key_lrsw));
+    xtt_crypto_get_random(gpk_as_bytes.data(), gpk_as_bytes.size());
+
+    auto maybe_ctx = xtt::group_public_key_context_lrsw_value::from_gpk_and_basename(gpk_as_bytes, basename_as_bytes);
+    TEST_ASSERT(maybe_ctx);
+    TEST_ASSERT(maybe_ctx->get_gpk() == gpk_as_bytes);
+    TEST_ASSERT(maybe_ctx->get_basename() == basename_as_bytes);
+
+    auto maybe_deserialized = xtt::group_public_key_context_lrsw_value::deserialize(maybe_ctx->serialize());
+    TEST_ASSERT(maybe_deserialized);
+    TEST_ASSERT(maybe_deserialized->get_gpk_as_text() == maybe_ctx->get_gpk_as_text());
+    TEST_ASSERT(maybe_deserialized->get_basename_as_text() == maybe_ctx->get_basename_as_text());
+
+    auto polymorphic = xtt::group_public_key_context_lrsw::deserialize(maybe_ctx->serialize());
+    TEST_ASSERT(polymorphic);
+    TEST_ASSERT(polymorphic->serialize() == maybe_ctx->serialize());
+
+    auto cloned = maybe_ctx->clone();
+    TEST_ASSERT(cloned);
+    TEST_ASSERT(cloned->serialize() == maybe_ctx->serialize());
+
+    std::vector<unsigned char> too_long(MAX_BASENAME_LENGTH + 1);
+    TEST_ASSERT(!xtt::group_public_key_context_lrsw_value::from_gpk_and_basename(gpk_as_bytes, too_long));
+}
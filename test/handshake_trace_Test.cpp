@@ -0,0 +1,117 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "test-utils.h"
+
+#include <xtt.hpp>
+
+const char *trace_file = "handshake_trace_Test.trace";
+
+void round_trip();
+void truncated_record_dropped();
+void bad_magic_rejected();
+
+int main()
+{
+    xtt::initialize_crypto();
+
+    round_trip();
+    truncated_record_dropped();
+    bad_magic_rejected();
+
+    std::remove(trace_file);
+}
+
+void round_trip()
+{
+    std::cout << "Starting handshake_trace_Test::round_trip...\n";
+
+    std::vector<unsigned char> first = {1, 2, 3};
+    std::vector<unsigned char> second(300, 0xAB);
+
+    {
+        auto writer = xtt::handshake_trace_writer::create(trace_file);
+        TEST_ASSERT(writer);
+
+        auto conn_a = writer->begin_connection();
+        auto conn_b = writer->begin_connection();
+        TEST_ASSERT(conn_a != conn_b);
+
+        writer->record(conn_a, first.data(), first.size());
+        writer->record(conn_b, second.data(), second.size());
+        writer->record(conn_a, second.data(), 0);
+        TEST_ASSERT(writer->flush());
+    }
+
+    auto records = xtt::read_handshake_trace(trace_file);
+    TEST_ASSERT(records);
+    TEST_ASSERT(3 == records->size());
+
+    TEST_ASSERT((*records)[0].connection == (*records)[2].connection);
+    TEST_ASSERT((*records)[0].connection != (*records)[1].connection);
+    TEST_ASSERT(first == (*records)[0].data);
+    TEST_ASSERT(second == (*records)[1].data);
+    TEST_ASSERT((*records)[2].data.empty());
+
+    TEST_ASSERT((*records)[0].time_us <= (*records)[1].time_us);
+    TEST_ASSERT((*records)[1].time_us <= (*records)[2].time_us);
+}
+
+void truncated_record_dropped()
+{
+    std::cout << "Starting handshake_trace_Test::truncated_record_dropped...\n";
+
+    std::vector<unsigned char> data(100, 0x5A);
+    {
+        auto writer = xtt::handshake_trace_writer::create(trace_file);
+        TEST_ASSERT(writer);
+
+        auto conn = writer->begin_connection();
+        writer->record(conn, data.data(), data.size());
+        writer->record(conn, data.data(), data.size());
+    }
+
+    std::ifstream in(trace_file, std::ios::in | std::ios::binary);
+    std::vector<char> contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    std::ofstream out(trace_file, std::ios::out | std::ios::binary | std::ios::trunc);
+    out.write(contents.data(), contents.size() - 1);
+    out.close();
+
+    auto records = xtt::read_handshake_trace(trace_file);
+    TEST_ASSERT(records);
+    TEST_ASSERT(1 == records->size());
+    TEST_ASSERT(data == (*records)[0].data);
+}
+
+void bad_magic_rejected()
+{
+    std::cout << "Starting handshake_trace_Test::bad_magic_rejected...\n";
+
+    std::ofstream out(trace_file, std::ios::out | std::ios::binary | std::ios::trunc);
+    out << "not a trace at all";
+    out.close();
+
+    TEST_ASSERT(!xtt::read_handshake_trace(trace_file));
+    TEST_ASSERT(!xtt::read_handshake_trace("handshake_trace_Test.missing"));
+}
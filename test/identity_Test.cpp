@@ -35,6 +35,10 @@ void serialize_text();
 void deserialize_text_handles_noncanon();
 void string_to_bin();
 void serialize_bins_agree();
+void deserialize_text_malformed();
+void serialize_text_to_buffer();
+void serialize_text_ipv4_tail();
+void format_and_parse_batch();
 
 int main()
 {
@@ -48,6 +52,10 @@ int main()
     deserialize_text_handles_noncanon();
     string_to_bin();
     serialize_bins_agree();
+    deserialize_text_malformed();
+    serialize_text_to_buffer();
+    serialize_text_ipv4_tail();
+    format_and_parse_batch();
 }
 
 void null()
@@ -189,3 +197,81 @@ void serialize_bins_agree()
     TEST_ASSERT(id_serialized.size() == sizeof(xtt_identity_type));
     TEST_ASSERT(0 == memcmp(id_as_bytes, id_serialized.data(), id_serialized.size()));
 }
+
+void deserialize_text_malformed()
+{
+    std::cout << "Starting identity_Test::deserialize_text_malformed...\n";
+
+    const char* malformed[] = {"", ":", ":1::2", "1:2", "1::2::3", "12345::", "1:2:3:4:5:6:7:8:9",
+                               "1:2:3:4:5:6:7:8::", "::1.2.3", "::1.2.3.256", "::01.2.3.4",
+                               "fe80::1%1", "ff02::1:2 ", "g::"};
+    for (auto text : malformed)
+        TEST_ASSERT(!xtt::identity::deserialize(text));
+
+    TEST_ASSERT(xtt::identity::deserialize("::"));
+    TEST_ASSERT(xtt::identity::deserialize("1:2:3:4:5:6:1.2.3.4"));
+    TEST_ASSERT(xtt::identity::deserialize("FF02::1:2")->serialize_to_text() == "ff02::1:2");
+}
+
+void serialize_text_to_buffer()
+{
+    std::cout << "Starting identity_Test::serialize_text_to_buffer...\n";
+
+    auto maybe_id = xtt::identity::deserialize("1234:5678:9abc:def0:1234:5678:9abc:def0");
+    TEST_ASSERT(maybe_id);
+
+    char as_text[xtt::identity::max_text_length];
+    TEST_ASSERT(xtt::identity::max_text_length == maybe_id->serialize_to_text(as_text, sizeof(as_text)));
+    TEST_ASSERT(maybe_id->serialize_to_text() == std::string(as_text, sizeof(as_text)));
+
+    TEST_ASSERT(0 == maybe_id->serialize_to_text(as_text, sizeof(as_text) - 1));
+}
+
+void serialize_text_ipv4_tail()
+{
+    std::cout << "Starting identity_Test::serialize_text_ipv4_tail...\n";
+
+    TEST_ASSERT(xtt::identity::deserialize("::ffff:10.0.0.1")->serialize_to_text() == "::ffff:10.0.0.1");
+    TEST_ASSERT(xtt::identity::deserialize("::ffff:a00:1")->serialize_to_text() == "::ffff:10.0.0.1");
+    TEST_ASSERT(xtt::identity::deserialize("::1")->serialize_to_text() == "::1");
+    TEST_ASSERT(xtt::identity::deserialize("1::")->serialize_to_text() == "1::");
+    TEST_ASSERT(xtt::identity::deserialize("1:0:0:1:0:0:0:1")->serialize_to_text() == "1:0:0:1::1");
+    TEST_ASSERT(xtt::identity::null.serialize_to_text() == "::");
+}
+
+void format_and_parse_batch()
+{
+    std::cout << "Starting identity_Test::format_and_parse_batch...\n";
+
+    std::vector<xtt::identity> ids(100);
+    for (auto& id : ids)
+        xtt_crypto_get_random(id.get()->data, sizeof(xtt_identity_type));
+
+    std::vector<char> out(ids.size() * (xtt::identity::max_text_length + 1));
+    std::size_t length = xtt::format_identities(ids.data(), ids.size(), out.data(), out.size());
+    TEST_ASSERT(0 != length);
+    TEST_ASSERT('\n' == out[length - 1]);
+
+    TEST_ASSERT(0 == xtt::format_identities(ids.data(), ids.size(), out.data(), length - 1));
+    TEST_ASSERT(length == xtt::format_identities(ids.data(), ids.size(), out.data(), length));
+
+    std::vector<STRING_VIEW_NS::string_view> texts;
+    std::size_t begin = 0;
+    for (std::size_t i = 0; i < length; ++i) {
+        if ('\n' == out[i]) {
+            texts.emplace_back(out.data() + begin, i - begin);
+            begin = i + 1;
+        }
+    }
+    TEST_ASSERT(texts.size() == ids.size());
+    texts[7] = "not an identity";
+
+    std::vector<xtt::identity> parsed(texts.size());
+    bool malformed[100];
+    TEST_ASSERT(1 == xtt::parse_identities(texts.data(), texts.size(), parsed.data(), malformed));
+
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+        TEST_ASSERT(malformed[i] == (7 == i));
+        TEST_ASSERT(7 == i ? parsed[i].is_null() : parsed[i] == ids[i]);
+    }
+}
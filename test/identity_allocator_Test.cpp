@@ -0,0 +1,250 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <chrono>
+
+#include "test-utils.h"
+
+#include <xtt.hpp>
+
+#include <sodium.h>
+
+#include <cstring>
+#include <xtt.h>
+
+void hash_matches_sha256();
+void hash_honors_requested();
+void sequential_leases_blocks();
+void sequential_fails_without_block();
+void sequential_waits_briefly_for_lease();
+void pooled_take_and_return();
+
+int main()
+{
+    xtt::initialize_crypto();
+
+    hash_matches_sha256();
+    hash_honors_requested();
+    sequential_leases_blocks();
+    sequential_fails_without_block();
+    sequential_waits_briefly_for_lease();
+    pooled_take_and_return();
+}
+
+static xtt::group_identity random_gid()
+{
+    xtt::group_identity gid;
+    xtt_crypto_get_random(gid.get()->data, sizeof(xtt_group_id));
+    return gid;
+}
+
+static xtt::pseudonym_lrsw random_pseudonym()
+{
+    xtt::pseudonym_lrsw nym;
+    xtt_crypto_get_random(nym.get()->data, sizeof(xtt_daa_pseudonym_lrsw));
+    return nym;
+}
+
+void hash_matches_sha256()
+{
+    std::cout << "Starting identity_allocator_Test::hash_matches_sha256...\n";
+
+    auto gid = random_gid();
+    auto nym = random_pseudonym();
+
+    std::vector<unsigned char> input = gid.serialize();
+    std::vector<unsigned char> nym_serial = nym.serialize();
+    input.insert(input.end(), nym_serial.begin(), nym_serial.end());
+    unsigned char expected[crypto_hash_sha256_BYTES];
+    crypto_hash_sha256(expected, input.data(), input.size());
+
+    xtt::hash_identity_allocator allocator;
+    auto id = allocator.allocate(gid, nym, xtt::identity::null);
+    TEST_ASSERT(id);
+    TEST_ASSERT(0 == memcmp(expected, id->get()->data, sizeof(xtt_identity_type)));
+
+    auto id_again = allocator.allocate(gid, nym, xtt::identity::null);
+    TEST_ASSERT(id_again);
+    TEST_ASSERT(*id == *id_again);
+}
+
+void hash_honors_requested()
+{
+    std::cout << "Starting identity_allocator_Test::hash_honors_requested...\n";
+
+    auto gid = random_gid();
+    auto nym = random_pseudonym();
+
+    xtt::identity requested;
+    xtt_crypto_get_random(requested.get()->data, sizeof(xtt_identity_type));
+
+    xtt::hash_identity_allocator honoring;
+    auto id = honoring.allocate(gid, nym, requested);
+    TEST_ASSERT(id);
+    TEST_ASSERT(requested == *id);
+
+    xtt::hash_identity_allocator ignoring(false);
+    auto assigned_id = ignoring.allocate(gid, nym, requested);
+    TEST_ASSERT(assigned_id);
+    TEST_ASSERT(requested != *assigned_id);
+}
+
+void sequential_leases_blocks()
+{
+    std::cout << "Starting identity_allocator_Test::sequential_leases_blocks...\n";
+
+    std::atomic<std::uint64_t> central_counter(0);
+    std::atomic<int> leases(0);
+    auto lease_block = [&](std::uint64_t block_size) -> OPTIONAL_NS::optional<std::uint64_t>
+                       {
+                           ++leases;
+                           return central_counter.fetch_add(block_size);
+                       };
+
+    auto prefix = xtt::identity::deserialize(std::string("fd00:1:2:3::"));
+    TEST_ASSERT(prefix);
+
+    auto allocator = xtt::sequential_identity_allocator::create(*prefix, 4, lease_block);
+    TEST_ASSERT(allocator);
+
+    auto gid = random_gid();
+    auto nym = random_pseudonym();
+    TEST_ASSERT(1 == leases);
+
+    // Later blocks are leased in the background, and waited for if needed
+    auto allocate = [&]()
+                    {
+                        auto id = allocator->allocate(gid, nym, xtt::identity::null);
+                        TEST_ASSERT(id);
+                        return *id;
+                    };
+
+    for (std::uint64_t i = 0; i < 10; ++i) {
+        auto id = allocate();
+        TEST_ASSERT(0 == memcmp(prefix->get()->data, id.get()->data, 8));
+        TEST_ASSERT(i == id.get()->data[15]);
+    }
+
+    auto last = xtt::identity::deserialize(std::string("fd00:1:2:3::a"));
+    TEST_ASSERT(last);
+    TEST_ASSERT(*last == allocate());
+
+    // Blocks are prefetched once half used
+    TEST_ASSERT(leases <= 4);
+}
+
+void sequential_fails_without_block()
+{
+    std::cout << "Starting identity_allocator_Test::sequential_fails_without_block...\n";
+
+    // The initial lease failing is reported up front, not by failing handshakes later
+    auto allocator = xtt::sequential_identity_allocator::create(xtt::identity::null,
+                                                                16,
+                                                                [](std::uint64_t) -> OPTIONAL_NS::optional<std::uint64_t>
+                                                                {
+                                                                    return {};
+                                                                });
+
+    TEST_ASSERT(!allocator);
+}
+
+void sequential_waits_briefly_for_lease()
+{
+    std::cout << "Starting identity_allocator_Test::sequential_waits_briefly_for_lease...\n";
+
+    std::atomic<int> leases(0);
+    std::atomic<bool> central_counter_up(true);
+    auto lease_block = [&](std::uint64_t block_size) -> OPTIONAL_NS::optional<std::uint64_t>
+                       {
+                           int lease = leases++;
+                           while (!central_counter_up)
+                               std::this_thread::yield();
+                           return lease * block_size;
+                       };
+
+    auto allocator = xtt::sequential_identity_allocator::create(xtt::identity::null,
+                                                                2,
+                                                                lease_block,
+                                                                std::chrono::milliseconds(50));
+    TEST_ASSERT(allocator);
+    central_counter_up = false;
+
+    auto gid = random_gid();
+    auto nym = random_pseudonym();
+
+    // The second block is stuck being leased, so the third allocation gives up after the wait
+    TEST_ASSERT(allocator->allocate(gid, nym, xtt::identity::null));
+    TEST_ASSERT(allocator->allocate(gid, nym, xtt::identity::null));
+    auto start = std::chrono::steady_clock::now();
+    TEST_ASSERT(!allocator->allocate(gid, nym, xtt::identity::null));
+    TEST_ASSERT(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(50));
+
+    // A block arriving during the wait is used
+    std::thread central_counter([&]()
+                                {
+                                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                                    central_counter_up = true;
+                                });
+    auto id = allocator->allocate(gid, nym, xtt::identity::null);
+    central_counter.join();
+    TEST_ASSERT(id);
+    TEST_ASSERT(2 == id->get()->data[15]);
+}
+
+void pooled_take_and_return()
+{
+    std::cout << "Starting identity_allocator_Test::pooled_take_and_return...\n";
+
+    std::vector<xtt::identity> pool(2);
+    xtt_crypto_get_random(pool[0].get()->data, sizeof(xtt_identity_type));
+    xtt_crypto_get_random(pool[1].get()->data, sizeof(xtt_identity_type));
+
+    xtt::pooled_identity_allocator allocator(pool);
+    TEST_ASSERT(2 == allocator.available());
+
+    auto gid = random_gid();
+    auto nym = random_pseudonym();
+
+    auto first = allocator.allocate(gid, nym, xtt::identity::null);
+    auto second = allocator.allocate(gid, nym, xtt::identity::null);
+    TEST_ASSERT(first && second);
+    TEST_ASSERT(*first != *second);
+    TEST_ASSERT(0 == allocator.available());
+    TEST_ASSERT(!allocator.allocate(gid, nym, xtt::identity::null));
+
+    allocator.release(*first);
+    TEST_ASSERT(1 == allocator.available());
+
+    auto again = allocator.allocate(gid, nym, xtt::identity::null);
+    TEST_ASSERT(again);
+    TEST_ASSERT(*first == *again);
+
+    // Identities that aren't handed out are ignored
+    allocator.release(*again);
+    allocator.release(*again);
+    TEST_ASSERT(1 == allocator.available());
+
+    xtt::identity foreign;
+    xtt_crypto_get_random(foreign.get()->data, sizeof(xtt_identity_type));
+    allocator.release(foreign);
+    TEST_ASSERT(1 == allocator.available());
+}
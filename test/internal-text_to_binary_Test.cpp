@@ -19,6 +19,7 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <algorithm>
 
 #include "text_to_binary.hpp"
 
@@ -31,12 +32,14 @@
 void text_to_bin_to_text();
 void bin_to_text_to_bin();
 void lowercase_ok();
+void into_buffer();
 
 int main()
 {
     text_to_bin_to_text();
     bin_to_text_to_bin();
     lowercase_ok();
+    into_buffer();
 }
 
 void text_to_bin_to_text()
@@ -99,3 +102,23 @@ void lowercase_ok()
     TEST_ASSERT(bin_from_upper == as_bytes);
 }
 
+void into_buffer()
+{
+    std::cout << "Starting internal-text_to_binary_Test::into_buffer...\n";
+
+    std::vector<unsigned char> as_bytes(32);
+    xtt_crypto_get_random(as_bytes.data(), as_bytes.size());
+
+    // Surrounded by other text, as when parsing from a larger buffer
+    std::string surrounded = "XX" + binary_to_text(as_bytes.data(), as_bytes.size()) + "YY";
+    STRING_VIEW_NS::string_view as_text(surrounded.data() + 2, surrounded.size() - 4);
+
+    unsigned char conv_to_bin[32];
+    TEST_ASSERT(text_to_binary(as_text, conv_to_bin, sizeof(conv_to_bin)));
+    TEST_ASSERT(std::equal(as_bytes.begin(), as_bytes.end(), conv_to_bin));
+
+    TEST_ASSERT(!text_to_binary(as_text.substr(2), conv_to_bin, sizeof(conv_to_bin)));
+    TEST_ASSERT(!text_to_binary(as_text, conv_to_bin, sizeof(conv_to_bin) - 1));
+    TEST_ASSERT(!text_to_binary(STRING_VIEW_NS::string_view(surrounded.data(), as_text.size()),
+                                conv_to_bin, sizeof(conv_to_bin)));
+}
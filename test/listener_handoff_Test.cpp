@@ -0,0 +1,91 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include <iostream>
+#include <vector>
+
+#include "test-utils.h"
+
+#include <xtt/asio.hpp>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/local/connect_pair.hpp>
+
+void listener_round_trip();
+void too_many_listeners();
+
+int main()
+{
+    listener_round_trip();
+    too_many_listeners();
+}
+
+void listener_round_trip()
+{
+    std::cout << "Starting listener_handoff_Test::listener_round_trip...\n";
+
+    boost::asio::io_context io_ctx;
+    boost::asio::local::stream_protocol::socket predecessor(io_ctx);
+    boost::asio::local::stream_protocol::socket successor(io_ctx);
+    boost::asio::local::connect_pair(predecessor, successor);
+
+    boost::asio::ip::tcp::acceptor listener(io_ctx,
+                                            boost::asio::ip::tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+
+    boost::system::error_code ec;
+    xtt::asio::send_listeners(predecessor, {listener.native_handle()}, ec);
+    TEST_ASSERT(!ec);
+
+    auto received = xtt::asio::receive_listeners(successor, ec);
+    TEST_ASSERT(!ec);
+    TEST_ASSERT(1 == received.size());
+
+    // The successor's copy listens on the same port
+    boost::asio::ip::tcp::acceptor handed_off(io_ctx);
+    handed_off.assign(boost::asio::ip::tcp::v4(), received[0], ec);
+    TEST_ASSERT(!ec);
+    TEST_ASSERT(listener.local_endpoint().port() == handed_off.local_endpoint().port());
+
+    // ... and connections queued on it can be accepted once the predecessor lets go
+    listener.close();
+    boost::asio::ip::tcp::socket client(io_ctx);
+    client.connect(handed_off.local_endpoint(), ec);
+    TEST_ASSERT(!ec);
+    boost::asio::ip::tcp::socket accepted(io_ctx);
+    handed_off.accept(accepted, ec);
+    TEST_ASSERT(!ec);
+}
+
+void too_many_listeners()
+{
+    std::cout << "Starting listener_handoff_Test::too_many_listeners...\n";
+
+    boost::asio::io_context io_ctx;
+    boost::asio::local::stream_protocol::socket predecessor(io_ctx);
+    boost::asio::local::stream_protocol::socket successor(io_ctx);
+    boost::asio::local::connect_pair(predecessor, successor);
+
+    boost::system::error_code ec;
+    std::vector<int> listeners(xtt::asio::max_handed_off_listeners + 1, predecessor.native_handle());
+    xtt::asio::send_listeners(predecessor, listeners, ec);
+    TEST_ASSERT(ec);
+
+    xtt::asio::send_listeners(predecessor, {}, ec);
+    TEST_ASSERT(ec);
+}
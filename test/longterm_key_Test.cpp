@@ -36,12 +36,14 @@ void ecdsap256_serialize_bin();
 void ecdsap256_serialize_text();
 void ecdsap256_string_to_bin();
 void ecdsap256_serialize_bins_agree();
+void ecdsap256_view();
 void ecdsap256_priv_length();
 void ecdsap256_priv_equality();
 void ecdsap256_priv_clone();
 void ecdsap256_priv_serialize_bin();
 void ecdsap256_priv_string_to_bin();
 void ecdsap256_priv_serialize_bins_agree();
+void ecdsap256_value();
 
 int main()
 {
@@ -54,12 +56,14 @@ int main()
     ecdsap256_serialize_text();
     ecdsap256_string_to_bin();
     ecdsap256_serialize_bins_agree();
+    ecdsap256_view();
     ecdsap256_priv_length();
     ecdsap256_priv_equality();
     ecdsap256_priv_clone();
     ecdsap256_priv_serialize_bin();
     ecdsap256_priv_string_to_bin();
     ecdsap256_priv_serialize_bins_agree();
+    ecdsap256_value();
 }
 
 void ecdsap256_length()
@@ -290,3 +294,70 @@ void ecdsap256_priv_serialize_bins_agree()
     TEST_ASSERT(key_serialized.size() == sizeof(xtt_ecdsap256_priv_key));
     TEST_ASSERT(0 == memcmp(key_as_bytes, key_serialized.data(), key_serialized.size()));
 }
+
+void ecdsap256_view()
+{
+    std::cout << "Starting longterm_key_Test::ecdsap256_view...\n";
+
+    xtt_ecdsap256_pub_key raw;
+    xtt_crypto_get_random(raw.data, sizeof(xtt_ecdsap256_pub_key));
+
+    xtt::longterm_key_view view(raw);
+    TEST_ASSERT(view.length() == sizeof(xtt_ecdsap256_pub_key));
+    TEST_ASSERT(view.data() == raw.data);
+
+    auto owned = view.clone();
+    TEST_ASSERT(owned);
+    TEST_ASSERT(owned->get() != &raw);
+    TEST_ASSERT(0 == memcmp(owned->get(), &raw, sizeof(xtt_ecdsap256_pub_key)));
+
+    xtt::longterm_key_view view_of_owned(*owned);
+    TEST_ASSERT(view_of_owned == view);
+    TEST_ASSERT(view_of_owned.serialize_to_text() == owned->serialize_to_text());
+    TEST_ASSERT(view.serialize() == owned->serialize());
+
+    raw.data[0] ^= 0xFF;
+    TEST_ASSERT(view_of_owned != view);
+}
+
+void ecdsap256_value()
+{
+    std::cout << "Starting longterm_key_Test::ecdsap256_value...\n";
+
+    std::vector<unsigned char> key_as_bytes(sizeof(xtt_ecdsap256_pub_key));
+    xtt_crypto_get_random(key_as_bytes.data(), key_as_bytes.size());
+
+    auto maybe_key = xtt::longterm_key_ecdsap256_value::deserialize(key_as_bytes);
+    TEST_ASSERT(maybe_key);
+    TEST_ASSERT(maybe_key->length() == sizeof(xtt_ecdsap256_pub_key));
+    TEST_ASSERT(maybe_key->serialize() == key_as_bytes);
+
+    TEST_ASSERT(!xtt::longterm_key_ecdsap256_value::deserialize(key_as_bytes.data(), key_as_bytes.size() + 1));
+
+    auto maybe_from_text = xtt::longterm_key_ecdsap256_value::deserialize(maybe_key->serialize_to_text());
+    TEST_ASSERT(maybe_from_text);
+    TEST_ASSERT(*maybe_from_text == *maybe_key);
+
+    xtt::longterm_key_view view(*maybe_key);
+    TEST_ASSERT(view.data() == maybe_key->get()->data);
+
+    auto owned = maybe_key->clone();
+    TEST_ASSERT(owned);
+    TEST_ASSERT(owned->serialize() == key_as_bytes);
+
+    std::vector<unsigned char> priv_as_bytes(sizeof(xtt_ecdsap256_priv_key));
+    xtt_crypto_get_random(priv_as_bytes.data(), priv_as_bytes.size());
+
+    auto maybe_priv = xtt::longterm_private_key_ecdsap256_value::deserialize(priv_as_bytes);
+    TEST_ASSERT(maybe_priv);
+    TEST_ASSERT(maybe_priv->serialize() == priv_as_bytes);
+
+    xtt::longterm_private_key_ecdsap256_value priv_copy = *maybe_priv;
+    TEST_ASSERT(priv_copy == *maybe_priv);
+    priv_copy.get()->data[0] ^= 0xFF;
+    TEST_ASSERT(priv_copy != *maybe_priv);
+
+    auto owned_priv = maybe_priv->clone();
+    TEST_ASSERT(owned_priv);
+    TEST_ASSERT(owned_priv->serialize() == priv_as_bytes);
+}
@@ -0,0 +1,178 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include <iostream>
+#include <vector>
+#include <string>
+
+#include "test-utils.h"
+
+#include <xtt.hpp>
+#include <xtt/asio.hpp>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+
+void round_trip();
+void eof_after_close();
+void write_after_close();
+void server_context_over_memory_stream();
+
+int main()
+{
+    xtt::initialize_crypto();
+
+    round_trip();
+    eof_after_close();
+    write_after_close();
+    server_context_over_memory_stream();
+}
+
+void round_trip()
+{
+    std::cout << "Starting memory_stream_Test::round_trip...\n";
+
+    boost::asio::io_context io_ctx;
+    auto ends = xtt::asio::memory_stream::make_pair(io_ctx.get_executor());
+
+    std::string message = "hello, xtt";
+    std::vector<unsigned char> received(message.size());
+
+    bool read_done = false;
+    boost::asio::async_read(ends.second,
+                            boost::asio::buffer(received),
+                            [&](const boost::system::error_code& ec, std::size_t n)
+                            {
+                                TEST_ASSERT(!ec);
+                                TEST_ASSERT(n == message.size());
+                                read_done = true;
+                            });
+
+    bool write_done = false;
+    boost::asio::async_write(ends.first,
+                             boost::asio::buffer(message),
+                             [&](const boost::system::error_code& ec, std::size_t n)
+                             {
+                                 TEST_ASSERT(!ec);
+                                 TEST_ASSERT(n == message.size());
+                                 write_done = true;
+                             });
+
+    io_ctx.run();
+
+    TEST_ASSERT(read_done);
+    TEST_ASSERT(write_done);
+    TEST_ASSERT(std::string(received.begin(), received.end()) == message);
+}
+
+void eof_after_close()
+{
+    std::cout << "Starting memory_stream_Test::eof_after_close...\n";
+
+    boost::asio::io_context io_ctx;
+    auto ends = xtt::asio::memory_stream::make_pair(io_ctx.get_executor());
+
+    std::vector<unsigned char> sent = {1, 2, 3};
+    boost::asio::async_write(ends.first, boost::asio::buffer(sent), [](auto&&, auto&&){});
+    ends.first.close();
+    TEST_ASSERT(!ends.first.is_open());
+
+    std::vector<unsigned char> received(8);
+    boost::system::error_code read_ec;
+    std::size_t read_n = 0;
+    boost::asio::async_read(ends.second,
+                            boost::asio::buffer(received),
+                            [&](const boost::system::error_code& ec, std::size_t n)
+                            {
+                                read_ec = ec;
+                                read_n = n;
+                            });
+
+    io_ctx.run();
+
+    // Buffered data is drained before end-of-stream is reported
+    TEST_ASSERT(read_ec == boost::asio::error::eof);
+    TEST_ASSERT(read_n == sent.size());
+    TEST_ASSERT(std::vector<unsigned char>(received.begin(), received.begin() + read_n) == sent);
+}
+
+void write_after_close()
+{
+    std::cout << "Starting memory_stream_Test::write_after_close...\n";
+
+    boost::asio::io_context io_ctx;
+    auto ends = xtt::asio::memory_stream::make_pair(io_ctx.get_executor());
+
+    ends.second.close();
+
+    std::vector<unsigned char> sent = {1, 2, 3};
+    boost::system::error_code write_ec;
+    boost::asio::async_write(ends.first,
+                             boost::asio::buffer(sent),
+                             [&](const boost::system::error_code& ec, std::size_t)
+                             {
+                                 write_ec = ec;
+                             });
+
+    io_ctx.run();
+
+    TEST_ASSERT(write_ec == boost::asio::error::broken_pipe);
+}
+
+void server_context_over_memory_stream()
+{
+    std::cout << "Starting memory_stream_Test::server_context_over_memory_stream...\n";
+
+    boost::asio::io_context io_ctx;
+    auto ends = xtt::asio::memory_stream::make_pair(io_ctx.get_executor());
+
+    xtt::server_cookie_context cookie_ctx;
+    xtt::asio::basic_server_context<xtt::asio::memory_stream> server(std::move(ends.first), cookie_ctx);
+
+    // Not a valid ClientInit, so the handshake must fail
+    std::vector<unsigned char> garbage(64, 0xFF);
+    boost::asio::async_write(ends.second, boost::asio::buffer(garbage), [](auto&&, auto&&){});
+    ends.second.close();
+
+    bool handler_called = false;
+    boost::system::error_code handshake_ec;
+    server.async_handle_connect([](auto&&, auto&&, auto&&) { TEST_ASSERT(false); },
+                                [](auto&&, auto&&, auto&&) { TEST_ASSERT(false); },
+                                [&](const boost::system::error_code& ec)
+                                {
+                                    handler_called = true;
+                                    handshake_ec = ec;
+                                });
+
+    io_ctx.run();
+
+    TEST_ASSERT(handler_called);
+    TEST_ASSERT(handshake_ec);
+    TEST_ASSERT(!server.get_handshake_result());
+
+    // The whole flight was already buffered, so read coalescing needs at most one read
+    TEST_ASSERT(server.get_io_statistics().read_calls <= 1);
+    TEST_ASSERT(server.get_io_statistics().bytes_read <= garbage.size());
+
+    // Nothing to hand over from a failed handshake, but the state is still wiped
+    TEST_ASSERT(!server.finish());
+    TEST_ASSERT(!server.get_handshake_result());
+    TEST_ASSERT(!server.get_clients_identity());
+    TEST_ASSERT(!server.get_clients_pseudonym());
+}
@@ -35,6 +35,8 @@ void lrsw_equality();
 void lrsw_deserialize_bin();
 void lrsw_deserialize_bins_agree();
 void lrsw_deserialize_text();
+void lrsw_view();
+void lrsw_value();
 
 int main()
 {
@@ -46,6 +48,8 @@ int main()
     lrsw_deserialize_bin();
     lrsw_deserialize_bins_agree();
     lrsw_deserialize_text();
+    lrsw_view();
+    lrsw_value();
 }
 
 void lrsw_length()
@@ -139,3 +143,59 @@ void lrsw_deserialize_text()
     std::cout << "Pseudonym as string is: '" << nym_as_text << "'\n"
         << "which serializes as: '" << *maybe_nym << std::endl;
 }
+
+void lrsw_view()
+{
+    std::cout << "Starting pseudonym_Test::lrsw_view...\n";
+
+    xtt_daa_pseudonym_lrsw raw;
+    xtt_crypto_get_random(raw.data, sizeof(xtt_daa_pseudonym_lrsw));
+
+    xtt::pseudonym_view view(raw);
+    TEST_ASSERT(view.length() == sizeof(xtt_daa_pseudonym_lrsw));
+    TEST_ASSERT(view.data() == raw.data);
+
+    auto owned = view.clone();
+    TEST_ASSERT(owned);
+    TEST_ASSERT(owned->get() != &raw);
+    TEST_ASSERT(0 == memcmp(owned->get(), &raw, sizeof(xtt_daa_pseudonym_lrsw)));
+
+    xtt::pseudonym_view view_of_owned(*owned);
+    TEST_ASSERT(view_of_owned == view);
+    TEST_ASSERT(view_of_owned.serialize_to_text() == owned->serialize_to_text());
+    TEST_ASSERT(view.serialize() == owned->serialize());
+
+    raw.data[0] ^= 0xFF;
+    TEST_ASSERT(view_of_owned != view);
+}
+
+void lrsw_value()
+{
+    std::cout << "Starting pseudonym_Test::lrsw_value...\n";
+
+    std::vector<unsigned char> nym_as_bytes(sizeof(xtt_daa_pseudonym_lrsw));
+    xtt_crypto_get_random(nym_as_bytes.data(), nym_as_bytes.size());
+
+    auto maybe_nym = xtt::pseudonym_lrsw_value::deserialize(nym_as_bytes);
+    TEST_ASSERT(maybe_nym);
+    TEST_ASSERT(maybe_nym->length() == sizeof(xtt_daa_pseudonym_lrsw));
+    TEST_ASSERT(maybe_nym->serialize() == nym_as_bytes);
+
+    TEST_ASSERT(!xtt::pseudonym_lrsw_value::deserialize(nym_as_bytes.data(), nym_as_bytes.size() - 1));
+
+    auto maybe_from_text = xtt::pseudonym_lrsw_value::deserialize(maybe_nym->serialize_to_text());
+    TEST_ASSERT(maybe_from_text);
+    TEST_ASSERT(*maybe_from_text == *maybe_nym);
+
+    std::vector<xtt::pseudonym_lrsw_value> table(3, *maybe_nym);
+    TEST_ASSERT(table[2] == *maybe_nym);
+    table[1].get()->data[0] ^= 0xFF;
+    TEST_ASSERT(table[1] != table[0]);
+
+    xtt::pseudonym_view view(*maybe_nym);
+    TEST_ASSERT(view.data() == maybe_nym->get()->data);
+
+    auto owned = maybe_nym->clone();
+    TEST_ASSERT(owned);
+    TEST_ASSERT(owned->serialize() == nym_as_bytes);
+}
@@ -0,0 +1,308 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <thread>
+
+#include "test-utils.h"
+
+#include <xtt.hpp>
+
+#include <cstring>
+#include <cstdio>
+#include <unistd.h>
+#include <xtt.h>
+
+void insert_and_find();
+void survives_reopen();
+void erase_survives_reopen();
+void compact_keeps_live();
+void ignores_torn_tail();
+void rejects_foreign_file();
+void caching_allocator_reuses();
+void caching_allocator_releases_lost_races();
+
+int main()
+{
+    xtt::initialize_crypto();
+
+    insert_and_find();
+    survives_reopen();
+    erase_survives_reopen();
+    compact_keeps_live();
+    ignores_torn_tail();
+    rejects_foreign_file();
+    caching_allocator_reuses();
+    caching_allocator_releases_lost_races();
+}
+
+static std::string temp_path(const char* name)
+{
+    std::string path = std::string("pseudonym_identity_cache_Test-") + name + ".log";
+    ::unlink(path.c_str());
+    return path;
+}
+
+static xtt::pseudonym_lrsw random_pseudonym()
+{
+    xtt::pseudonym_lrsw nym;
+    xtt_crypto_get_random(nym.get()->data, sizeof(xtt_daa_pseudonym_lrsw));
+    return nym;
+}
+
+static xtt::identity random_identity()
+{
+    xtt::identity id;
+    xtt_crypto_get_random(id.get()->data, sizeof(xtt_identity_type));
+    return id;
+}
+
+void insert_and_find()
+{
+    std::cout << "Starting pseudonym_identity_cache_Test::insert_and_find...\n";
+
+    auto cache = xtt::pseudonym_identity_cache::open(temp_path("insert_and_find"));
+    TEST_ASSERT(cache);
+    TEST_ASSERT(0 == cache->size());
+
+    auto nym = random_pseudonym();
+    auto id = random_identity();
+    TEST_ASSERT(!cache->find(nym));
+
+    TEST_ASSERT(cache->insert(nym, id));
+    TEST_ASSERT(1 == cache->size());
+
+    auto found = cache->find(nym);
+    TEST_ASSERT(found);
+    TEST_ASSERT(id == *found);
+
+    auto new_id = random_identity();
+    TEST_ASSERT(cache->insert(nym, new_id));
+    TEST_ASSERT(1 == cache->size());
+    TEST_ASSERT(new_id == *cache->find(nym));
+}
+
+void survives_reopen()
+{
+    std::cout << "Starting pseudonym_identity_cache_Test::survives_reopen...\n";
+
+    std::string path = temp_path("survives_reopen");
+
+    std::vector<xtt::pseudonym_lrsw> nyms;
+    std::vector<xtt::identity> ids;
+    {
+        auto cache = xtt::pseudonym_identity_cache::open(path);
+        TEST_ASSERT(cache);
+
+        // Enough to force the log to grow past its initial capacity
+        for (int i = 0; i < 3000; ++i) {
+            nyms.push_back(random_pseudonym());
+            ids.push_back(random_identity());
+            TEST_ASSERT(cache->insert(nyms.back(), ids.back()));
+        }
+        TEST_ASSERT(cache->flush());
+    }
+
+    auto cache = xtt::pseudonym_identity_cache::open(path);
+    TEST_ASSERT(cache);
+    TEST_ASSERT(nyms.size() == cache->size());
+    for (std::size_t i = 0; i < nyms.size(); ++i) {
+        auto found = cache->find(nyms[i]);
+        TEST_ASSERT(found);
+        TEST_ASSERT(ids[i] == *found);
+    }
+}
+
+void erase_survives_reopen()
+{
+    std::cout << "Starting pseudonym_identity_cache_Test::erase_survives_reopen...\n";
+
+    std::string path = temp_path("erase_survives_reopen");
+
+    auto kept = random_pseudonym();
+    auto erased = random_pseudonym();
+    {
+        auto cache = xtt::pseudonym_identity_cache::open(path);
+        TEST_ASSERT(cache);
+        TEST_ASSERT(cache->insert(kept, random_identity()));
+        TEST_ASSERT(cache->insert(erased, random_identity()));
+        TEST_ASSERT(cache->erase(erased));
+        TEST_ASSERT(!cache->erase(erased));
+    }
+
+    auto cache = xtt::pseudonym_identity_cache::open(path);
+    TEST_ASSERT(cache);
+    TEST_ASSERT(1 == cache->size());
+    TEST_ASSERT(cache->find(kept));
+    TEST_ASSERT(!cache->find(erased));
+}
+
+void compact_keeps_live()
+{
+    std::cout << "Starting pseudonym_identity_cache_Test::compact_keeps_live...\n";
+
+    std::string path = temp_path("compact_keeps_live");
+
+    auto nym = random_pseudonym();
+    xtt::identity last_id;
+    {
+        auto cache = xtt::pseudonym_identity_cache::open(path);
+        TEST_ASSERT(cache);
+
+        // Repeatedly reassigning one pseudonym triggers automatic compaction,
+        // in the background while the inserts carry on
+        for (int i = 0; i < 5000; ++i) {
+            last_id = random_identity();
+            TEST_ASSERT(cache->insert(nym, last_id));
+        }
+        TEST_ASSERT(1 == cache->size());
+        TEST_ASSERT(last_id == *cache->find(nym));
+    }
+
+    {
+        auto cache = xtt::pseudonym_identity_cache::open(path);
+        TEST_ASSERT(cache);
+        TEST_ASSERT(1 == cache->size());
+        TEST_ASSERT(last_id == *cache->find(nym));
+
+        TEST_ASSERT(cache->compact());
+        TEST_ASSERT(last_id == *cache->find(nym));
+    }
+
+    auto cache = xtt::pseudonym_identity_cache::open(path);
+    TEST_ASSERT(cache);
+    TEST_ASSERT(1 == cache->size());
+    TEST_ASSERT(last_id == *cache->find(nym));
+}
+
+void ignores_torn_tail()
+{
+    std::cout << "Starting pseudonym_identity_cache_Test::ignores_torn_tail...\n";
+
+    std::string path = temp_path("ignores_torn_tail");
+
+    auto nym = random_pseudonym();
+    auto torn = random_pseudonym();
+    {
+        auto cache = xtt::pseudonym_identity_cache::open(path);
+        TEST_ASSERT(cache);
+        TEST_ASSERT(cache->insert(nym, random_identity()));
+        TEST_ASSERT(cache->insert(torn, random_identity()));
+    }
+
+    // Corrupt the final record's identity, as if the write never completed
+    FILE* file = fopen(path.c_str(), "r+b");
+    TEST_ASSERT(file);
+    TEST_ASSERT(0 == fseek(file, 16 + 2 * xtt::pseudonym_identity_cache::record_length - 6, SEEK_SET));
+    TEST_ASSERT(1 == fwrite("\xFF\xFF", 2, 1, file));
+    fclose(file);
+
+    auto cache = xtt::pseudonym_identity_cache::open(path);
+    TEST_ASSERT(cache);
+    TEST_ASSERT(1 == cache->size());
+    TEST_ASSERT(cache->find(nym));
+    TEST_ASSERT(!cache->find(torn));
+
+    // The torn record gets overwritten by the next append
+    TEST_ASSERT(cache->insert(torn, random_identity()));
+    TEST_ASSERT(2 == cache->size());
+}
+
+void rejects_foreign_file()
+{
+    std::cout << "Starting pseudonym_identity_cache_Test::rejects_foreign_file...\n";
+
+    std::string path = temp_path("rejects_foreign_file");
+
+    FILE* file = fopen(path.c_str(), "wb");
+    TEST_ASSERT(file);
+    TEST_ASSERT(1 == fwrite("not a pseudonym log", 19, 1, file));
+    fclose(file);
+
+    TEST_ASSERT(!xtt::pseudonym_identity_cache::open(path));
+}
+
+void caching_allocator_reuses()
+{
+    std::cout << "Starting pseudonym_identity_cache_Test::caching_allocator_reuses...\n";
+
+    auto cache = xtt::pseudonym_identity_cache::open(temp_path("caching_allocator_reuses"));
+    TEST_ASSERT(cache);
+
+    std::vector<xtt::identity> pool{random_identity(), random_identity()};
+    xtt::pooled_identity_allocator pooled(pool);
+    xtt::caching_identity_allocator allocator(pooled, *cache);
+
+    xtt::group_identity gid;
+    auto nym = random_pseudonym();
+
+    auto first = allocator.allocate(gid, nym, xtt::identity::null);
+    TEST_ASSERT(first);
+    TEST_ASSERT(1 == pooled.available());
+
+    auto second = allocator.allocate(gid, nym, xtt::identity::null);
+    TEST_ASSERT(second);
+    TEST_ASSERT(*first == *second);
+    TEST_ASSERT(1 == pooled.available());
+
+    TEST_ASSERT(*first == *cache->find(nym));
+}
+
+void caching_allocator_releases_lost_races()
+{
+    std::cout << "Starting pseudonym_identity_cache_Test::caching_allocator_releases_lost_races...\n";
+
+    auto cache = xtt::pseudonym_identity_cache::open(temp_path("caching_allocator_releases_lost_races"));
+    TEST_ASSERT(cache);
+
+    constexpr std::size_t thread_count = 8;
+    std::vector<xtt::identity> pool;
+    for (std::size_t i = 0; i < thread_count; ++i)
+        pool.push_back(random_identity());
+    xtt::pooled_identity_allocator pooled(pool);
+    xtt::caching_identity_allocator allocator(pooled, *cache);
+
+    xtt::group_identity gid;
+    auto nym = random_pseudonym();
+
+    // Concurrent handshakes for the same pseudonym all get the same identity,
+    // and only that one stays out of the pool
+    std::atomic<bool> go(false);
+    std::vector<OPTIONAL_NS::optional<xtt::identity>> ids(thread_count);
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < thread_count; ++i) {
+        threads.emplace_back([&, i]()
+                             {
+                                 while (!go)
+                                     std::this_thread::yield();
+                                 ids[i] = allocator.allocate(gid, nym, xtt::identity::null);
+                             });
+    }
+    go = true;
+    for (auto& thread : threads)
+        thread.join();
+
+    for (const auto& id : ids) {
+        TEST_ASSERT(id);
+        TEST_ASSERT(*ids[0] == *id);
+    }
+    TEST_ASSERT(thread_count - 1 == pooled.available());
+}
@@ -0,0 +1,136 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "test-utils.h"
+
+#include <xtt.hpp>
+
+#include <sodium.h>
+
+void empty_revokes_nothing();
+void revoked_are_found();
+void assign_replaces();
+void assign_while_reading();
+
+xtt::pseudonym_lrsw_value random_pseudonym();
+
+int main()
+{
+    xtt::initialize_crypto();
+
+    empty_revokes_nothing();
+    revoked_are_found();
+    assign_replaces();
+    assign_while_reading();
+}
+
+xtt::pseudonym_lrsw_value random_pseudonym()
+{
+    xtt::pseudonym_lrsw_value nym;
+    randombytes_buf(nym.get()->data, nym.length());
+    return nym;
+}
+
+void empty_revokes_nothing()
+{
+    std::cout << "Starting pseudonym_revocation_list_Test::empty_revokes_nothing...\n";
+
+    xtt::pseudonym_revocation_list revoked;
+    TEST_ASSERT(0 == revoked.size());
+    TEST_ASSERT(!revoked.is_revoked(random_pseudonym()));
+}
+
+void revoked_are_found()
+{
+    std::cout << "Starting pseudonym_revocation_list_Test::revoked_are_found...\n";
+
+    std::vector<xtt::pseudonym_lrsw_value> nyms;
+    for (int i = 0; i < 100; ++i)
+        nyms.push_back(random_pseudonym());
+    nyms.push_back(nyms.front());
+
+    xtt::pseudonym_revocation_list revoked(nyms);
+    TEST_ASSERT(100 == revoked.size());
+
+    for (const auto& nym : nyms)
+        TEST_ASSERT(revoked.is_revoked(nym));
+
+    for (int i = 0; i < 100; ++i)
+        TEST_ASSERT(!revoked.is_revoked(random_pseudonym()));
+}
+
+void assign_replaces()
+{
+    std::cout << "Starting pseudonym_revocation_list_Test::assign_replaces...\n";
+
+    auto first = random_pseudonym();
+    auto second = random_pseudonym();
+
+    xtt::pseudonym_revocation_list revoked({first});
+    TEST_ASSERT(revoked.is_revoked(first));
+    TEST_ASSERT(!revoked.is_revoked(second));
+
+    revoked.assign({second});
+    TEST_ASSERT(!revoked.is_revoked(first));
+    TEST_ASSERT(revoked.is_revoked(second));
+    TEST_ASSERT(1 == revoked.size());
+}
+
+void assign_while_reading()
+{
+    std::cout << "Starting pseudonym_revocation_list_Test::assign_while_reading...\n";
+
+    auto always = random_pseudonym();
+    auto sometimes = random_pseudonym();
+
+    xtt::pseudonym_revocation_list revoked({always});
+
+    std::atomic<bool> stop(false);
+    std::atomic<bool> failed(false);
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i)
+        readers.emplace_back([&]()
+                             {
+                                 while (!stop) {
+                                     if (!revoked.is_revoked(always))
+                                         failed = true;
+                                     std::size_t size = revoked.size();
+                                     if (1 != size && 2 != size)
+                                         failed = true;
+                                 }
+                             });
+
+    for (int i = 0; i < 1000; ++i) {
+        if (i % 2)
+            revoked.assign({always});
+        else
+            revoked.assign({always, sometimes});
+    }
+
+    stop = true;
+    for (auto& reader : readers)
+        reader.join();
+
+    TEST_ASSERT(!failed);
+    TEST_ASSERT(1 == revoked.size());
+}
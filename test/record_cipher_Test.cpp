@@ -0,0 +1,162 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include <iostream>
+#include <vector>
+#include <string>
+
+#include "test-utils.h"
+
+#include <xtt.hpp>
+
+void round_trip_each_suite();
+void tampered_record_fails();
+void out_of_order_fails();
+void salt_must_match();
+
+xtt::record_keys make_keys(unsigned char seed);
+
+int main()
+{
+    xtt::initialize_crypto();
+
+    round_trip_each_suite();
+    tampered_record_fails();
+    out_of_order_fails();
+    salt_must_match();
+}
+
+xtt::record_keys make_keys(unsigned char seed)
+{
+    xtt::record_keys keys;
+    for (std::size_t i = 0; i < keys.key.size(); ++i)
+        keys.key[i] = static_cast<unsigned char>(seed + i);
+    for (std::size_t i = 0; i < keys.iv.size(); ++i)
+        keys.iv[i] = static_cast<unsigned char>(seed ^ i);
+    return keys;
+}
+
+void round_trip_each_suite()
+{
+    std::cout << "Starting record_cipher_Test::round_trip_each_suite...\n";
+
+    xtt::for_each_suite([](auto traits)
+                        {
+                            auto sealer = xtt::record_cipher::from_keys(traits.value, make_keys(1));
+                            auto opener = xtt::record_cipher::from_keys(traits.value, make_keys(1));
+                            if (!sealer) {
+                                // AES-256-GCM is unavailable without AES-NI
+                                TEST_ASSERT(!opener);
+                                return;
+                            }
+                            TEST_ASSERT(opener);
+
+                            const std::string message = "telemetry";
+                            const unsigned char ad[] = {0x00, 0x09};
+
+                            for (int i = 0; i < 3; ++i) {
+                                std::vector<unsigned char> data(message.begin(), message.end());
+                                unsigned char tag[xtt::record_cipher::tag_length];
+
+                                TEST_ASSERT(sealer->seal(data.data(), data.size(), ad, sizeof(ad), tag));
+                                TEST_ASSERT(std::string(data.begin(), data.end()) != message);
+
+                                TEST_ASSERT(opener->open(data.data(), data.size(), ad, sizeof(ad), tag));
+                                TEST_ASSERT(std::string(data.begin(), data.end()) == message);
+                            }
+
+                            TEST_ASSERT(3 == sealer->get_sequence_number());
+                            TEST_ASSERT(3 == opener->get_sequence_number());
+                        });
+}
+
+void tampered_record_fails()
+{
+    std::cout << "Starting record_cipher_Test::tampered_record_fails...\n";
+
+    auto suite = xtt::suite_spec::X25519_LRSW_ECDSAP256_CHACHA20POLY1305_SHA512;
+    auto sealer = xtt::record_cipher::from_keys(suite, make_keys(2));
+    auto opener = xtt::record_cipher::from_keys(suite, make_keys(2));
+    TEST_ASSERT(sealer && opener);
+
+    std::vector<unsigned char> data(32, 0xAA);
+    unsigned char ad[] = {0x00, 0x20};
+    unsigned char tag[xtt::record_cipher::tag_length];
+    TEST_ASSERT(sealer->seal(data.data(), data.size(), ad, sizeof(ad), tag));
+
+    std::vector<unsigned char> tampered = data;
+    tampered[5] ^= 0x01;
+    TEST_ASSERT(!opener->open(tampered.data(), tampered.size(), ad, sizeof(ad), tag));
+    TEST_ASSERT(0 == opener->get_sequence_number());
+
+    std::vector<unsigned char> wrong_ad = data;
+    ad[1] = 0x21;
+    TEST_ASSERT(!opener->open(wrong_ad.data(), wrong_ad.size(), ad, sizeof(ad), tag));
+    ad[1] = 0x20;
+
+    TEST_ASSERT(opener->open(data.data(), data.size(), ad, sizeof(ad), tag));
+    TEST_ASSERT(std::vector<unsigned char>(32, 0xAA) == data);
+}
+
+void out_of_order_fails()
+{
+    std::cout << "Starting record_cipher_Test::out_of_order_fails...\n";
+
+    auto suite = xtt::suite_spec::X25519_LRSW_ECDSAP256_CHACHA20POLY1305_BLAKE2B;
+    auto sealer = xtt::record_cipher::from_keys(suite, make_keys(3));
+    auto opener = xtt::record_cipher::from_keys(suite, make_keys(3));
+    TEST_ASSERT(sealer && opener);
+
+    std::vector<unsigned char> first(16, 0x01);
+    std::vector<unsigned char> second(16, 0x02);
+    unsigned char first_tag[xtt::record_cipher::tag_length];
+    unsigned char second_tag[xtt::record_cipher::tag_length];
+    TEST_ASSERT(sealer->seal(first.data(), first.size(), nullptr, 0, first_tag));
+    TEST_ASSERT(sealer->seal(second.data(), second.size(), nullptr, 0, second_tag));
+
+    std::vector<unsigned char> second_copy = second;
+    TEST_ASSERT(!opener->open(second_copy.data(), second_copy.size(), nullptr, 0, second_tag));
+    TEST_ASSERT(opener->open(first.data(), first.size(), nullptr, 0, first_tag));
+    TEST_ASSERT(opener->open(second.data(), second.size(), nullptr, 0, second_tag));
+}
+
+void salt_must_match()
+{
+    std::cout << "Starting record_cipher_Test::salt_must_match...\n";
+
+    auto suite = xtt::suite_spec::X25519_LRSW_ECDSAP256_CHACHA20POLY1305_SHA512;
+    auto sealer = xtt::record_cipher::from_keys(suite, make_keys(4));
+    auto opener = xtt::record_cipher::from_keys(suite, make_keys(4));
+    auto unsalted = xtt::record_cipher::from_keys(suite, make_keys(4));
+    TEST_ASSERT(sealer && opener && unsalted);
+    TEST_ASSERT(sealer->shares_key_with(*unsalted));
+
+    const unsigned char salt[] = "per-connection salt";
+    sealer->mix_salt(salt, sizeof(salt));
+    opener->mix_salt(salt, sizeof(salt));
+    TEST_ASSERT(!sealer->shares_key_with(*unsalted));
+
+    std::vector<unsigned char> data(16, 0x03);
+    unsigned char tag[xtt::record_cipher::tag_length];
+    TEST_ASSERT(sealer->seal(data.data(), data.size(), nullptr, 0, tag));
+
+    std::vector<unsigned char> data_copy = data;
+    TEST_ASSERT(!unsalted->open(data_copy.data(), data_copy.size(), nullptr, 0, tag));
+    TEST_ASSERT(opener->open(data.data(), data.size(), nullptr, 0, tag));
+    TEST_ASSERT(std::vector<unsigned char>(16, 0x03) == data);
+}
@@ -35,6 +35,8 @@ void ecdsap256_clone_moves_pointers();
 void ecdsap256_deserialize_bin_together();
 void ecdsap256_deserialize_bin_separate();
 void ecdsap256_deserialize_text();
+void ecdsap256_deserialize_text_view();
+void ecdsap256_value();
 
 int main()
 {
@@ -46,6 +48,8 @@ int main()
     ecdsap256_deserialize_bin_together();
     ecdsap256_deserialize_bin_separate();
     ecdsap256_deserialize_text();
+    ecdsap256_deserialize_text_view();
+    ecdsap256_value();
 }
 
 void ecdsap256_clone()
@@ -187,3 +191,72 @@ void ecdsap256_deserialize_text()
     TEST_ASSERT(certificate_as_text == maybe_ctx->get_certificate_as_text());
     TEST_ASSERT(private_key_as_text == maybe_ctx->get_private_key_as_text());
 }
+
+void ecdsap256_deserialize_text_view()
+{
+    std::cout << "Starting server_certificate_Test::ecdsap256_deserialize_text_view...\n";
+
+    std::vector<unsigned char> certificate_as_bytes(XTT_SERVER_CERTIFICATE_ECDSAP256_LENGTH);
+    xtt_crypto_get_random(certificate_as_bytes.data(), certificate_as_bytes.size());
+    auto certificate_ctx = xtt::server_certificate_context_ecdsap256::from_certificate_and_key(certificate_as_bytes,
+            std::vector<unsigned char>(sizeof(xtt_ecdsap256_priv_key), 0x42));
+    TEST_ASSERT(certificate_ctx);
+
+    // Both parts, from a single buffer
+    std::string buffer = certificate_ctx->get_certificate_as_text() + "\n" + certificate_ctx->get_private_key_as_text();
+    STRING_VIEW_NS::string_view as_view(buffer);
+    auto certificate_as_text = as_view.substr(0, 2*XTT_SERVER_CERTIFICATE_ECDSAP256_LENGTH);
+    auto private_key_as_text = as_view.substr(2*XTT_SERVER_CERTIFICATE_ECDSAP256_LENGTH + 1);
+
+    auto maybe_ctx = xtt::server_certificate_context_ecdsap256::from_certificate_and_key(certificate_as_text,
+            private_key_as_text);
+    TEST_ASSERT(maybe_ctx);
+    TEST_ASSERT(certificate_as_bytes == maybe_ctx->get_certificate());
+    TEST_ASSERT(certificate_ctx->get_private_key() == maybe_ctx->get_private_key());
+
+    auto maybe_value = xtt::server_certificate_context_ecdsap256_value::from_certificate_and_key(certificate_as_text,
+            private_key_as_text);
+    TEST_ASSERT(maybe_value);
+    TEST_ASSERT(certificate_as_bytes == maybe_value->get_certificate());
+
+    TEST_ASSERT(!xtt::server_certificate_context_ecdsap256::from_certificate_and_key(certificate_as_text.substr(1),
+            private_key_as_text));
+    TEST_ASSERT(!xtt::server_certificate_context_ecdsap256::from_certificate_and_key(certificate_as_text,
+            as_view.substr(2*XTT_SERVER_CERTIFICATE_ECDSAP256_LENGTH)));
+}
+
+void ecdsap256_value()
+{
+    std::cout << "Starting server_certificate_Test::ecdsap256_value...\n";
+
+    std::vector<unsigned char> cert_as_bytes(XTT_SERVER_CERTIFICATE_ECDSAP256_LENGTH);
+    xtt_crypto_get_random(cert_as_bytes.data(), cert_as_bytes.size());
+
+    std::vector<unsigned char> key_as_bytes(sizeof(xtt_ecdsap256_priv_key));
+    xtt_crypto_get_random(key_as_bytes.data(), key_as_bytes.size());
+
+    auto maybe_ctx = xtt::server_certificate_context_ecdsap256_value::from_certificate_and_key(cert_as_bytes, key_as_bytes);
+    TEST_ASSERT(maybe_ctx);
+    TEST_ASSERT(maybe_ctx->get_certificate() == cert_as_bytes);
+    TEST_ASSERT(maybe_ctx->get_private_key() == key_as_bytes);
+
+    auto maybe_deserialized = xtt::server_certificate_context_ecdsap256_value::deserialize(maybe_ctx->serialize());
+    TEST_ASSERT(maybe_deserialized);
+    TEST_ASSERT(maybe_deserialized->serialize() == maybe_ctx->serialize());
+
+    // Copies and vector relocation must re-point the internal buffer
+    std::vector<xtt::server_certificate_context_ecdsap256_value> table;
+    for (int i = 0; i < 4; ++i)
+        table.push_back(*maybe_ctx);
+    for (auto& ctx: table) {
+        TEST_ASSERT((unsigned char*)ctx.get()->serialized_certificate == ctx.get()->serialized_certificate_raw);
+        TEST_ASSERT(ctx.get_certificate() == cert_as_bytes);
+    }
+
+    auto cloned = maybe_ctx->clone();
+    TEST_ASSERT(cloned);
+    TEST_ASSERT((unsigned char*)cloned->get()->serialized_certificate == cloned->get()->serialized_certificate_raw);
+    TEST_ASSERT(cloned->serialize() == maybe_ctx->serialize());
+
+    TEST_ASSERT(!xtt::server_certificate_context_ecdsap256_value::deserialize(cert_as_bytes));
+}
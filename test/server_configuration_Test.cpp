@@ -0,0 +1,154 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "test-utils.h"
+
+#include <xtt.hpp>
+#include <xtt/asio.hpp>
+
+void create_requires_certificates();
+void find_gpk();
+void publish_keeps_pinned_snapshots();
+void load_races_publish();
+
+namespace {
+
+    xtt::asio::shared_server_certificate_map dummy_certificates()
+    {
+        boost::system::error_code ec;
+        auto certificates = xtt::asio::make_server_certificate_map(std::vector<unsigned char>(XTT_SERVER_CERTIFICATE_ECDSAP256_LENGTH),
+                                                                   std::vector<unsigned char>(sizeof(xtt_ecdsap256_priv_key)),
+                                                                   ec);
+        TEST_ASSERT(!ec);
+        return certificates;
+    }
+
+    xtt::group_identity make_gid(unsigned char fill)
+    {
+        auto gid = xtt::group_identity::deserialize(std::vector<unsigned char>(sizeof(xtt_group_id), fill));
+        TEST_ASSERT(gid);
+        return *gid;
+    }
+
+}
+
+int main()
+{
+    xtt::initialize_crypto();
+
+    create_requires_certificates();
+    find_gpk();
+    publish_keeps_pinned_snapshots();
+    load_races_publish();
+}
+
+void create_requires_certificates()
+{
+    std::cout << "Starting server_configuration_Test::create_requires_certificates...\n";
+
+    TEST_ASSERT(!xtt::asio::server_configuration::create(nullptr, {}));
+    TEST_ASSERT(!xtt::asio::server_configuration::create(std::make_shared<const xtt::asio::server_certificate_map>(), {}));
+    TEST_ASSERT(xtt::asio::server_configuration::create(dummy_certificates(), {}));
+}
+
+void find_gpk()
+{
+    std::cout << "Starting server_configuration_Test::find_gpk...\n";
+
+    auto gpk = std::make_unique<xtt::group_public_key_context_lrsw>();
+    xtt_crypto_get_random((unsigned char*)gpk->get(), sizeof(xtt_group_public_key_context));
+    std::vector<unsigned char> gpk_bytes((unsigned char*)gpk->get(), (unsigned char*)gpk->get() + sizeof(xtt_group_public_key_context));
+
+    xtt::asio::group_public_key_map gpks;
+    gpks[make_gid(1)] = std::move(gpk);
+
+    auto config = xtt::asio::server_configuration::create(dummy_certificates(), std::move(gpks));
+    TEST_ASSERT(config);
+    TEST_ASSERT(1 == config->group_count());
+
+    auto found = config->find_gpk(make_gid(1));
+    TEST_ASSERT(found);
+    TEST_ASSERT(0 == std::memcmp(found->get(), gpk_bytes.data(), gpk_bytes.size()));
+
+    // Handed out, not copied
+    TEST_ASSERT(found == config->find_gpk(make_gid(1)));
+
+    TEST_ASSERT(!config->find_gpk(make_gid(2)));
+}
+
+void publish_keeps_pinned_snapshots()
+{
+    std::cout << "Starting server_configuration_Test::publish_keeps_pinned_snapshots...\n";
+
+    auto first = xtt::asio::server_configuration::create(dummy_certificates(), {});
+    auto second = xtt::asio::server_configuration::create(dummy_certificates(), {});
+
+    xtt::asio::server_configuration_store store(first);
+    auto pinned = store.load();
+    TEST_ASSERT(pinned == first);
+
+    store.publish(second);
+    TEST_ASSERT(store.load() == second);
+
+    // A handshake that started before the reload keeps its snapshot
+    first.reset();
+    TEST_ASSERT(1 == pinned.use_count());
+    TEST_ASSERT(pinned->find_gpk(make_gid(1)) == nullptr);
+}
+
+void load_races_publish()
+{
+    std::cout << "Starting server_configuration_Test::load_races_publish...\n";
+
+    std::vector<std::shared_ptr<const xtt::asio::server_configuration>> configs;
+    for (int i = 0; i < 4; ++i)
+        configs.push_back(xtt::asio::server_configuration::create(dummy_certificates(), {}));
+
+    xtt::asio::server_configuration_store store(configs[0]);
+
+    std::atomic<bool> done(false);
+    std::atomic<bool> unknown(false);
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i) {
+        readers.emplace_back([&]()
+                             {
+                                 while (!done) {
+                                     auto config = store.load();
+                                     if (std::find(configs.begin(), configs.end(), config) == configs.end())
+                                         unknown = true;
+                                 }
+                             });
+    }
+
+    for (int i = 0; i < 1000; ++i)
+        store.publish(configs[i % configs.size()]);
+
+    done = true;
+    for (auto& reader : readers)
+        reader.join();
+
+    TEST_ASSERT(!unknown);
+    TEST_ASSERT(store.load() == configs[999 % configs.size()]);
+}
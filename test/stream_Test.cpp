@@ -0,0 +1,276 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <stdexcept>
+
+#include "test-utils.h"
+
+#include <xtt.hpp>
+#include <xtt/asio.hpp>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+
+using test_stream = xtt::asio::stream<xtt::asio::memory_stream>;
+
+void round_trip();
+void many_buffers_one_record();
+void large_write_is_split();
+void tampered_record_fails();
+void each_stream_uses_fresh_keys();
+void shared_keys_are_rejected();
+
+xtt::record_keys make_keys(unsigned char seed);
+xtt::record_cipher make_cipher(unsigned char seed);
+
+const auto suite = xtt::suite_spec::X25519_LRSW_ECDSAP256_CHACHA20POLY1305_SHA512;
+
+int main()
+{
+    xtt::initialize_crypto();
+
+    round_trip();
+    many_buffers_one_record();
+    large_write_is_split();
+    tampered_record_fails();
+    each_stream_uses_fresh_keys();
+    shared_keys_are_rejected();
+}
+
+xtt::record_keys make_keys(unsigned char seed)
+{
+    xtt::record_keys keys;
+    keys.key.fill(seed);
+    keys.iv.fill(static_cast<unsigned char>(seed + 1));
+    return keys;
+}
+
+xtt::record_cipher make_cipher(unsigned char seed)
+{
+    auto cipher = xtt::record_cipher::from_keys(suite, make_keys(seed));
+    TEST_ASSERT(cipher);
+    return std::move(*cipher);
+}
+
+void round_trip()
+{
+    std::cout << "Starting stream_Test::round_trip...\n";
+
+    boost::asio::io_context io_ctx;
+    auto ends = xtt::asio::memory_stream::make_pair(io_ctx.get_executor());
+
+    test_stream server(std::move(ends.first), make_cipher(1), make_cipher(2));
+    test_stream client(std::move(ends.second), make_cipher(2), make_cipher(1));
+
+    const std::string request = "hello from the device";
+    const std::string response = "hello from the server";
+    std::vector<unsigned char> received_request(request.size());
+    std::vector<unsigned char> received_response(response.size());
+    bool done = false;
+
+    boost::asio::async_write(client, boost::asio::buffer(request), [](auto&& ec, auto&&) { TEST_ASSERT(!ec); });
+    boost::asio::async_read(server, boost::asio::buffer(received_request),
+                            [&](auto&& ec, auto&& n)
+                            {
+                                TEST_ASSERT(!ec);
+                                TEST_ASSERT(n == request.size());
+                                boost::asio::async_write(server, boost::asio::buffer(response), [](auto&& ec, auto&&) { TEST_ASSERT(!ec); });
+                            });
+    boost::asio::async_read(client, boost::asio::buffer(received_response),
+                            [&](auto&& ec, auto&& n)
+                            {
+                                TEST_ASSERT(!ec);
+                                TEST_ASSERT(n == response.size());
+                                done = true;
+                            });
+
+    io_ctx.run();
+
+    TEST_ASSERT(done);
+    TEST_ASSERT(std::string(received_request.begin(), received_request.end()) == request);
+    TEST_ASSERT(std::string(received_response.begin(), received_response.end()) == response);
+}
+
+void many_buffers_one_record()
+{
+    std::cout << "Starting stream_Test::many_buffers_one_record...\n";
+
+    boost::asio::io_context io_ctx;
+    auto ends = xtt::asio::memory_stream::make_pair(io_ctx.get_executor());
+    xtt::asio::memory_stream raw_peer(std::move(ends.second));
+
+    test_stream writer(std::move(ends.first), make_cipher(1), make_cipher(2));
+
+    std::vector<std::string> parts = {"temp=21.5;", "hum=40;", "batt=87"};
+    std::vector<boost::asio::const_buffer> buffers;
+    for (const auto& part : parts)
+        buffers.push_back(boost::asio::buffer(part));
+
+    std::size_t written = 0;
+    writer.async_write_some(buffers,
+                            [&](auto&& ec, auto&& n)
+                            {
+                                TEST_ASSERT(!ec);
+                                written = n;
+                                raw_peer.close();
+                            });
+
+    std::vector<unsigned char> wire;
+    std::vector<unsigned char> chunk(1024);
+    std::function<void()> drain = [&]()
+                                  {
+                                      raw_peer.async_read_some(boost::asio::buffer(chunk),
+                                                               [&](auto&& ec, auto&& n)
+                                                               {
+                                                                   wire.insert(wire.end(), chunk.begin(), chunk.begin() + n);
+                                                                   if (!ec)
+                                                                       drain();
+                                                               });
+                                  };
+    drain();
+
+    io_ctx.run();
+
+    std::size_t total = 0;
+    for (const auto& part : parts)
+        total += part.size();
+
+    TEST_ASSERT(written == total);
+    TEST_ASSERT(wire.size() == test_stream::salt_length + test_stream::header_length + total + xtt::record_cipher::tag_length);
+    TEST_ASSERT(((std::size_t(wire[test_stream::salt_length]) << 8) | wire[test_stream::salt_length + 1]) == total);
+}
+
+void large_write_is_split()
+{
+    std::cout << "Starting stream_Test::large_write_is_split...\n";
+
+    boost::asio::io_context io_ctx;
+    auto ends = xtt::asio::memory_stream::make_pair(io_ctx.get_executor());
+
+    test_stream server(std::move(ends.first), make_cipher(1), make_cipher(2));
+    test_stream client(std::move(ends.second), make_cipher(2), make_cipher(1));
+
+    std::vector<unsigned char> sent(3 * test_stream::max_record_payload + 123);
+    for (std::size_t i = 0; i < sent.size(); ++i)
+        sent[i] = static_cast<unsigned char>(i * 7);
+    std::vector<unsigned char> received(sent.size());
+
+    boost::asio::async_write(client, boost::asio::buffer(sent),
+                             [&](auto&& ec, auto&& n)
+                             {
+                                 TEST_ASSERT(!ec);
+                                 TEST_ASSERT(n == sent.size());
+                             });
+    boost::asio::async_read(server, boost::asio::buffer(received),
+                            [&](auto&& ec, auto&& n)
+                            {
+                                TEST_ASSERT(!ec);
+                                TEST_ASSERT(n == received.size());
+                            });
+
+    io_ctx.run();
+
+    TEST_ASSERT(sent == received);
+}
+
+void tampered_record_fails()
+{
+    std::cout << "Starting stream_Test::tampered_record_fails...\n";
+
+    boost::asio::io_context io_ctx;
+    auto ends = xtt::asio::memory_stream::make_pair(io_ctx.get_executor());
+    xtt::asio::memory_stream raw_peer(std::move(ends.second));
+
+    test_stream reader(std::move(ends.first), make_cipher(1), make_cipher(2));
+
+    // A salt, and a well-formed length, but the payload and tag are garbage
+    std::vector<unsigned char> forged(test_stream::salt_length + test_stream::header_length + 8 + xtt::record_cipher::tag_length, 0x5A);
+    forged[test_stream::salt_length] = 0x00;
+    forged[test_stream::salt_length + 1] = 0x08;
+    boost::asio::async_write(raw_peer, boost::asio::buffer(forged), [](auto&&, auto&&){});
+
+    std::vector<unsigned char> received(8);
+    boost::system::error_code read_ec;
+    reader.async_read_some(boost::asio::buffer(received),
+                           [&](auto&& ec, auto&& n)
+                           {
+                               read_ec = ec;
+                               TEST_ASSERT(0 == n);
+                           });
+
+    io_ctx.run();
+
+    TEST_ASSERT(read_ec == xtt::asio::get_record_failed_crypto_ec());
+}
+
+void each_stream_uses_fresh_keys()
+{
+    std::cout << "Starting stream_Test::each_stream_uses_fresh_keys...\n";
+
+    // Two connections with the same keys, sending the same data
+    std::vector<std::vector<unsigned char>> wires;
+    for (int i = 0; i < 2; ++i) {
+        boost::asio::io_context io_ctx;
+        auto ends = xtt::asio::memory_stream::make_pair(io_ctx.get_executor());
+        xtt::asio::memory_stream raw_peer(std::move(ends.second));
+
+        test_stream writer(std::move(ends.first), make_cipher(1), make_cipher(2));
+
+        const std::string data = "same data, same keys";
+        boost::asio::async_write(writer, boost::asio::buffer(data),
+                                 [&](auto&& ec, auto&&)
+                                 {
+                                     TEST_ASSERT(!ec);
+                                     raw_peer.close();
+                                 });
+
+        std::vector<unsigned char> wire(test_stream::salt_length + test_stream::header_length + data.size() + xtt::record_cipher::tag_length);
+        boost::asio::async_read(raw_peer, boost::asio::buffer(wire), [](auto&& ec, auto&&) { TEST_ASSERT(!ec); });
+
+        io_ctx.run();
+
+        wires.push_back(wire);
+    }
+
+    // Each picked its own salt, so the ciphertexts (and tags) differ
+    auto record_begin = test_stream::salt_length + test_stream::header_length;
+    TEST_ASSERT(!std::equal(wires[0].begin(), wires[0].begin() + test_stream::salt_length, wires[1].begin()));
+    TEST_ASSERT(!std::equal(wires[0].begin() + record_begin, wires[0].end(), wires[1].begin() + record_begin));
+}
+
+void shared_keys_are_rejected()
+{
+    std::cout << "Starting stream_Test::shared_keys_are_rejected...\n";
+
+    boost::asio::io_context io_ctx;
+    auto ends = xtt::asio::memory_stream::make_pair(io_ctx.get_executor());
+
+    bool rejected = false;
+    try {
+        test_stream reflected(std::move(ends.first), make_cipher(1), make_cipher(1));
+    } catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+
+    TEST_ASSERT(rejected);
+}
@@ -0,0 +1,104 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include <iostream>
+#include <vector>
+
+#include "test-utils.h"
+
+#include <xtt.hpp>
+
+void default_allows_all();
+void allow_list_and_order();
+void choose_most_preferred();
+void from_cpu_features();
+
+int main()
+{
+    xtt::initialize_crypto();
+
+    default_allows_all();
+    allow_list_and_order();
+    choose_most_preferred();
+    from_cpu_features();
+}
+
+void default_allows_all()
+{
+    std::cout << "Starting suite_policy_Test::default_allows_all...\n";
+
+    xtt::suite_policy policy;
+
+    std::size_t count = 0;
+    xtt::for_each_suite([&](auto traits)
+                        {
+                            TEST_ASSERT(policy.is_allowed(traits.value));
+                            ++count;
+                        });
+    TEST_ASSERT(count == policy.get_preference_order().size());
+    TEST_ASSERT(!policy.is_allowed(static_cast<xtt::suite_spec>(0xFF)));
+}
+
+void allow_list_and_order()
+{
+    std::cout << "Starting suite_policy_Test::allow_list_and_order...\n";
+
+    xtt::suite_policy policy({xtt::suite_spec::X25519_LRSW_ECDSAP256_CHACHA20POLY1305_BLAKE2B,
+                              static_cast<xtt::suite_spec>(0xFF),
+                              xtt::suite_spec::X25519_LRSW_ECDSAP256_CHACHA20POLY1305_SHA512,
+                              xtt::suite_spec::X25519_LRSW_ECDSAP256_CHACHA20POLY1305_BLAKE2B});
+
+    std::vector<xtt::suite_spec> expected = {xtt::suite_spec::X25519_LRSW_ECDSAP256_CHACHA20POLY1305_BLAKE2B,
+                                             xtt::suite_spec::X25519_LRSW_ECDSAP256_CHACHA20POLY1305_SHA512};
+    TEST_ASSERT(expected == policy.get_preference_order());
+
+    TEST_ASSERT(policy.is_allowed(xtt::suite_spec::X25519_LRSW_ECDSAP256_CHACHA20POLY1305_SHA512));
+    TEST_ASSERT(!policy.is_allowed(xtt::suite_spec::X25519_LRSW_ECDSAP256_AES256GCM_SHA512));
+    TEST_ASSERT(!policy.is_allowed(xtt::suite_spec::X25519_LRSW_ECDSAP256_AES256GCM_BLAKE2B));
+}
+
+void choose_most_preferred()
+{
+    std::cout << "Starting suite_policy_Test::choose_most_preferred...\n";
+
+    xtt::suite_policy policy({xtt::suite_spec::X25519_LRSW_ECDSAP256_AES256GCM_SHA512,
+                              xtt::suite_spec::X25519_LRSW_ECDSAP256_CHACHA20POLY1305_SHA512});
+
+    auto chosen = policy.choose({xtt::suite_spec::X25519_LRSW_ECDSAP256_CHACHA20POLY1305_SHA512,
+                                 xtt::suite_spec::X25519_LRSW_ECDSAP256_AES256GCM_SHA512});
+    TEST_ASSERT(chosen);
+    TEST_ASSERT(xtt::suite_spec::X25519_LRSW_ECDSAP256_AES256GCM_SHA512 == *chosen);
+
+    TEST_ASSERT(!policy.choose({xtt::suite_spec::X25519_LRSW_ECDSAP256_CHACHA20POLY1305_BLAKE2B}));
+}
+
+void from_cpu_features()
+{
+    std::cout << "Starting suite_policy_Test::from_cpu_features...\n";
+
+    auto policy = xtt::suite_policy::from_cpu_features();
+    TEST_ASSERT(!policy.get_preference_order().empty());
+
+    // Whatever the CPU, every allowed suite must be usable for records
+    for (auto suite : policy.get_preference_order()) {
+        xtt::record_keys keys = {};
+        TEST_ASSERT(xtt::record_cipher::from_keys(suite, keys));
+    }
+
+    TEST_ASSERT(policy.is_allowed(xtt::suite_spec::X25519_LRSW_ECDSAP256_CHACHA20POLY1305_SHA512));
+}
@@ -0,0 +1,106 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include <iostream>
+#include <set>
+#include <type_traits>
+
+#include "test-utils.h"
+
+#include <xtt.hpp>
+
+void traits_types();
+void visit_known_suites();
+void visit_unknown_suite();
+void for_each_visits_all();
+
+int main()
+{
+    xtt::initialize_crypto();
+
+    traits_types();
+    visit_known_suites();
+    visit_unknown_suite();
+    for_each_visits_all();
+}
+
+void traits_types()
+{
+    std::cout << "Starting suite_traits_Test::traits_types...\n";
+
+    using traits = xtt::suite_traits<xtt::suite_spec::X25519_LRSW_ECDSAP256_AES256GCM_BLAKE2B>;
+
+    static_assert(std::is_same<traits::daa, xtt::algorithm::lrsw>::value, "wrong DAA");
+    static_assert(std::is_same<traits::signature, xtt::algorithm::ecdsap256>::value, "wrong signature");
+    static_assert(std::is_same<traits::aead, xtt::algorithm::aes256gcm>::value, "wrong AEAD");
+    static_assert(std::is_same<traits::hash, xtt::algorithm::blake2b>::value, "wrong hash");
+
+    TEST_ASSERT(traits::value == xtt::suite_spec::X25519_LRSW_ECDSAP256_AES256GCM_BLAKE2B);
+}
+
+void visit_known_suites()
+{
+    std::cout << "Starting suite_traits_Test::visit_known_suites...\n";
+
+    auto is_chacha = [](auto traits) -> bool
+                     {
+                         return std::is_same<typename decltype(traits)::aead, xtt::algorithm::chacha20poly1305>::value;
+                     };
+
+    TEST_ASSERT(xtt::visit_suite(xtt::suite_spec::X25519_LRSW_ECDSAP256_CHACHA20POLY1305_SHA512, is_chacha));
+    TEST_ASSERT(xtt::visit_suite(xtt::suite_spec::X25519_LRSW_ECDSAP256_CHACHA20POLY1305_BLAKE2B, is_chacha));
+    TEST_ASSERT(!xtt::visit_suite(xtt::suite_spec::X25519_LRSW_ECDSAP256_AES256GCM_SHA512, is_chacha));
+    TEST_ASSERT(!xtt::visit_suite(xtt::suite_spec::X25519_LRSW_ECDSAP256_AES256GCM_BLAKE2B, is_chacha));
+
+    auto which = [](auto traits) -> int
+                 {
+                     return static_cast<int>(decltype(traits)::value);
+                 };
+    TEST_ASSERT(xtt::visit_suite(xtt::suite_spec::X25519_LRSW_ECDSAP256_AES256GCM_SHA512, which)
+                == static_cast<int>(xtt::suite_spec::X25519_LRSW_ECDSAP256_AES256GCM_SHA512));
+}
+
+void visit_unknown_suite()
+{
+    std::cout << "Starting suite_traits_Test::visit_unknown_suite...\n";
+
+    bool called = false;
+    auto ret = xtt::visit_suite(static_cast<xtt::suite_spec>(0),
+                                [&called](auto) -> OPTIONAL_NS::optional<int>
+                                {
+                                    called = true;
+                                    return 1;
+                                });
+    TEST_ASSERT(!called);
+    TEST_ASSERT(!ret);
+}
+
+void for_each_visits_all()
+{
+    std::cout << "Starting suite_traits_Test::for_each_visits_all...\n";
+
+    std::set<xtt::suite_spec> seen;
+    xtt::for_each_suite([&seen](auto traits)
+                        {
+                            seen.insert(decltype(traits)::value);
+                        });
+
+    TEST_ASSERT(seen.size() == 4);
+    TEST_ASSERT(seen.count(xtt::suite_spec::X25519_LRSW_ECDSAP256_CHACHA20POLY1305_SHA512));
+    TEST_ASSERT(seen.count(xtt::suite_spec::X25519_LRSW_ECDSAP256_AES256GCM_BLAKE2B));
+}
@@ -0,0 +1,386 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "test-utils.h"
+
+#include <xtt.hpp>
+#include <xtt/asio.hpp>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/udp.hpp>
+
+void bad_client_init_fails_session();
+void max_sessions_drops_new_clients();
+void full_server_evicts_only_stale_unverified();
+void competing_client_init_is_ignored();
+void fragments_reassemble_in_any_order();
+void stale_datagrams_are_ignored();
+void client_inits_are_rate_limited();
+void client_inits_are_rate_limited_in_total();
+
+int main()
+{
+    xtt::initialize_crypto();
+
+    bad_client_init_fails_session();
+    max_sessions_drops_new_clients();
+    full_server_evicts_only_stale_unverified();
+    competing_client_init_is_ignored();
+    fragments_reassemble_in_any_order();
+    stale_datagrams_are_ignored();
+    client_inits_are_rate_limited();
+    client_inits_are_rate_limited_in_total();
+}
+
+namespace {
+
+    boost::asio::ip::udp::socket bind_loopback(boost::asio::io_context& io_ctx)
+    {
+        return boost::asio::ip::udp::socket(io_ctx,
+                                            boost::asio::ip::udp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+    }
+
+    void load_dummy_certificate(xtt::asio::udp_server& server)
+    {
+        boost::system::error_code ec;
+        server.load_certificate(std::vector<unsigned char>(XTT_SERVER_CERTIFICATE_ECDSAP256_LENGTH),
+                                std::vector<unsigned char>(sizeof(xtt_ecdsap256_priv_key)),
+                                ec);
+        TEST_ASSERT(!ec);
+    }
+
+    // Send bytes [offset, offset + fragment_length) of a (not valid) message of message_length bytes
+    void send_fragment(boost::asio::ip::udp::socket& client,
+                       const boost::asio::ip::udp::endpoint& server,
+                       std::uint32_t handshake_id,
+                       std::uint8_t message_index,
+                       std::uint16_t message_length,
+                       std::uint16_t offset,
+                       std::size_t fragment_length)
+    {
+        xtt::asio::udp_fragment_header header;
+        header.handshake_id = handshake_id;
+        header.message_index = message_index;
+        header.message_length = message_length;
+        header.fragment_offset = offset;
+
+        std::vector<unsigned char> datagram(xtt::asio::udp_fragment_header::length + fragment_length, 0xFF);
+        header.serialize(datagram.data());
+        client.send_to(boost::asio::buffer(datagram), server);
+    }
+
+}
+
+void bad_client_init_fails_session()
+{
+    std::cout << "Starting udp_server_Test::bad_client_init_fails_session...\n";
+
+    boost::asio::io_context io_ctx;
+    xtt::server_cookie_context cookie_ctx;
+
+    xtt::asio::udp_server server(bind_loopback(io_ctx), cookie_ctx);
+    load_dummy_certificate(server);
+
+    auto client = bind_loopback(io_ctx);
+
+    bool handler_called = false;
+    server.async_serve([](auto&&, auto&&, auto&&) { TEST_ASSERT(false); },
+                       [](auto&&, auto&&, auto&&) { TEST_ASSERT(false); },
+                       [&](const boost::system::error_code& ec,
+                           const boost::asio::ip::udp::endpoint& peer,
+                           const OPTIONAL_NS::optional<xtt::handshake_result>& result)
+                       {
+                           handler_called = true;
+                           TEST_ASSERT(ec);
+                           TEST_ASSERT(peer == client.local_endpoint());
+                           TEST_ASSERT(!result);
+
+                           server.close();
+                       });
+
+    // Not a valid ClientInit
+    send_fragment(client, server.socket().local_endpoint(), 1, 0, 64, 0, 64);
+
+    io_ctx.run();
+
+    TEST_ASSERT(handler_called);
+    TEST_ASSERT(0 == server.session_count());
+}
+
+void max_sessions_drops_new_clients()
+{
+    std::cout << "Starting udp_server_Test::max_sessions_drops_new_clients...\n";
+
+    boost::asio::io_context io_ctx;
+    xtt::server_cookie_context cookie_ctx;
+
+    xtt::asio::udp_server server(bind_loopback(io_ctx), cookie_ctx, 0);
+    load_dummy_certificate(server);
+
+    auto client = bind_loopback(io_ctx);
+
+    bool handler_called = false;
+    server.async_serve([](auto&&, auto&&, auto&&) { TEST_ASSERT(false); },
+                       [](auto&&, auto&&, auto&&) { TEST_ASSERT(false); },
+                       [&](auto&&, auto&&, auto&&)
+                       {
+                           handler_called = true;
+                       });
+
+    send_fragment(client, server.socket().local_endpoint(), 1, 0, 64, 0, 64);
+
+    io_ctx.run_for(std::chrono::milliseconds(100));
+
+    TEST_ASSERT(!handler_called);
+    TEST_ASSERT(0 == server.session_count());
+
+    server.close();
+    io_ctx.restart();
+    io_ctx.run();
+}
+
+void full_server_evicts_only_stale_unverified()
+{
+    std::cout << "Starting udp_server_Test::full_server_evicts_only_stale_unverified...\n";
+
+    boost::asio::io_context io_ctx;
+    xtt::server_cookie_context cookie_ctx;
+
+    xtt::asio::udp_server server(bind_loopback(io_ctx), cookie_ctx, 2);
+    server.set_attest_rate_limit(1000, 1000);
+    server.set_unverified_grace_period(std::chrono::milliseconds(200));
+    load_dummy_certificate(server);
+
+    std::vector<boost::asio::ip::udp::socket> clients;
+    for (int i = 0; i < 3; ++i)
+        clients.push_back(bind_loopback(io_ctx));
+
+    std::vector<boost::asio::ip::udp::endpoint> failed;
+    server.async_serve([](auto&&, auto&&, auto&&) { TEST_ASSERT(false); },
+                       [](auto&&, auto&&, auto&&) { TEST_ASSERT(false); },
+                       [&](const boost::system::error_code& ec,
+                           const boost::asio::ip::udp::endpoint& peer,
+                           const OPTIONAL_NS::optional<xtt::handshake_result>&)
+                       {
+                           TEST_ASSERT(ec);
+                           failed.push_back(peer);
+                       });
+
+    // Half of each ClientInit, so every session waits for the rest.
+    // The sessions are still within their grace period, so the third client is ignored.
+    for (auto& client : clients) {
+        send_fragment(client, server.socket().local_endpoint(), 1, 0, 64, 0, 32);
+        io_ctx.run_for(std::chrono::milliseconds(50));
+    }
+
+    TEST_ASSERT(2 == server.session_count());
+    TEST_ASSERT(failed.empty());
+
+    // Once the grace period is over, the oldest unverified session makes way
+    io_ctx.run_for(std::chrono::milliseconds(200));
+    send_fragment(clients[2], server.socket().local_endpoint(), 1, 0, 64, 0, 32);
+    io_ctx.run_for(std::chrono::milliseconds(50));
+
+    TEST_ASSERT(2 == server.session_count());
+    TEST_ASSERT(1 == failed.size());
+    TEST_ASSERT(clients[0].local_endpoint() == failed[0]);
+
+    server.close();
+    io_ctx.restart();
+    io_ctx.run();
+}
+
+void competing_client_init_is_ignored()
+{
+    std::cout << "Starting udp_server_Test::competing_client_init_is_ignored...\n";
+
+    boost::asio::io_context io_ctx;
+    xtt::server_cookie_context cookie_ctx;
+
+    xtt::asio::udp_server server(bind_loopback(io_ctx), cookie_ctx);
+    load_dummy_certificate(server);
+
+    auto client = bind_loopback(io_ctx);
+
+    bool handler_called = false;
+    server.async_serve([](auto&&, auto&&, auto&&) { TEST_ASSERT(false); },
+                       [](auto&&, auto&&, auto&&) { TEST_ASSERT(false); },
+                       [&](const boost::system::error_code& ec, auto&&, auto&&)
+                       {
+                           handler_called = true;
+                           TEST_ASSERT(ec);
+
+                           server.close();
+                       });
+
+    // A ClientInit for another handshake (as if spoofed) doesn't abort the one in progress
+    send_fragment(client, server.socket().local_endpoint(), 1, 0, 64, 0, 32);
+    send_fragment(client, server.socket().local_endpoint(), 2, 0, 64, 0, 64);
+    io_ctx.run_for(std::chrono::milliseconds(50));
+    TEST_ASSERT(!handler_called);
+    TEST_ASSERT(1 == server.session_count());
+
+    // The original handshake carries on (and fails on its not valid ClientInit)
+    send_fragment(client, server.socket().local_endpoint(), 1, 0, 64, 32, 32);
+    io_ctx.run();
+
+    TEST_ASSERT(handler_called);
+    TEST_ASSERT(0 == server.session_count());
+}
+
+void fragments_reassemble_in_any_order()
+{
+    std::cout << "Starting udp_server_Test::fragments_reassemble_in_any_order...\n";
+
+    boost::asio::io_context io_ctx;
+    xtt::server_cookie_context cookie_ctx;
+
+    xtt::asio::udp_server server(bind_loopback(io_ctx), cookie_ctx);
+    load_dummy_certificate(server);
+
+    auto client = bind_loopback(io_ctx);
+
+    bool handler_called = false;
+    server.async_serve([](auto&&, auto&&, auto&&) { TEST_ASSERT(false); },
+                       [](auto&&, auto&&, auto&&) { TEST_ASSERT(false); },
+                       [&](const boost::system::error_code& ec, auto&&, auto&&)
+                       {
+                           handler_called = true;
+                           TEST_ASSERT(ec);
+
+                           server.close();
+                       });
+
+    // The last fragment first, and a duplicate of it, don't complete the message
+    send_fragment(client, server.socket().local_endpoint(), 1, 0, 64, 32, 32);
+    send_fragment(client, server.socket().local_endpoint(), 1, 0, 64, 32, 32);
+    io_ctx.run_for(std::chrono::milliseconds(50));
+    TEST_ASSERT(!handler_called);
+    TEST_ASSERT(1 == server.session_count());
+
+    // Once complete, the (not valid) ClientInit fails the handshake
+    send_fragment(client, server.socket().local_endpoint(), 1, 0, 64, 0, 32);
+    io_ctx.run();
+
+    TEST_ASSERT(handler_called);
+    TEST_ASSERT(0 == server.session_count());
+}
+
+void stale_datagrams_are_ignored()
+{
+    std::cout << "Starting udp_server_Test::stale_datagrams_are_ignored...\n";
+
+    boost::asio::io_context io_ctx;
+    xtt::server_cookie_context cookie_ctx;
+
+    xtt::asio::udp_server server(bind_loopback(io_ctx), cookie_ctx);
+    load_dummy_certificate(server);
+
+    auto client = bind_loopback(io_ctx);
+
+    bool handler_called = false;
+    server.async_serve([](auto&&, auto&&, auto&&) { TEST_ASSERT(false); },
+                       [](auto&&, auto&&, auto&&) { TEST_ASSERT(false); },
+                       [&](auto&&, auto&&, auto&&)
+                       {
+                           handler_called = true;
+                       });
+
+    // Fragments of a later message, or of another handshake's IdClientAttest,
+    // neither start a session nor disturb one.
+    send_fragment(client, server.socket().local_endpoint(), 1, 1, 64, 0, 64);
+    io_ctx.run_for(std::chrono::milliseconds(50));
+    TEST_ASSERT(0 == server.session_count());
+
+    send_fragment(client, server.socket().local_endpoint(), 1, 0, 64, 0, 32);
+    send_fragment(client, server.socket().local_endpoint(), 1, 1, 64, 0, 64);
+    send_fragment(client, server.socket().local_endpoint(), 2, 1, 64, 0, 64);
+    io_ctx.run_for(std::chrono::milliseconds(50));
+    TEST_ASSERT(1 == server.session_count());
+    TEST_ASSERT(!handler_called);
+
+    server.close();
+    io_ctx.restart();
+    io_ctx.run();
+}
+
+void client_inits_are_rate_limited()
+{
+    std::cout << "Starting udp_server_Test::client_inits_are_rate_limited...\n";
+
+    boost::asio::io_context io_ctx;
+    xtt::server_cookie_context cookie_ctx;
+
+    xtt::asio::udp_server server(bind_loopback(io_ctx), cookie_ctx);
+    server.set_attest_rate_limit(0.001, 2);
+    load_dummy_certificate(server);
+
+    server.async_serve([](auto&&, auto&&, auto&&) { TEST_ASSERT(false); },
+                       [](auto&&, auto&&, auto&&) { TEST_ASSERT(false); },
+                       [](auto&&, auto&&, auto&&) {});
+
+    // All from the same address, so only the first two get sessions
+    std::vector<boost::asio::ip::udp::socket> clients;
+    for (int i = 0; i < 4; ++i) {
+        clients.push_back(bind_loopback(io_ctx));
+        send_fragment(clients.back(), server.socket().local_endpoint(), 1, 0, 64, 0, 32);
+    }
+    io_ctx.run_for(std::chrono::milliseconds(50));
+
+    TEST_ASSERT(2 == server.session_count());
+
+    server.close();
+    io_ctx.restart();
+    io_ctx.run();
+}
+
+void client_inits_are_rate_limited_in_total()
+{
+    std::cout << "Starting udp_server_Test::client_inits_are_rate_limited_in_total...\n";
+
+    boost::asio::io_context io_ctx;
+    xtt::server_cookie_context cookie_ctx;
+
+    xtt::asio::udp_server server(bind_loopback(io_ctx), cookie_ctx);
+    server.set_attest_rate_limit(1000, 1000);
+    server.set_total_attest_rate_limit(0.001, 3);
+    load_dummy_certificate(server);
+
+    server.async_serve([](auto&&, auto&&, auto&&) { TEST_ASSERT(false); },
+                       [](auto&&, auto&&, auto&&) { TEST_ASSERT(false); },
+                       [](auto&&, auto&&, auto&&) {});
+
+    // Each address is well within its own limit, but only three sessions start in all
+    std::vector<boost::asio::ip::udp::socket> clients;
+    for (int i = 0; i < 5; ++i) {
+        clients.push_back(bind_loopback(io_ctx));
+        send_fragment(clients.back(), server.socket().local_endpoint(), 1, 0, 64, 0, 32);
+    }
+    io_ctx.run_for(std::chrono::milliseconds(50));
+
+    TEST_ASSERT(3 == server.session_count());
+
+    server.close();
+    io_ctx.restart();
+    io_ctx.run();
+}
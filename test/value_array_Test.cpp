@@ -0,0 +1,154 @@
+/******************************************************************************
+ *
+ * Copyright 2019 Xaptum, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License
+ *
+ *****************************************************************************/
+
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "test-utils.h"
+
+#include <xtt.hpp>
+
+#include <sodium.h>
+
+void deserialize_batch();
+void find_scans_all();
+void find_checks_whole_value();
+void sorted_find();
+void longterm_keys();
+
+int main()
+{
+    xtt::initialize_crypto();
+
+    deserialize_batch();
+    find_scans_all();
+    find_checks_whole_value();
+    sorted_find();
+    longterm_keys();
+}
+
+namespace {
+
+    std::vector<unsigned char> random_bytes(std::size_t length)
+    {
+        std::vector<unsigned char> ret(length);
+        randombytes_buf(ret.data(), ret.size());
+        return ret;
+    }
+
+}
+
+void deserialize_batch()
+{
+    std::cout << "Starting value_array_Test::deserialize_batch...\n";
+
+    auto serialized = random_bytes(100 * xtt::pseudonym_array::value_length);
+    auto nyms = xtt::pseudonym_array::deserialize(serialized);
+    TEST_ASSERT(nyms);
+    TEST_ASSERT(100 == nyms->size());
+    TEST_ASSERT(0 == std::memcmp((*nyms)[42].data(),
+                                 serialized.data() + 42 * xtt::pseudonym_array::value_length,
+                                 xtt::pseudonym_array::value_length));
+    TEST_ASSERT(serialized == nyms->serialize());
+
+    serialized.pop_back();
+    TEST_ASSERT(!xtt::pseudonym_array::deserialize(serialized));
+
+    auto empty = xtt::pseudonym_array::deserialize(std::vector<unsigned char>());
+    TEST_ASSERT(empty);
+    TEST_ASSERT(empty->empty());
+}
+
+void find_scans_all()
+{
+    std::cout << "Starting value_array_Test::find_scans_all...\n";
+
+    // Odd size, so the scalar tail after the SIMD loop is exercised too
+    auto nyms = xtt::pseudonym_array::deserialize(random_bytes(1001 * xtt::pseudonym_array::value_length));
+    TEST_ASSERT(nyms);
+
+    for (std::size_t i = 0; i < nyms->size(); ++i)
+        TEST_ASSERT(i == nyms->find((*nyms)[i]));
+
+    auto absent = xtt::pseudonym_lrsw_value::deserialize(random_bytes(xtt::pseudonym_array::value_length));
+    TEST_ASSERT(absent);
+    TEST_ASSERT(xtt::pseudonym_array::npos == nyms->find(*absent));
+}
+
+void find_checks_whole_value()
+{
+    std::cout << "Starting value_array_Test::find_checks_whole_value...\n";
+
+    auto first = random_bytes(xtt::pseudonym_array::value_length);
+    auto second = first;
+    second[0] ^= 0x01;   // same fingerprint, different value
+
+    xtt::pseudonym_array nyms;
+    nyms.push_back(*xtt::pseudonym_lrsw_value::deserialize(first));
+    nyms.push_back(*xtt::pseudonym_lrsw_value::deserialize(second));
+    TEST_ASSERT(2 == nyms.size());
+
+    TEST_ASSERT(0 == nyms.find(*xtt::pseudonym_lrsw_value::deserialize(first)));
+    TEST_ASSERT(1 == nyms.find(*xtt::pseudonym_lrsw_value::deserialize(second)));
+
+    second[1] ^= 0x01;
+    TEST_ASSERT(xtt::pseudonym_array::npos == nyms.find(*xtt::pseudonym_lrsw_value::deserialize(second)));
+}
+
+void sorted_find()
+{
+    std::cout << "Starting value_array_Test::sorted_find...\n";
+
+    auto nyms = xtt::pseudonym_array::deserialize(random_bytes(500 * xtt::pseudonym_array::value_length));
+    TEST_ASSERT(nyms);
+    auto original = *nyms;
+
+    nyms->sort();
+    TEST_ASSERT(500 == nyms->size());
+    for (std::size_t i = 1; i < nyms->size(); ++i)
+        TEST_ASSERT(std::memcmp((*nyms)[i - 1].data(), (*nyms)[i].data(), xtt::pseudonym_array::value_length) < 0);
+
+    for (std::size_t i = 0; i < original.size(); ++i) {
+        std::size_t index = nyms->sorted_find(original[i]);
+        TEST_ASSERT(xtt::pseudonym_array::npos != index);
+        TEST_ASSERT((*nyms)[index] == original[i]);
+        TEST_ASSERT(index == nyms->find(original[i]));
+    }
+
+    auto absent = xtt::pseudonym_lrsw_value::deserialize(random_bytes(xtt::pseudonym_array::value_length));
+    TEST_ASSERT(xtt::pseudonym_array::npos == nyms->sorted_find(*absent));
+}
+
+void longterm_keys()
+{
+    std::cout << "Starting value_array_Test::longterm_keys...\n";
+
+    auto serialized = random_bytes(10 * xtt::longterm_key_array::value_length);
+    auto keys = xtt::longterm_key_array::deserialize(serialized);
+    TEST_ASSERT(keys);
+    TEST_ASSERT(10 == keys->size());
+
+    auto key = xtt::longterm_key_ecdsap256::deserialize(serialized.data() + 7 * xtt::longterm_key_array::value_length,
+                                                        xtt::longterm_key_array::value_length);
+    TEST_ASSERT(key);
+    TEST_ASSERT(7 == keys->find(*key));
+
+    keys->sort();
+    TEST_ASSERT(xtt::longterm_key_array::npos != keys->sorted_find(*key));
+}